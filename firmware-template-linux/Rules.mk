@@ -37,6 +37,17 @@ DEFINES+=-DCONFIG_MDNS_DOMAIN_REVERSE
 DEFINES+=-DISABLE_INTERNAL_RTC
 DEFINES+=$(addprefix -I,$(EXTRA_INCLUDES))
 
+# make NETWORK_BACKEND=io_uring
+ifeq ($(NETWORK_BACKEND),io_uring)
+	DEFINES+=-DCONFIG_NETWORK_USE_IO_URING
+endif
+
+# make NETWORK_BACKEND=tap
+ifeq ($(NETWORK_BACKEND),tap)
+	DEFINES+=-DCONFIG_NETWORK_USE_TAP
+	DEFINES+=-DCONFIG_EMAC_HASH_MULTICAST_FILTER
+endif
+
 ifeq ($(findstring ARTNET_VERSION=4,$(DEFINES)),ARTNET_VERSION=4)
 	ifeq ($(findstring ARTNET_HAVE_DMXIN,$(DEFINES)),ARTNET_HAVE_DMXIN)
 		DEFINES+=-DE131_HAVE_DMXIN
@@ -74,7 +74,9 @@ CCPOPS+=-std=c++20
 
 COPS+=-ffunction-sections -fdata-sections
 
-SRCDIR = src src/linux $(EXTRA_SRCDIR)
+PLATFORM_SRCDIR?=src/linux
+
+SRCDIR = src $(PLATFORM_SRCDIR) $(EXTRA_SRCDIR)
 
 BUILD = build_linux/
 BUILD_DIRS:=$(addprefix $(BUILD),$(SRCDIR))
@@ -2,7 +2,7 @@
  * @file artnetcontroller.h
  *
  */
-/* Copyright (C) 2017-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2017-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -38,6 +38,10 @@
 #define DMX_MAX_VALUE 255
 #endif
 
+#if !defined (CONFIG_ARTNET_CONTROLLER_MAX_UNIVERSES)
+# define CONFIG_ARTNET_CONTROLLER_MAX_UNIVERSES 512
+#endif
+
 struct State {
 	uint32_t ArtPollIpAddress;
 	uint32_t ArtPollReplyCount;
@@ -51,6 +55,35 @@ struct TArtNetController {
 	uint8_t Oem[2];
 };
 
+namespace artnetcontroller {
+/**
+ * Unchanged universes are only refreshed (keep-alive).
+ * The maximum keeps the nodes well within their 10 seconds data loss and merge timeouts.
+ */
+static constexpr uint32_t DMX_REFRESH_MILLIS_DEFAULT = 1000;
+static constexpr uint32_t DMX_REFRESH_MILLIS_MAX = 4000;
+/**
+ * The universes sent with HandleDmxOut, a universe beyond the maximum is sent every time.
+ */
+static constexpr uint32_t MAX_UNIVERSES = CONFIG_ARTNET_CONTROLLER_MAX_UNIVERSES;
+
+struct ActiveUniverse {
+	uint8_t *pData;			///< Copy of the data sent, allocated when the universe is sent the first time
+	uint32_t nSeed;			///< Length and master
+	uint32_t nGeneration;	///< Of the subscribers sent to, 0 is broadcast
+	uint32_t nSentMillis;
+	uint16_t nUniverse;
+	uint8_t nSequence;
+	bool bValid;
+};
+
+struct DmxStatistics {
+	uint32_t nChanged;		///< Universes sent because the data or the subscribers changed
+	uint32_t nRefresh;		///< Unchanged universes sent as keep-alive
+	uint32_t nSuppressed;	///< Unchanged universes not sent
+};
+}  // namespace artnetcontroller
+
 class ArtNetController: public ArtNetPollTable {
 public:
 	ArtNetController();
@@ -97,6 +130,21 @@ public:
 		return m_bForceBroadcast;
 	}
 
+	/**
+	 * @param nRefreshMillis Keep-alive interval for unchanged universes, 0 sends every universe on every call.
+	 */
+	void SetDmxRefresh(const uint32_t nRefreshMillis) {
+		m_nDmxRefreshMillis = (nRefreshMillis < artnetcontroller::DMX_REFRESH_MILLIS_MAX) ? nRefreshMillis : artnetcontroller::DMX_REFRESH_MILLIS_MAX;
+		ActiveUniversesInvalidate();
+	}
+	uint32_t GetDmxRefresh() const {
+		return m_nDmxRefreshMillis;
+	}
+
+	const artnetcontroller::DmxStatistics& GetDmxStatistics() const {
+		return m_DmxStatistics;
+	}
+
 #ifdef CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER
 	void SetMaster(uint32_t nMaster = DMX_MAX_VALUE) {
 		if (nMaster < DMX_MAX_VALUE) {
@@ -127,8 +175,12 @@ private:
 	void HandlePoll();
 	void HandlePollReply();
 	void HandleTrigger();
-	void ActiveUniversesAdd(uint16_t nUniverse);
+	artnetcontroller::ActiveUniverse *ActiveUniversesAdd(uint16_t nUniverse);
 	void ActiveUniversesClear();
+	void ActiveUniversesInvalidate();
+	bool DmxIsToBeSent(artnetcontroller::ActiveUniverse *pActiveUniverse, const uint8_t *pDmxData, uint32_t nLength, uint32_t nGeneration);
+	void DmxSend(artnetcontroller::ActiveUniverse *pActiveUniverse, const struct artnet::PollTableUniverses *pTableUniverses, uint32_t nSubscribers);
+	void SendToSubscribers(const struct artnet::PollTableUniverses *pTableUniverses);
 
 private:
 	TArtNetController m_ArtNetController;
@@ -160,6 +212,9 @@ private:
 	int32_t m_nHandle { -1 };
 	uint32_t m_nLastPollMillis { 0 };
 	uint32_t m_nActiveUniverses { 0 };
+	uint8_t m_nSequence { 0 };	///< For the universes which are not in the active universes table
+	uint32_t m_nDmxRefreshMillis { artnetcontroller::DMX_REFRESH_MILLIS_DEFAULT };
+	artnetcontroller::DmxStatistics m_DmxStatistics;
 #ifdef CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER
 	uint32_t m_nMaster { DMX_MAX_VALUE };
 #endif
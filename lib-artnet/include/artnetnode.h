@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2016-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2016-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -34,7 +34,6 @@
 #endif
 
 #include <cstdint>
-#include <cstdarg>
 #include <cstring>
 #include <cstdio>
 #include <cassert>
@@ -71,6 +70,7 @@
 #include "lightset.h"
 #include "hardware.h"
 #include "network.h"
+#include "net/hash.h"
 #include "softwaretimers.h"
 
 #include "panel_led.h"
@@ -132,15 +132,69 @@ struct Node {
 	bool bMapUniverse0;										///< Art-Net 4
 };
 
+static constexpr uint32_t MAX_SOURCES = lightset::MERGE_SOURCES;
+static constexpr uint8_t SOURCE_NONE = 0xFF;
+
+/*
+ * The sources of a port are hashed on IP address and Physical
+ */
+static constexpr uint32_t SOURCE_HASH_SIZE = net::hash_size(2 * MAX_SOURCES);
+static constexpr uint32_t SOURCE_HASH_MASK = SOURCE_HASH_SIZE - 1;
+
+inline uint32_t source_hash(const uint32_t nIp, const uint8_t nPhysical) {
+	return net::hash_fibonacci(nIp ^ (nIp >> 16) ^ nPhysical, SOURCE_HASH_MASK);
+}
+
 struct Source {
 	uint32_t nMillis;	///< The latest time of the data received from port
 	uint32_t nIp;		///< The IP address for port
-	uint16_t nPhysical;	///< The physical input port from which DMX512 data was input.
+	uint8_t nPhysical;	///< The physical input port from which DMX512 data was input.
+	uint8_t nHashNext;	///< Next source in the same bucket
+	uint8_t nSequence;	///< The latest sequence number output, 0 is disabled
+	uint8_t nContiguous;	///< Consecutive sequence numbers received, up to SEQUENCE_CONTIGUOUS
+};
+
+/*
+ * ArtDmx Sequence : 0 is disabled, else 1..255 and wraps to 1.
+ * As with E1.31 6.9.2, a packet less than SEQUENCE_DISCARD_RANGE behind is late and discarded.
+ * The sequence is only checked after SEQUENCE_CONTIGUOUS consecutive sequence numbers.
+ * A controller with one Sequence counter for all its universes skips numbers on each universe,
+ * its packets are output as they arrive.
+ */
+static constexpr int32_t SEQUENCE_DISCARD_RANGE = 20;
+static constexpr uint8_t SEQUENCE_CONTIGUOUS = 8;
+
+struct SequenceCounters {
+	uint32_t nDiscarded;	///< Late or duplicate packets
+	uint32_t nReordered;	///< Packets held and output in sequence order
+	uint32_t nLost;			///< Sequence numbers skipped
 };
 
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+/*
+ * A packet after a gap is held for at most one DMX512 frame period,
+ * giving the missing packet the chance to arrive.
+ */
+static constexpr uint32_t REORDER_WINDOW_MILLIS = 23;
+
+struct ReorderWindow {
+	uint32_t nMillis;
+	uint32_t nLength;
+	uint8_t nSourceIndex;
+	uint8_t nSequence;
+	bool IsHeld;
+	uint8_t data[artnet::DMX_LENGTH] ALIGNED;
+};
+#endif
+
 struct OutputPort {
-	Source SourceA ALIGNED;
-	Source SourceB ALIGNED;
+	Source source[MAX_SOURCES] ALIGNED;
+	uint32_t nSourcesMask;					///< The active sources, bit n is source[n]
+	uint8_t sourceHash[SOURCE_HASH_SIZE];	///< First source in the bucket
+	SequenceCounters sequenceCounters;
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+	ReorderWindow reorderWindow;
+#endif
 	uint32_t nIpRdm;
 	uint8_t GoodOutput;
 	uint8_t GoodOutputB;
@@ -149,6 +203,19 @@ struct OutputPort {
 	bool IsDataPending;
 };
 
+/*
+ * The enabled ports are hashed on their PortAddress,
+ * ports in the same bucket are chained.
+ */
+static constexpr uint32_t PORT_ADDRESS_HASH_SIZE = net::hash_size(2 * MAX_PORTS);
+static constexpr uint32_t PORT_ADDRESS_HASH_MASK = PORT_ADDRESS_HASH_SIZE - 1;
+static constexpr uint8_t PORT_NONE = 0xFF;
+static_assert(MAX_PORTS < PORT_NONE);
+
+inline uint32_t port_address_hash(const uint16_t nPortAddress) {
+	return net::hash_fibonacci(nPortAddress, PORT_ADDRESS_HASH_MASK);
+}
+
 struct InputPort {
 	uint32_t nDestinationIp;
 	uint32_t nMillis;
@@ -157,6 +224,123 @@ struct InputPort {
 	uint8_t nPollReplyIndex;
 };
 
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+namespace sync {
+enum class Mode : uint8_t {
+	IMMEDIATE,	///< Output when the ArtSync is processed
+	LATENCY,	///< Output a fixed latency after the ArtSync is received
+	FRAME		///< Output on the frame grid, the frame period is measured from the ArtSync packets
+};
+
+inline const char *get_mode(const Mode mode) {
+	switch (mode) {
+	case Mode::LATENCY:
+		return "latency";
+	case Mode::FRAME:
+		return "frame";
+	default:
+		return "immediate";
+	}
+}
+
+inline Mode get_mode(const char *pMode) {
+	if (pMode != nullptr) {
+		if ((pMode[0] | 0x20) == 'l') {
+			return Mode::LATENCY;
+		}
+		if ((pMode[0] | 0x20) == 'f') {
+			return Mode::FRAME;
+		}
+	}
+	return Mode::IMMEDIATE;
+}
+
+# if !defined (CONFIG_ARTNET_SYNC_LATENCY_MICROS)
+#  define CONFIG_ARTNET_SYNC_LATENCY_MICROS 2000
+# endif
+static constexpr uint32_t LATENCY_MICROS = CONFIG_ARTNET_SYNC_LATENCY_MICROS;
+
+/*
+ * Synchronous mode is left when there is no ArtSync for WATCHDOG_PERIODS frame periods.
+ * The pending data is output and the ports are back to immediate output.
+ */
+static constexpr uint32_t WATCHDOG_PERIODS = 4;
+static constexpr uint32_t WATCHDOG_MIN_MICROS = 100U * 1000U;
+static constexpr uint32_t WATCHDOG_MAX_MICROS = 4U * 1000U * 1000U;	///< Art-Net 4 : 4 seconds
+
+struct Schedule {
+	uint32_t nArrivalMicros;	///< Latest ArtSync
+	uint32_t nDeadlineMicros;
+	uint32_t nLatencyMicros;
+	Mode mode;
+	bool IsArmed;
+};
+
+struct Statistics {
+	uint32_t nSyncs;
+	uint32_t nForced;			///< Output before the deadline, the next frame has arrived
+	uint32_t nFallbacks;		///< Watchdog, back to immediate output
+	uint32_t nPeriodMicros;		///< Smoothed ArtSync period
+	uint32_t nJitterMicros;		///< |interval - period| of the latest ArtSync
+	uint32_t nJitterMaxMicros;
+	uint32_t nLateMicros;		///< Output time - deadline of the latest ArtSync
+	uint32_t nLateMaxMicros;
+};
+}  // namespace sync
+#endif
+
+namespace diag {
+enum class Event : uint8_t {
+	LEAVING_MERGE,
+	SINGLE_SOURCE,
+	MERGE_SOURCE,
+	BUFFERING_DATA,
+	SEND_DATA,
+	MORE_SOURCES,
+	NEW_SOURCE,
+	DISCARDED_SEQUENCE,
+	SYNC_INDIVIDUAL,
+	SYNC_ALL,
+	SYNC_FALLBACK,
+	INPUT_SENT,
+	INPUT_LOCAL_MERGE,
+	INPUT_RATE_ZERO,
+	INPUT_TIMEOUT,
+	INPUT_SENT_TIMEOUT,
+	UNDEFINED
+};
+
+static constexpr uint8_t PORT_NONE = 0xFF;
+
+#if defined (ARTNET_ENABLE_SENDDIAG)
+# if !defined (CONFIG_ARTNET_DIAG_PACKETS_PER_SECOND)
+#  define CONFIG_ARTNET_DIAG_PACKETS_PER_SECOND 4
+# endif
+static constexpr uint32_t PACKETS_PER_SECOND = CONFIG_ARTNET_DIAG_PACKETS_PER_SECOND;
+static_assert((PACKETS_PER_SECOND >= 1) && (PACKETS_PER_SECOND <= 1000));
+static constexpr uint32_t LINES_MAX = 8;	///< Distinct events in one ArtDiagData packet
+static constexpr uint32_t EVENTS = static_cast<uint32_t>(Event::UNDEFINED);
+static constexpr uint32_t PORTS = MAX_PORTS + 1;	///< The last one is for PORT_NONE
+
+struct Counter {
+	uint32_t nCount;	///< Events since the latest ArtDiagData
+	uint8_t nPriority;
+	uint8_t nArg1;		///< Of the latest event
+	uint8_t nArg2;
+};
+
+/*
+ * The events are coalesced when recorded, one counter per event and port.
+ * A timer formats the counters into ArtDiagData packets.
+ */
+struct Counters {
+	Counter counter[EVENTS][PORTS];
+	uint32_t nPending;	///< Counters not zero
+	uint32_t nNext;		///< Index of the counter to be sent first
+};
+#endif
+}  // namespace diag
+
 inline artnetnode::FailSafe convert_failsafe(const lightset::FailSafe failsafe) {
 	if (failsafe > lightset::FailSafe::PLAYBACK) {
 		return artnetnode::FailSafe::LAST;
@@ -240,6 +424,25 @@ public:
 		return lightset::MergeMode::HTP;
 	}
 
+	const artnetnode::SequenceCounters& GetSequenceCounters(const uint32_t nPortIndex) const {
+		assert(nPortIndex < artnetnode::MAX_PORTS);
+		return m_OutputPort[nPortIndex].sequenceCounters;
+	}
+
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	void SetSyncMode(const artnetnode::sync::Mode mode, const uint32_t nLatencyMicros = artnetnode::sync::LATENCY_MICROS) {
+		m_SyncSchedule.mode = mode;
+		m_SyncSchedule.nLatencyMicros = nLatencyMicros;
+	}
+	artnetnode::sync::Mode GetSyncMode() const {
+		return m_SyncSchedule.mode;
+	}
+
+	const artnetnode::sync::Statistics& GetSyncStatistics() const {
+		return m_SyncStatistics;
+	}
+#endif
+
 #if defined (OUTPUT_HAVE_STYLESWITCH)
 	void SetOutputStyle(const uint32_t nPortIndex, lightset::OutputStyle outputStyle);
 	lightset::OutputStyle GetOutputStyle(const uint32_t nPortIndex) const;
@@ -272,6 +475,7 @@ public:
 
 	void SetPriority4(const uint32_t nPriority) {
 		m_ArtPollReply.AcnPriority = static_cast<uint8_t>(nPriority);
+		PollReplyInvalidate();
 
 		for (uint32_t nPortIndex = 0; nPortIndex < e131bridge::MAX_PORTS; nPortIndex++) {
 			E131Bridge::SetPriority(nPortIndex, static_cast<uint8_t>(nPriority));
@@ -394,11 +598,8 @@ public:
 	}
 
 	bool GetOutputPort(const uint16_t nUniverse, uint32_t& nPortIndex) {
-		for (nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
-			if (m_Node.Port[nPortIndex].direction != lightset::PortDir::OUTPUT) {
-				continue;
-			}
-			if ((m_Node.Port[nPortIndex].protocol == artnet::PortProtocol::ARTNET) && (nUniverse == m_Node.Port[nPortIndex].PortAddress)) {
+		for (nPortIndex = PortAddressFirst(nUniverse); nPortIndex != artnetnode::PORT_NONE; nPortIndex = PortAddressNext(nPortIndex, nUniverse)) {
+			if ((m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT) && (m_Node.Port[nPortIndex].protocol == artnet::PortProtocol::ARTNET)) {
 				return true;
 			}
 		}
@@ -505,6 +706,8 @@ public:
 		} else {
 			m_ArtPollReply.Status3 &= static_cast<uint8_t>(~artnet::Status3::SUPPORTS_LLRP);
 		}
+
+		PollReplyInvalidate();
 	}
 
 	static ArtNetNode* Get() {
@@ -539,7 +742,7 @@ private:
 	void SetUniverseSwitch(const uint32_t nPortIndex, const lightset::PortDir dir, const uint8_t nAddress);
 	void SetNetSwitch(const uint32_t nPortIndex, const uint8_t nNetSwitch);
 	void SetSubnetSwitch(const uint32_t nPortIndex, const uint8_t nSubnetSwitch);
-	void SendDiag([[maybe_unused]] const artnet::PriorityCodes priorityCode, [[maybe_unused]] const char *format, ...) {
+	void SendDiag([[maybe_unused]] const artnet::PriorityCodes priorityCode, [[maybe_unused]] const artnetnode::diag::Event event, [[maybe_unused]] const uint32_t nPortIndex = artnetnode::diag::PORT_NONE, [[maybe_unused]] const uint32_t nArg1 = 0, [[maybe_unused]] const uint32_t nArg2 = 0) {
 #if defined (ARTNET_ENABLE_SENDDIAG)
 		if (!m_State.SendArtDiagData) {
 			return;
@@ -549,28 +752,43 @@ private:
 			return;
 		}
 
-		m_DiagData.Priority = static_cast<uint8_t>(priorityCode);
-
-		va_list arp;
+		const auto nPort = (nPortIndex < artnetnode::MAX_PORTS) ? nPortIndex : artnetnode::MAX_PORTS;
+		auto& counter = m_DiagCounters.counter[static_cast<uint32_t>(event)][nPort];
 
-		va_start(arp, format);
-
-		auto i = vsnprintf(reinterpret_cast<char *>(m_DiagData.Data), sizeof(m_DiagData.Data) - 1, format, arp);
-
-		va_end(arp);
+		if (counter.nCount++ == 0) {
+			m_DiagCounters.nPending++;
+		}
 
-		m_DiagData.Data[sizeof(m_DiagData.Data) - 1] = '\0';	// Just be sure we have a last '\0'
-		m_DiagData.LengthLo = static_cast<uint8_t>(i + 1);		// Text length including the '\0'
+		counter.nPriority = static_cast<uint8_t>(priorityCode);
+		counter.nArg1 = static_cast<uint8_t>(nArg1);
+		counter.nArg2 = static_cast<uint8_t>(nArg2);
+#endif
+	}
 
-		const uint16_t nSize = sizeof(struct artnet::ArtDiagData) - sizeof(m_DiagData.Data) + m_DiagData.LengthLo;
+#if defined (ARTNET_ENABLE_SENDDIAG)
+	void DiagFlush();
 
-		Network::Get()->SendTo(m_nHandle, &m_DiagData, nSize, m_State.ArtDiagIpAddress, artnet::UDP_PORT);
-#endif
+	void static StaticCallbackFunctionDiagFlush([[maybe_unused]] TimerHandle_t timerHandle) {
+		s_pThis->DiagFlush();
 	}
+#endif
 
 	void HandlePoll();
 	void HandleDmx();
 	void HandleSync();
+	void SyncOutput();
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	void SyncMeasure(const uint32_t nMicros);
+	void SyncDeadline(const uint32_t nMicros);
+	void SyncProcess();
+
+	void static StaticCallbackFunctionSyncDeadline([[maybe_unused]] TimerHandle_t timerHandle) {
+		const auto nMicros = Hardware::Get()->Micros();
+		if ((s_pThis->m_SyncSchedule.IsArmed) && (static_cast<int32_t>(nMicros - s_pThis->m_SyncSchedule.nDeadlineMicros) >= 0)) {
+			s_pThis->SyncDeadline(nMicros);
+		}
+	}
+#endif
 	void HandleAddress();
 	void HandleTimeCode();
 	void HandleTimeSync();
@@ -590,10 +808,56 @@ private:
 		return artnet::make_port_address(m_Node.Port[nPage].NetSwitch, m_Node.Port[nPage].SubSwitch, nUniverse);
 	}
 
+	void UpdatePortAddressHash();
+
+	/*
+	 * Returns the enabled ports with the PortAddress, in port order.
+	 * artnetnode::PORT_NONE is the end.
+	 */
+	uint32_t PortAddressFirst(const uint16_t nPortAddress) const {
+		return PortAddressMatch(m_PortAddressHash[artnetnode::port_address_hash(nPortAddress)], nPortAddress);
+	}
+
+	uint32_t PortAddressNext(const uint32_t nPortIndex, const uint16_t nPortAddress) const {
+		return PortAddressMatch(m_PortAddressNext[nPortIndex], nPortAddress);
+	}
+
+	uint32_t PortAddressMatch(uint32_t nPortIndex, const uint16_t nPortAddress) const {
+		while ((nPortIndex != artnetnode::PORT_NONE) && (m_Node.Port[nPortIndex].PortAddress != nPortAddress)) {
+			nPortIndex = m_PortAddressNext[nPortIndex];
+		}
+		return nPortIndex;
+	}
+
 	void UpdateMergeStatus(const uint32_t nPortIndex);
 	void CheckMergeTimeouts(const uint32_t nPortIndex);
 
-	void ProcessPollReply(const uint32_t nPortIndex, uint32_t& NumPortsInput, uint32_t& NumPortsOutput);
+	uint32_t SourceLookup(const uint32_t nPortIndex, const uint32_t nIp, const uint8_t nPhysical) const;
+	uint32_t SourceAdd(const uint32_t nPortIndex, const uint32_t nIp, const uint8_t nPhysical);
+	void SourceRemove(const uint32_t nPortIndex, const uint32_t nSourceIndex);
+	void SourceClear(const uint32_t nPortIndex);
+
+	void DmxOutput(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t *pData, const uint32_t nLength);
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+	void ReorderHold(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t nSequence, const uint8_t *pData, const uint32_t nLength);
+	void ReorderFlush(const uint32_t nPortIndex);
+	void ReorderDrop(const uint32_t nPortIndex, const uint32_t nSourceIndex);
+	void ReorderRelease(const uint32_t nPortIndex, const uint32_t nSourceIndex);
+	void ReorderExpire();
+
+	void static StaticCallbackFunctionReorderExpire([[maybe_unused]] TimerHandle_t timerHandle) {
+		s_pThis->ReorderExpire();
+	}
+#endif
+
+	void ProcessPollReply(const uint32_t nPortIndex, artnet::ArtPollReply& artPollReply);
+	void PollReplyBuild(const uint32_t nPortIndex);
+	/**
+	 * The cached ArtPollReply pages are rebuilt when sent next
+	 */
+	void PollReplyInvalidate() {
+		m_nPollReplyGeneration++;
+	}
 	void SendPollReply(const uint32_t nBindIndex, const uint32_t nDestinationIp, artnet::ArtPollQueue *pQueue = nullptr);
 
 	void SendTod(uint32_t nPortIndex);
@@ -682,8 +946,24 @@ private:
 	artnetnode::State m_State;
 	artnetnode::OutputPort m_OutputPort[artnetnode::MAX_PORTS];
 	artnetnode::InputPort m_InputPort[artnetnode::MAX_PORTS];
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	artnetnode::sync::Schedule m_SyncSchedule;
+	artnetnode::sync::Statistics m_SyncStatistics;
+	TimerHandle_t m_SyncTimerId { TIMER_ID_NONE };	///< Running in synchronous mode
+#endif
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+	TimerHandle_t m_ReorderTimerId { TIMER_ID_NONE };	///< A packet is held
+	bool m_IsReorderIdle { false };						///< Nothing held at the last timer callback
+#endif
+	uint8_t m_PortAddressHash[artnetnode::PORT_ADDRESS_HASH_SIZE];	///< First enabled port in the bucket
+	uint8_t m_PortAddressNext[artnetnode::MAX_PORTS];				///< Next enabled port in the same bucket
 
 	artnet::ArtPollReply m_ArtPollReply;
+	artnet::ArtPollReply m_ArtPollReplyPage[artnetnode::MAX_PORTS];	///< Ready to send, per BindIndex
+	uint32_t m_nPollReplyPageGeneration[artnetnode::MAX_PORTS];
+	uint32_t m_nPollReplyGeneration { 1 };
+	uint32_t m_nPollReplyIp { 0 };
+	artnet::ReportCode m_PollReplyReportCode;
 #if defined (ARTNET_HAVE_DMXIN)
 	artnet::ArtDmx m_ArtDmx;
 #endif
@@ -706,6 +986,8 @@ private:
 #endif
 #if defined (ARTNET_ENABLE_SENDDIAG)
 	artnet::ArtDiagData m_DiagData;
+	artnetnode::diag::Counters m_DiagCounters;
+	TimerHandle_t m_DiagTimerId { TIMER_ID_NONE };
 #endif
 
 	static inline ArtNetNode *s_pThis;
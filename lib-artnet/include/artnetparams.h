@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2016-2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2016-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"); to deal
@@ -84,8 +84,11 @@ struct Params {
    uint32_t nDestinationIp[artnet::PORTS];
    // sACN E1.31
    uint8_t nPriority[artnet::PORTS];
+   // ArtSync
+   uint8_t nSyncMode;
+   uint16_t nSyncLatencyMicros;
    // Reserved
-   uint8_t Filler2[40];
+   uint8_t Filler2[37];
 } __attribute__((packed));
 
 static_assert(sizeof(struct Params) <= 320, "struct Params is too large");
@@ -104,6 +107,8 @@ struct Mask {
 	static constexpr uint32_t LABEL_C   			= (1U << 9);
 	static constexpr uint32_t LABEL_D   			= (1U << 10);
 	static constexpr uint32_t DISABLE_MERGE_TIMEOUT	= (1U << 11);
+	static constexpr uint32_t SYNC_MODE				= (1U << 12);
+	static constexpr uint32_t SYNC_LATENCY			= (1U << 13);
 	// Art-Net 4
 	static constexpr uint32_t ENABLE_RDM    		= (1U << 16);
 	static constexpr uint32_t MAP_UNIVERSE0 		= (1U << 17);
@@ -2,7 +2,7 @@
  * @file artnetparamsconst.h
  *
  */
-/* Copyright (C) 2019-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2019-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -61,6 +61,13 @@ struct ArtNetParamsConst {
 	};
 
 	static inline const char MAP_UNIVERSE0[] = "map_universe0";
+
+	/**
+	 * ArtSync
+	 */
+
+	static inline const char SYNC_MODE[] = "sync_mode";
+	static inline const char SYNC_LATENCY_US[] = "sync_latency_us";
 };
 
 #endif /* ARTNETPARAMSCONST_H_ */
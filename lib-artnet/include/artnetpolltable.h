@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2017-2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -30,41 +30,96 @@
 #define ARTNETPOLLTABLE_H_
 
 #include <cstdint>
+#include <cassert>
 
 #include "artnet.h"
 
+#include "net/hash.h"
+
+#if !defined (CONFIG_ARTNET_POLL_TABLE_NODES)
+# define CONFIG_ARTNET_POLL_TABLE_NODES 1024
+#endif
+#if !defined (CONFIG_ARTNET_POLL_TABLE_UNIVERSES)
+# define CONFIG_ARTNET_POLL_TABLE_UNIVERSES 4096
+#endif
+#if !defined (CONFIG_ARTNET_POLL_TABLE_NODE_UNIVERSES)
+# define CONFIG_ARTNET_POLL_TABLE_NODE_UNIVERSES 8192
+#endif
+
 namespace artnet {
 static constexpr uint32_t POLL_INTERVAL_SECONDS = 8;
 static constexpr uint32_t POLL_INTERVAL_MILLIS = (POLL_INTERVAL_SECONDS * 1000U);
-static constexpr uint32_t POLL_TABLE_SIZE_ENRIES = 255;
-static constexpr uint32_t POLL_TABLE_SIZE_NODE_UNIVERSES = 64;
-static constexpr uint32_t POLL_TABLE_SIZE_UNIVERSES = 512;
-
+/*
+ * The maximum sizes, the tables start with POLL_TABLE_SIZE_INITIAL entries and grow when needed.
+ */
+static constexpr uint32_t POLL_TABLE_SIZE_ENRIES = CONFIG_ARTNET_POLL_TABLE_NODES;
+static constexpr uint32_t POLL_TABLE_SIZE_UNIVERSES = CONFIG_ARTNET_POLL_TABLE_UNIVERSES;
+static constexpr uint32_t POLL_TABLE_SIZE_NODE_UNIVERSES = CONFIG_ARTNET_POLL_TABLE_NODE_UNIVERSES;	///< All nodes together
+static constexpr uint32_t POLL_TABLE_SIZE_INITIAL = 32;
+static constexpr uint16_t POLL_TABLE_NONE = 0xFFFF;
+static_assert(POLL_TABLE_SIZE_ENRIES < POLL_TABLE_NONE);
+static_assert(POLL_TABLE_SIZE_UNIVERSES < POLL_TABLE_NONE);
+static_assert(POLL_TABLE_SIZE_NODE_UNIVERSES < POLL_TABLE_NONE);
+
+/*
+ * A node is off-line when there is no ArtPollReply for 1.5 poll interval.
+ * The nodes are on a timing wheel, a slot holds the nodes expiring in the same second.
+ */
+static constexpr uint32_t POLL_TABLE_TIMEOUT_MILLIS = (3U * POLL_INTERVAL_MILLIS) / 2U;
+static constexpr uint32_t POLL_TABLE_WHEEL_SLOT_MILLIS = 1000;
+static constexpr uint32_t POLL_TABLE_WHEEL_SLOTS = 16;
+static constexpr uint32_t POLL_TABLE_WHEEL_MASK = POLL_TABLE_WHEEL_SLOTS - 1;
+static_assert((POLL_TABLE_WHEEL_SLOTS & POLL_TABLE_WHEEL_MASK) == 0);
+static_assert(((POLL_TABLE_WHEEL_SLOTS - 1) * POLL_TABLE_WHEEL_SLOT_MILLIS) > POLL_TABLE_TIMEOUT_MILLIS);
+
+/*
+ * A universe of a node, this is also the subscriber of the universe.
+ */
 struct NodeEntryUniverse {
 	uint8_t ShortName[artnet::SHORT_NAME_LENGTH];
-	uint32_t nLastUpdateMillis;
+	uint32_t IPAddress;
 	uint16_t nUniverse;
+	uint16_t nNodeNext;			///< Next universe of the node, or the next free entry
+	uint16_t nSubscriberNext;	///< Next subscriber of the universe
+	uint8_t nBindIndex;
 };
 
 struct NodeEntry {
 	uint32_t IPAddress;
+	uint32_t nLastUpdateMillis;
 	uint8_t Mac[artnet::MAC_SIZE];
 	uint8_t LongName[artnet::LONG_NAME_LENGTH];
 	uint16_t nUniversesCount;
-	struct NodeEntryUniverse Universe[artnet::POLL_TABLE_SIZE_NODE_UNIVERSES];
+	uint16_t nUniverseFirst;
+	uint16_t nHashNext;
+	uint16_t nWheelPrev;
+	uint16_t nWheelNext;
 };
 
 struct PollTableUniverses {
+	uint32_t nGeneration;	///< Changes when a node subscribes or unsubscribes, never 0
 	uint16_t nUniverse;
 	uint16_t nCount;
-	uint32_t *pIpAddresses;
+	uint16_t nSubscriberFirst;
+	uint16_t nHashNext;
 };
 
-struct PollTableClean {
-	uint32_t nTableIndex;
-	uint16_t nUniverseIndex;
-	bool bOffLine;
-};
+/*
+ * The nodes are hashed on their IP address, the universes on their Port-Address.
+ * Entries in the same bucket are chained.
+ */
+static constexpr uint32_t POLL_TABLE_NODES_HASH_SIZE = net::hash_size(2 * POLL_TABLE_SIZE_ENRIES);
+static constexpr uint32_t POLL_TABLE_NODES_HASH_MASK = POLL_TABLE_NODES_HASH_SIZE - 1;
+static constexpr uint32_t POLL_TABLE_UNIVERSES_HASH_SIZE = net::hash_size(2 * POLL_TABLE_SIZE_UNIVERSES);
+static constexpr uint32_t POLL_TABLE_UNIVERSES_HASH_MASK = POLL_TABLE_UNIVERSES_HASH_SIZE - 1;
+
+inline uint32_t poll_table_node_hash(const uint32_t nIpAddress) {
+	return net::hash_fibonacci(nIpAddress ^ (nIpAddress >> 16), POLL_TABLE_NODES_HASH_MASK);
+}
+
+inline uint32_t poll_table_universe_hash(const uint16_t nUniverse) {
+	return net::hash_fibonacci(nUniverse, POLL_TABLE_UNIVERSES_HASH_MASK);
+}
 }  // namespace artnet
 
 class ArtNetPollTable {
@@ -80,24 +135,82 @@ public:
 		return m_nPollTableEntries;
 	}
 
+	const artnet::NodeEntryUniverse *GetNodeEntryUniverse(const uint32_t nIndex) const {
+		assert(nIndex < m_nNodeUniversesSize);
+		return &m_pNodeUniverses[nIndex];
+	}
+
+	/**
+	 * @return The ports from ArtPollReply packets which did not fit in the tables
+	 */
+	uint32_t GetPollTableOverflow() const {
+		return m_nOverflow;
+	}
+
 	void Add(const struct artnet::ArtPollReply *ptArtPollReply);
 	void Clean();
 
+	/**
+	 * The subscribers are chained from nSubscriberFirst, see GetNodeEntryUniverse.
+	 */
 	const struct artnet::PollTableUniverses *GetIpAddress(uint16_t nUniverse) const;
 
 	void Dump();
 	void DumpTableUniverses();
 
 private:
-	void ProcessUniverse(const uint32_t nIpAddress, const uint16_t nUniverse);
-	void RemoveIpAddress(const uint16_t nUniverse, const uint32_t nIpAddress);
+	uint32_t NodeLookup(const uint32_t nIpAddress) const {
+		auto nNode = static_cast<uint32_t>(m_NodesHash[artnet::poll_table_node_hash(nIpAddress)]);
+		while ((nNode != artnet::POLL_TABLE_NONE) && (m_pPollTable[nNode].IPAddress != nIpAddress)) {
+			nNode = m_pPollTable[nNode].nHashNext;
+		}
+		return nNode;
+	}
+	uint32_t NodeAdd(const uint32_t nIpAddress);
+	void NodeRemove(const uint32_t nNode);
+	void NodeHashUnlink(const uint32_t nNode);
+	void WheelLink(const uint32_t nNode);
+	void WheelUnlink(const uint32_t nNode);
+
+	uint32_t UniverseLookup(const uint16_t nUniverse) const {
+		auto nEntry = static_cast<uint32_t>(m_UniversesHash[artnet::poll_table_universe_hash(nUniverse)]);
+		while ((nEntry != artnet::POLL_TABLE_NONE) && (m_pTableUniverses[nEntry].nUniverse != nUniverse)) {
+			nEntry = m_pTableUniverses[nEntry].nHashNext;
+		}
+		return nEntry;
+	}
+	void UniverseLink(const uint32_t nEntry);
+	void UniverseUnlink(const uint32_t nEntry);
+	bool UniverseSubscribe(const uint32_t nSubscriber);
+	void UniverseUnsubscribe(const uint32_t nSubscriber);
+
+	uint32_t NextGeneration() {
+		m_nGeneration = (m_nGeneration == UINT32_MAX) ? 1 : m_nGeneration + 1;
+		return m_nGeneration;
+	}
+
+	uint32_t SubscriberAlloc();
+	void SubscriberFree(const uint32_t nSubscriber) {
+		m_pNodeUniverses[nSubscriber].nNodeNext = m_nNodeUniversesFree;
+		m_nNodeUniversesFree = static_cast<uint16_t>(nSubscriber);
+	}
 
 private:
 	artnet::NodeEntry *m_pPollTable;
 	artnet::PollTableUniverses *m_pTableUniverses;
+	artnet::NodeEntryUniverse *m_pNodeUniverses;
+	uint32_t m_nPollTableSize;
+	uint32_t m_nTableUniversesSize;
+	uint32_t m_nNodeUniversesSize;
 	uint32_t m_nPollTableEntries { 0 };
 	uint32_t m_nTableUniversesEntries { 0 };
-	artnet::PollTableClean m_PollTableClean;
+	uint32_t m_nWheelTick;
+	uint32_t m_nOverflow { 0 };
+	uint32_t m_nGeneration { 0 };	///< Of the last subscriber change
+	uint16_t m_nNodeUniversesFree { artnet::POLL_TABLE_NONE };
+	uint16_t m_NodesHash[artnet::POLL_TABLE_NODES_HASH_SIZE];			///< First node in the bucket
+	uint16_t m_UniversesHash[artnet::POLL_TABLE_UNIVERSES_HASH_SIZE];	///< First universe in the bucket
+	uint16_t m_WheelHead[artnet::POLL_TABLE_WHEEL_SLOTS];				///< First node expiring in the slot
 };
 
 #endif /* ARTNETPOLLTABLE_H_ */
@@ -2,7 +2,7 @@
  * @file artnetcontroller.cpp
  *
  */
-/* Copyright (C) 2017-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2017-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -47,7 +47,7 @@ ArtNetController *ArtNetController::s_pThis;
 using namespace artnet;
 
 static constexpr uint32_t ARTNET_MIN_HEADER_SIZE = 12;
-static uint16_t s_ActiveUniverses[POLL_TABLE_SIZE_UNIVERSES] __attribute__ ((aligned (4)));
+static artnetcontroller::ActiveUniverse s_ActiveUniverses[artnetcontroller::MAX_UNIVERSES];
 
 ArtNetController::ArtNetController() {
 	DEBUG_ENTRY
@@ -135,6 +135,7 @@ ArtNetController::ArtNetController() {
 	m_ArtNetController.Oem[0] = ArtNetConst::OEM_ID[0];
 	m_ArtNetController.Oem[1] = ArtNetConst::OEM_ID[1];
 
+	memset(&m_DmxStatistics, 0, sizeof(struct artnetcontroller::DmxStatistics));
 	ActiveUniversesClear();
 
 	SetShortName(nullptr);
@@ -149,6 +150,12 @@ ArtNetController::~ArtNetController() {
 	delete m_pArtNetPacket;
 	m_pArtNetPacket = nullptr;
 
+	for (uint32_t nIndex = 0; nIndex < m_nActiveUniverses; nIndex++) {
+		delete[] s_ActiveUniverses[nIndex].pData;
+	}
+
+	ActiveUniversesClear();
+
 	DEBUG_EXIT
 }
 
@@ -251,77 +258,138 @@ void ArtNetController::Stop() {
 	DEBUG_EXIT
 }
 
-void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength, uint8_t nPortIndex) {
-	DEBUG_ENTRY
-
-	ActiveUniversesAdd(nUniverse);
+void ArtNetController::SendToSubscribers(const struct artnet::PollTableUniverses *pTableUniverses) {
+	auto nSubscriber = static_cast<uint32_t>(pTableUniverses->nSubscriberFirst);
 
-	m_pArtDmx->Physical = nPortIndex & 0xFF;
-	m_pArtDmx->PortAddress = nUniverse;
-	m_pArtDmx->LengthHi = static_cast<uint8_t>((nLength & 0xFF00) >> 8);
-	m_pArtDmx->Length = static_cast<uint8_t>(nLength & 0xFF);
+	while (nSubscriber != artnet::POLL_TABLE_NONE) {
+		const auto *pSubscriber = GetNodeEntryUniverse(nSubscriber);
+		Network::Get()->SendToQueue(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), pSubscriber->IPAddress, artnet::UDP_PORT);
+		nSubscriber = pSubscriber->nSubscriberNext;
+	}
+}
 
+/**
+ * If the number of universe subscribers exceeds 40 for a given universe, the transmitting device may broadcast.
+ */
+void ArtNetController::DmxSend(artnetcontroller::ActiveUniverse *pActiveUniverse, const struct artnet::PollTableUniverses *pTableUniverses, uint32_t nSubscribers) {
 	// The sequence number is used to ensure that ArtDmx packets are used in the correct order.
 	// This field is incremented in the range 0x01 to 0xff to allow the receiving node to resequence packets.
-	m_pArtDmx->Sequence++;
+	// The receiving node checks the sequence per universe.
+	auto& nSequence = (pActiveUniverse != nullptr) ? pActiveUniverse->nSequence : m_nSequence;
+	nSequence = static_cast<uint8_t>((nSequence == 0xFF) ? 1 : nSequence + 1);
 
-	if (m_pArtDmx->Sequence == 0) {
-		m_pArtDmx->Sequence = 1;
+	m_pArtDmx->Sequence = nSequence;
+
+	if (m_bUnicast && !m_bForceBroadcast && (nSubscribers <= 40)) {
+		SendToSubscribers(pTableUniverses);
+	} else {
+		Network::Get()->SendToQueue(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), Network::Get()->GetBroadcastIp(), artnet::UDP_PORT);
 	}
 
+	m_bDmxHandled = true;
+}
+
+/**
+ * A universe is sent when its data or its subscribers changed, otherwise once per refresh interval.
+ * The subscribers are compared by the generation of the poll table entry, 0 is broadcast.
+ */
+bool ArtNetController::DmxIsToBeSent(artnetcontroller::ActiveUniverse *pActiveUniverse, const uint8_t *pDmxData, uint32_t nLength, uint32_t nGeneration) {
+	if ((m_nDmxRefreshMillis == 0) || (pActiveUniverse == nullptr)) {
+		return true;
+	}
+
+	auto nSeed = nLength;
 #if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
-	if (__builtin_expect((m_nMaster == DMX_MAX_VALUE), 1)) {
+	nSeed |= (m_nMaster << 16);
 #endif
-		memcpy(m_pArtDmx->Data, pDmxData, nLength);
-#if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
-	} else if (m_nMaster == 0) {
-		memset(m_pArtDmx->Data, 0, nLength);
-	} else {
-		for (uint32_t i = 0; i < nLength; i++) {
-			m_pArtDmx->Data[i] = ((m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE) & 0xFF;
+	const auto nCurrentMillis = Hardware::Get()->Millis();
+
+	if (pActiveUniverse->bValid
+	 && (pActiveUniverse->nSeed == nSeed)
+	 && (pActiveUniverse->nGeneration == nGeneration)
+	 && (memcmp(pActiveUniverse->pData, pDmxData, nLength) == 0)) {
+		if ((nCurrentMillis - pActiveUniverse->nSentMillis) < m_nDmxRefreshMillis) {
+			m_DmxStatistics.nSuppressed++;
+			return false;
 		}
+
+		m_DmxStatistics.nRefresh++;
+	} else {
+		m_DmxStatistics.nChanged++;
 	}
-#endif
 
-	uint32_t nCount = 0;
-	auto IpAddresses = const_cast<struct artnet::PollTableUniverses *>(GetIpAddress(nUniverse));
+	if (pActiveUniverse->pData == nullptr) {
+		pActiveUniverse->pData = new uint8_t[artnet::DMX_LENGTH];
+		assert(pActiveUniverse->pData != nullptr);
+	}
+
+	memcpy(pActiveUniverse->pData, pDmxData, nLength);
+	pActiveUniverse->nSeed = nSeed;
+	pActiveUniverse->nGeneration = nGeneration;
+	pActiveUniverse->nSentMillis = nCurrentMillis;
+	pActiveUniverse->bValid = true;
+
+	return true;
+}
+
+void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength, uint8_t nPortIndex) {
+	DEBUG_ENTRY
+
+	auto *pActiveUniverse = ActiveUniversesAdd(nUniverse);
+
+	uint32_t nSubscribers = 0;
+	uint32_t nGeneration = 0;
+	const auto *pTableUniverses = GetIpAddress(nUniverse);
 
 	if (m_bUnicast && !m_bForceBroadcast) {
-		if (IpAddresses != nullptr) {
-			nCount = IpAddresses->nCount;
-		} else {
+		if (pTableUniverses == nullptr) {
 			DEBUG_EXIT
 			return;
 		}
-	}
-
-	// If the number of universe subscribers exceeds 40 for a given universe, the transmitting device may broadcast.
-
-	if (m_bUnicast && (nCount <= 40) && !m_bForceBroadcast) {
-		for (uint32_t nIndex = 0; nIndex < nCount; nIndex++) {
-			Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), IpAddresses->pIpAddresses[nIndex], artnet::UDP_PORT);
-		}
 
-		m_bDmxHandled = true;
+		nSubscribers = pTableUniverses->nCount;
+		nGeneration = pTableUniverses->nGeneration;
+	}
 
+	if (!DmxIsToBeSent(pActiveUniverse, pDmxData, nLength, nGeneration)) {
 		DEBUG_EXIT
 		return;
 	}
 
-	if (!m_bUnicast || (nCount > 40) || !m_bForceBroadcast) {
-		Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), Network::Get()->GetBroadcastIp(), artnet::UDP_PORT);
+	m_pArtDmx->Physical = nPortIndex & 0xFF;
+	m_pArtDmx->PortAddress = nUniverse;
+	m_pArtDmx->LengthHi = static_cast<uint8_t>((nLength & 0xFF00) >> 8);
+	m_pArtDmx->Length = static_cast<uint8_t>(nLength & 0xFF);
 
-		m_bDmxHandled = true;
+#if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
+	if (__builtin_expect((m_nMaster == DMX_MAX_VALUE), 1)) {
+#endif
+		memcpy(m_pArtDmx->Data, pDmxData, nLength);
+#if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
+	} else if (m_nMaster == 0) {
+		memset(m_pArtDmx->Data, 0, nLength);
+	} else {
+		for (uint32_t i = 0; i < nLength; i++) {
+			m_pArtDmx->Data[i] = ((m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE) & 0xFF;
+		}
 	}
+#endif
+
+	DmxSend(pActiveUniverse, pTableUniverses, nSubscribers);
 
 	DEBUG_EXIT
 }
 
+/**
+ * End of frame: the queued ArtDmx packets and the ArtSync leave together.
+ */
 void ArtNetController::HandleSync() {
 	if (m_bSynchronization && m_bDmxHandled) {
 		m_bDmxHandled = false;
-		Network::Get()->SendTo(m_nHandle, m_pArtSync, sizeof(struct ArtSync), Network::Get()->GetBroadcastIp(), artnet::UDP_PORT);
+		Network::Get()->SendToQueue(m_nHandle, m_pArtSync, sizeof(struct ArtSync), Network::Get()->GetBroadcastIp(), artnet::UDP_PORT);
 	}
+
+	Network::Get()->SendToQueueFlush();
 }
 
 void ArtNetController::HandleBlackout() {
@@ -331,49 +399,27 @@ void ArtNetController::HandleBlackout() {
 	memset(m_pArtDmx->Data, 0, 512);
 
 	for (uint32_t nIndex = 0; nIndex < m_nActiveUniverses; nIndex++) {
-		m_pArtDmx->PortAddress = s_ActiveUniverses[nIndex];
+		const auto nUniverse = s_ActiveUniverses[nIndex].nUniverse;
 
-		uint32_t nCount = 0;
-		const auto *IpAddresses = GetIpAddress(s_ActiveUniverses[nIndex]);
+		uint32_t nSubscribers = 0;
+		const auto *pTableUniverses = GetIpAddress(nUniverse);
 
 		if (m_bUnicast && !m_bForceBroadcast) {
-			if (IpAddresses != nullptr) {
-				nCount = IpAddresses->nCount;
-			} else {
+			if (pTableUniverses == nullptr) {
 				continue;
 			}
-		}
-
-		if (m_bUnicast && (nCount <= 40) && !m_bForceBroadcast) {
-			// The sequence number is used to ensure that ArtDmx packets are used in the correct order.
-			// This field is incremented in the range 0x01 to 0xff to allow the receiving node to resequence packets.
-			m_pArtDmx->Sequence++;
 
-			if (m_pArtDmx->Sequence == 0) {
-				m_pArtDmx->Sequence = 1;
-			}
-
-			for (uint32_t nIndex = 0; nIndex < nCount; nIndex++) {
-				Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), IpAddresses->pIpAddresses[nIndex], artnet::UDP_PORT);
-			}
-
-			continue;
+			nSubscribers = pTableUniverses->nCount;
 		}
 
-		if (!m_bUnicast || (nCount > 40) || !m_bForceBroadcast) {
-			// The sequence number is used to ensure that ArtDmx packets are used in the correct order.
-			// This field is incremented in the range 0x01 to 0xff to allow the receiving node to resequence packets.
-			m_pArtDmx->Sequence++;
-
-			if (m_pArtDmx->Sequence == 0) {
-				m_pArtDmx->Sequence = 1;
-			}
-
-			Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), Network::Get()->GetBroadcastIp(), artnet::UDP_PORT);
-		}
+		m_pArtDmx->PortAddress = nUniverse;
 
+		DmxSend(&s_ActiveUniverses[nIndex], pTableUniverses, nSubscribers);
 	}
 
+	// The first frame after the blackout is always sent
+	ActiveUniversesInvalidate();
+
 	m_bDmxHandled = true;
 	HandleSync();
 }
@@ -395,6 +441,7 @@ void ArtNetController::ProcessPoll() {
 #ifndef NDEBUG
 		Dump();
 		DumpTableUniverses();
+		printf("ArtDmx changed=%u, refresh=%u, suppressed=%u\n", static_cast<unsigned>(m_DmxStatistics.nChanged), static_cast<unsigned>(m_DmxStatistics.nRefresh), static_cast<unsigned>(m_DmxStatistics.nSuppressed));
 #endif
 	}
 
@@ -475,72 +522,69 @@ void ArtNetController::ActiveUniversesClear() {
 	m_nActiveUniverses = 0;
 }
 
-void ArtNetController::ActiveUniversesAdd(uint16_t nUniverse) {
-	DEBUG_ENTRY
-	DEBUG_PRINTF("nUniverse=%d", static_cast<int>(nUniverse));
-
-	int32_t nLow = 0;
-	int32_t nMid = 0;
-	auto nHigh = static_cast<int32_t>(m_nActiveUniverses);
-
-	if (m_nActiveUniverses == (sizeof(s_ActiveUniverses) / sizeof(s_ActiveUniverses[0]))) {
-		assert(0);
-		return;
+void ArtNetController::ActiveUniversesInvalidate() {
+	for (uint32_t nIndex = 0; nIndex < m_nActiveUniverses; nIndex++) {
+		s_ActiveUniverses[nIndex].bValid = false;
 	}
+}
 
-	while (nLow <= nHigh) {
+/**
+ * The active universes are kept sorted, the universe is inserted when not found.
+ * @return nullptr when the table is full
+ */
+artnetcontroller::ActiveUniverse *ArtNetController::ActiveUniversesAdd(uint16_t nUniverse) {
+	uint32_t nLow = 0;
+	auto nHigh = m_nActiveUniverses;
 
-		nMid = nLow + ((nHigh - nLow) / 2);
-		const uint32_t nMidValue = s_ActiveUniverses[nMid];
+	while (nLow < nHigh) {
+		const auto nMid = nLow + ((nHigh - nLow) / 2);
 
-		if (nMidValue < nUniverse) {
+		if (s_ActiveUniverses[nMid].nUniverse < nUniverse) {
 			nLow = nMid + 1;
-		} else if (nMidValue > nUniverse) {
-			nHigh = nMid - 1;
 		} else {
-			DEBUG_EXIT
-			return;
+			nHigh = nMid;
 		}
 	}
 
-	DEBUG_PRINTF("nLow=%d, nMid=%d, nHigh=%d", nLow, nMid, nHigh);
-
-	if ((nHigh != -1) && (m_nActiveUniverses != static_cast<uint32_t>(nHigh))) {
-
-		auto p16 = reinterpret_cast<uint16_t*>(s_ActiveUniverses);
-
-		assert(nLow >= 0);
-
-		//TODO Can we make i unsigned ?
-		for (uint32_t i = m_nActiveUniverses; i >= static_cast<uint32_t>(nLow); i--) {
-			p16[i + 1] = p16[i];
-		}
+	if ((nLow < m_nActiveUniverses) && (s_ActiveUniverses[nLow].nUniverse == nUniverse)) {
+		return &s_ActiveUniverses[nLow];
+	}
 
-		s_ActiveUniverses[nLow] = nUniverse;
+	if (m_nActiveUniverses == (sizeof(s_ActiveUniverses) / sizeof(s_ActiveUniverses[0]))) {
+		DEBUG_PRINTF("Active universes table is full: nUniverse=%u", static_cast<unsigned>(nUniverse));
+		return nullptr;
+	}
 
-		DEBUG_PRINTF(">m< nUniverse=%u, nLow=%d", nUniverse, nLow);
-	} else {
-		s_ActiveUniverses[m_nActiveUniverses] = nUniverse;
+	memmove(&s_ActiveUniverses[nLow + 1], &s_ActiveUniverses[nLow], (m_nActiveUniverses - nLow) * sizeof(s_ActiveUniverses[0]));
 
-		DEBUG_PRINTF(">a< nUniverse=%u, nMid=%d", nUniverse, nMid);
-	}
+	auto *pActiveUniverse = &s_ActiveUniverses[nLow];
+	memset(pActiveUniverse, 0, sizeof(s_ActiveUniverses[0]));
+	pActiveUniverse->nUniverse = nUniverse;
 
 	m_nActiveUniverses++;
 
-	DEBUG_EXIT
+	DEBUG_PRINTF("nUniverse=%u, nLow=%u, m_nActiveUniverses=%u", static_cast<unsigned>(nUniverse), static_cast<unsigned>(nLow), static_cast<unsigned>(m_nActiveUniverses));
+	return pActiveUniverse;
 }
 
 void ArtNetController::Print() {
 	puts("Art-Net Controller");
 	printf(" Max Node's    : %u\n", POLL_TABLE_SIZE_ENRIES);
 	printf(" Max Universes : %u\n", POLL_TABLE_SIZE_UNIVERSES);
+	printf(" Max Active    : %u\n", artnetcontroller::MAX_UNIVERSES);
 	if (!m_bUnicast) {
 		puts(" Unicast is disabled");
 	}
-	if (!m_bForceBroadcast) {
+	if (m_bForceBroadcast) {
 		puts(" Force broadcast is enabled");
 	}
 	if (!m_bSynchronization) {
 		puts(" Synchronization is disabled");
 	}
+	if (m_nDmxRefreshMillis != 0) {
+		printf(" Send on change: refresh %ums\n", static_cast<unsigned>(m_nDmxRefreshMillis));
+	} else {
+		puts(" Send on change is disabled");
+	}
+	printf(" ArtDmx changed=%u, refresh=%u, suppressed=%u\n", static_cast<unsigned>(m_DmxStatistics.nChanged), static_cast<unsigned>(m_DmxStatistics.nRefresh), static_cast<unsigned>(m_DmxStatistics.nSuppressed));
 }
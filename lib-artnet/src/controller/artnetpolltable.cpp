@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2017-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2017-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -36,6 +36,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 #include <cassert>
 
 #include "artnetpolltable.h"
@@ -50,38 +51,81 @@ union uip {
 	uint8_t u8[4];
 } static ip;
 
+template<typename T>
+static T *table_new(const uint32_t nSize) {
+	auto *pTable = new T[nSize];
+	assert(pTable != nullptr);
+
+	memset(pTable, 0, nSize * sizeof(T));
+	return pTable;
+}
+
+/**
+ * The tables are linked by index, so a table can be moved when it grows.
+ */
+template<typename T>
+static bool table_grow(T *&pTable, uint32_t& nSize, const uint32_t nSizeMax) {
+	if (nSize == nSizeMax) {
+		return false;
+	}
+
+	const auto nSizeNew = std::min(2 * nSize, nSizeMax);
+	auto *pTableNew = table_new<T>(nSizeNew);
+
+	memcpy(pTableNew, pTable, nSize * sizeof(T));
+
+	delete[] pTable;
+
+	pTable = pTableNew;
+	nSize = nSizeNew;
+
+	DEBUG_PRINTF("Grow %u", nSizeNew);
+	return true;
+}
+
+static uint32_t wheel_slot(const artnet::NodeEntry& node) {
+	return ((node.nLastUpdateMillis + artnet::POLL_TABLE_TIMEOUT_MILLIS) / artnet::POLL_TABLE_WHEEL_SLOT_MILLIS) & artnet::POLL_TABLE_WHEEL_MASK;
+}
+
 ArtNetPollTable::ArtNetPollTable() {
 	DEBUG_ENTRY
 
-	m_pPollTable = new artnet::NodeEntry[artnet::POLL_TABLE_SIZE_ENRIES];
-	assert(m_pPollTable != nullptr);
+	m_nPollTableSize = std::min(artnet::POLL_TABLE_SIZE_INITIAL, artnet::POLL_TABLE_SIZE_ENRIES);
+	m_pPollTable = table_new<artnet::NodeEntry>(m_nPollTableSize);
+
+	m_nTableUniversesSize = std::min(artnet::POLL_TABLE_SIZE_INITIAL, artnet::POLL_TABLE_SIZE_UNIVERSES);
+	m_pTableUniverses = table_new<artnet::PollTableUniverses>(m_nTableUniversesSize);
 
-	memset(m_pPollTable, 0, sizeof(artnet::NodeEntry[artnet::POLL_TABLE_SIZE_ENRIES]));
+	m_nNodeUniversesSize = std::min(artnet::POLL_TABLE_SIZE_INITIAL, artnet::POLL_TABLE_SIZE_NODE_UNIVERSES);
+	m_pNodeUniverses = table_new<artnet::NodeEntryUniverse>(m_nNodeUniversesSize);
 
-	m_pTableUniverses = new artnet::PollTableUniverses[artnet::POLL_TABLE_SIZE_UNIVERSES];
-	assert(m_pTableUniverses != nullptr);
+	for (uint32_t nIndex = 0; nIndex < m_nNodeUniversesSize; nIndex++) {
+		SubscriberFree(m_nNodeUniversesSize - 1 - nIndex);
+	}
+
+	for (auto& nNodeHash : m_NodesHash) {
+		nNodeHash = artnet::POLL_TABLE_NONE;
+	}
 
-	memset(m_pTableUniverses, 0, sizeof(artnet::PollTableUniverses[artnet::POLL_TABLE_SIZE_UNIVERSES]));
+	for (auto& nUniverseHash : m_UniversesHash) {
+		nUniverseHash = artnet::POLL_TABLE_NONE;
+	}
 
-	for (uint32_t nIndex = 0; nIndex < artnet::POLL_TABLE_SIZE_UNIVERSES; nIndex++) {
-		m_pTableUniverses[nIndex].pIpAddresses = new uint32_t[artnet::POLL_TABLE_SIZE_ENRIES];
-		assert(m_pTableUniverses[nIndex].pIpAddresses != nullptr);
+	for (auto& nWheelHead : m_WheelHead) {
+		nWheelHead = artnet::POLL_TABLE_NONE;
 	}
 
-	m_PollTableClean.nTableIndex = 0;
-	m_PollTableClean.nUniverseIndex = 0;
-	m_PollTableClean.bOffLine = true;
+	m_nWheelTick = Hardware::Get()->Millis() / artnet::POLL_TABLE_WHEEL_SLOT_MILLIS;
 
-	DEBUG_PRINTF("NodeEntry[%d] = %u bytes [%u Kb]", artnet::POLL_TABLE_SIZE_ENRIES, static_cast<unsigned int>(sizeof(artnet::NodeEntry[artnet::POLL_TABLE_SIZE_ENRIES])), static_cast<unsigned int>(sizeof(artnet::NodeEntry[artnet::POLL_TABLE_SIZE_ENRIES])) / 1024U);
-	DEBUG_PRINTF("PollTableUniverses[%d] = %u bytes [%u Kb]", artnet::POLL_TABLE_SIZE_UNIVERSES, static_cast<unsigned int>(sizeof(artnet::PollTableUniverses[artnet::POLL_TABLE_SIZE_UNIVERSES])), static_cast<unsigned int>(sizeof(artnet::PollTableUniverses[artnet::POLL_TABLE_SIZE_UNIVERSES])) / 1024U);
+	DEBUG_PRINTF("NodeEntry[%u] = %u bytes", artnet::POLL_TABLE_SIZE_ENRIES, static_cast<unsigned int>(sizeof(artnet::NodeEntry)));
+	DEBUG_PRINTF("PollTableUniverses[%u] = %u bytes", artnet::POLL_TABLE_SIZE_UNIVERSES, static_cast<unsigned int>(sizeof(artnet::PollTableUniverses)));
+	DEBUG_PRINTF("NodeEntryUniverse[%u] = %u bytes", artnet::POLL_TABLE_SIZE_NODE_UNIVERSES, static_cast<unsigned int>(sizeof(artnet::NodeEntryUniverse)));
 	DEBUG_EXIT
 }
 
 ArtNetPollTable::~ArtNetPollTable() {
-	for (uint32_t nIndex = 0; nIndex < artnet::POLL_TABLE_SIZE_UNIVERSES; nIndex++) {
-		delete[] m_pTableUniverses[nIndex].pIpAddresses;
-		m_pTableUniverses[nIndex].pIpAddresses = nullptr;
-	}
+	delete[] m_pNodeUniverses;
+	m_pNodeUniverses = nullptr;
 
 	delete[] m_pTableUniverses;
 	m_pTableUniverses = nullptr;
@@ -91,319 +135,369 @@ ArtNetPollTable::~ArtNetPollTable() {
 }
 
 const struct artnet::PollTableUniverses *ArtNetPollTable::GetIpAddress(uint16_t nUniverse) const {
-	if (m_nTableUniversesEntries == 0) {
+	const auto nEntry = UniverseLookup(nUniverse);
+
+	if (nEntry == artnet::POLL_TABLE_NONE) {
 		return nullptr;
 	}
 
-	// FIXME Universe lookup
-	for (uint32_t nEntry = 0; nEntry < m_nTableUniversesEntries; nEntry++) {
-		artnet::PollTableUniverses *pTableUniverses = &m_pTableUniverses[nEntry];
-		assert(pTableUniverses != nullptr);
+	return &m_pTableUniverses[nEntry];
+}
 
-		if (pTableUniverses->nUniverse == nUniverse) {
-			return &m_pTableUniverses[nEntry];
+uint32_t ArtNetPollTable::SubscriberAlloc() {
+	if (m_nNodeUniversesFree == artnet::POLL_TABLE_NONE) {
+		const auto nSize = m_nNodeUniversesSize;
+
+		if (!table_grow(m_pNodeUniverses, m_nNodeUniversesSize, artnet::POLL_TABLE_SIZE_NODE_UNIVERSES)) {
+			return artnet::POLL_TABLE_NONE;
+		}
+
+		for (auto nIndex = m_nNodeUniversesSize; nIndex > nSize; nIndex--) {
+			SubscriberFree(nIndex - 1);
 		}
 	}
 
-	return nullptr;
+	const auto nSubscriber = static_cast<uint32_t>(m_nNodeUniversesFree);
+	m_nNodeUniversesFree = m_pNodeUniverses[nSubscriber].nNodeNext;
+
+	return nSubscriber;
 }
 
+void ArtNetPollTable::UniverseLink(const uint32_t nEntry) {
+	const auto nHash = artnet::poll_table_universe_hash(m_pTableUniverses[nEntry].nUniverse);
 
-void ArtNetPollTable::RemoveIpAddress(const uint16_t nUniverse, const uint32_t nIpAddress) {
-	if (m_nTableUniversesEntries == 0) {
-		return;
+	m_pTableUniverses[nEntry].nHashNext = m_UniversesHash[nHash];
+	m_UniversesHash[nHash] = static_cast<uint16_t>(nEntry);
+}
+
+void ArtNetPollTable::UniverseUnlink(const uint32_t nEntry) {
+	auto *pEntry = &m_UniversesHash[artnet::poll_table_universe_hash(m_pTableUniverses[nEntry].nUniverse)];
+
+	while (*pEntry != nEntry) {
+		assert(*pEntry != artnet::POLL_TABLE_NONE);
+		pEntry = &m_pTableUniverses[*pEntry].nHashNext;
 	}
 
-	uint32_t nEntry = 0;
+	*pEntry = m_pTableUniverses[nEntry].nHashNext;
+}
 
-	// FIXME Universe lookup
-	for (nEntry = 0; nEntry < m_nTableUniversesEntries; nEntry++) {
-		artnet::PollTableUniverses *pTableUniverses = &m_pTableUniverses[nEntry];
-		assert(pTableUniverses != nullptr);
+bool ArtNetPollTable::UniverseSubscribe(const uint32_t nSubscriber) {
+	auto& subscriber = m_pNodeUniverses[nSubscriber];
+	auto nEntry = UniverseLookup(subscriber.nUniverse);
 
-		if (pTableUniverses->nUniverse == nUniverse) {
-			break;
+	if (nEntry == artnet::POLL_TABLE_NONE) {
+		if ((m_nTableUniversesEntries == m_nTableUniversesSize) && !table_grow(m_pTableUniverses, m_nTableUniversesSize, artnet::POLL_TABLE_SIZE_UNIVERSES)) {
+			DEBUG_PUTS("m_pTableUniverses is full");
+			return false;
 		}
-	}
 
-	if (nEntry == m_nTableUniversesEntries) {
-		// Universe not found
-		return;
+		// New universe
+		nEntry = m_nTableUniversesEntries++;
+		m_pTableUniverses[nEntry].nUniverse = subscriber.nUniverse;
+		m_pTableUniverses[nEntry].nCount = 0;
+		m_pTableUniverses[nEntry].nSubscriberFirst = artnet::POLL_TABLE_NONE;
+		UniverseLink(nEntry);
+		DEBUG_PRINTF("New Universe %u", subscriber.nUniverse);
 	}
 
-	artnet::PollTableUniverses *pTableUniverses = &m_pTableUniverses[nEntry];
-	assert(pTableUniverses->nCount > 0);
+	auto& tableUniverses = m_pTableUniverses[nEntry];
 
-	uint32_t nIpAddressIndex = 0;
+	subscriber.nSubscriberNext = tableUniverses.nSubscriberFirst;
+	tableUniverses.nSubscriberFirst = static_cast<uint16_t>(nSubscriber);
+	tableUniverses.nCount++;
+	tableUniverses.nGeneration = NextGeneration();
 
-	// FIXME IP lookup
-	for (nIpAddressIndex = 0; nIpAddressIndex < pTableUniverses->nCount; nIpAddressIndex++) {
-		if (pTableUniverses->pIpAddresses[nIpAddressIndex] == nIpAddress) {
-			break;
-		}
-	}
+	return true;
+}
 
-	auto *p32 = pTableUniverses->pIpAddresses;
-	int32_t i;
+/**
+ * The order of the universes is not relevant,
+ * a removed universe is replaced by the last entry.
+ */
+void ArtNetPollTable::UniverseUnsubscribe(const uint32_t nSubscriber) {
+	const auto nEntry = UniverseLookup(m_pNodeUniverses[nSubscriber].nUniverse);
+	assert(nEntry != artnet::POLL_TABLE_NONE);
+
+	auto *pTableUniverses = &m_pTableUniverses[nEntry];
+	auto *pSubscriber = &pTableUniverses->nSubscriberFirst;
 
-	for (i = static_cast<int32_t>(nIpAddressIndex); i < static_cast<int32_t>(pTableUniverses->nCount) - 1; i++) {
-		p32[i] = p32[i + 1];
+	while (*pSubscriber != nSubscriber) {
+		assert(*pSubscriber != artnet::POLL_TABLE_NONE);
+		pSubscriber = &m_pNodeUniverses[*pSubscriber].nSubscriberNext;
 	}
 
-	p32[i] = 0;
+	*pSubscriber = m_pNodeUniverses[nSubscriber].nSubscriberNext;
 
+	assert(pTableUniverses->nCount > 0);
 	pTableUniverses->nCount--;
 
-	if (pTableUniverses->nCount == 0) {
-		DEBUG_PRINTF("Delete Universe -> m_nTableUniversesEntries=%u, nEntry=%u", m_nTableUniversesEntries, nEntry);
+	if (pTableUniverses->nCount != 0) {
+		pTableUniverses->nGeneration = NextGeneration();
+		return;
+	}
 
-		artnet::PollTableUniverses *p = m_pTableUniverses;
+	DEBUG_PRINTF("Delete Universe -> m_nTableUniversesEntries=%u, nEntry=%u", m_nTableUniversesEntries, nEntry);
 
-		for (i = static_cast<int32_t>(nEntry); i < static_cast<int32_t>(m_nTableUniversesEntries) - 1; i++) {
-			p[i].nUniverse = p[i + 1].nUniverse;
-			p[i].nCount = p[i + 1].nCount;
-			p[i].pIpAddresses = p[i + 1].pIpAddresses;
-		}
+	UniverseUnlink(nEntry);
 
-		p[i].nUniverse = 0;
-		p[i].nCount = 0;
+	const auto nLast = m_nTableUniversesEntries - 1;
 
-		m_nTableUniversesEntries--;
+	if (nEntry != nLast) {
+		UniverseUnlink(nLast);
+		*pTableUniverses = m_pTableUniverses[nLast];
+		UniverseLink(nEntry);
 	}
+
+	m_nTableUniversesEntries--;
 }
 
-void ArtNetPollTable::ProcessUniverse(const uint32_t nIpAddress, const uint16_t nUniverse) {
-	DEBUG_ENTRY
+void ArtNetPollTable::WheelLink(const uint32_t nNode) {
+	auto& node = m_pPollTable[nNode];
+	auto& nWheelHead = m_WheelHead[wheel_slot(node)];
 
-	if (artnet::POLL_TABLE_SIZE_UNIVERSES == m_nTableUniversesEntries) {
-		DEBUG_PUTS("m_pTableUniverses is full");
-		DEBUG_EXIT
-		return;
+	node.nWheelPrev = artnet::POLL_TABLE_NONE;
+	node.nWheelNext = nWheelHead;
+
+	if (nWheelHead != artnet::POLL_TABLE_NONE) {
+		m_pPollTable[nWheelHead].nWheelPrev = static_cast<uint16_t>(nNode);
 	}
 
-	// FIXME Universe lookup
-	auto bFoundUniverse = false;
-	uint32_t nEntry = 0;
+	nWheelHead = static_cast<uint16_t>(nNode);
+}
 
-	for (nEntry = 0; nEntry < m_nTableUniversesEntries; nEntry++) {
-		auto *pTableUniverses = &m_pTableUniverses[nEntry];
-		assert(pTableUniverses != nullptr);
+void ArtNetPollTable::WheelUnlink(const uint32_t nNode) {
+	const auto& node = m_pPollTable[nNode];
 
-		if (pTableUniverses->nUniverse == nUniverse) {
-			bFoundUniverse = true;
-			DEBUG_PRINTF("Universe found %u", nUniverse);
-			break;
-		}
+	if (node.nWheelPrev == artnet::POLL_TABLE_NONE) {
+		m_WheelHead[wheel_slot(node)] = node.nWheelNext;
+	} else {
+		m_pPollTable[node.nWheelPrev].nWheelNext = node.nWheelNext;
 	}
 
-	auto *pTableUniverses = &m_pTableUniverses[nEntry];
-	auto bFoundIp = false;
-	uint32_t nCount = 0;
-
-	if (bFoundUniverse) {
-		// FIXME IP lookup
-		for (nCount = 0; nCount < pTableUniverses->nCount; nCount++) {
-			if (pTableUniverses->pIpAddresses[nCount] == nIpAddress) {
-				bFoundIp = true;
-				DEBUG_PUTS("IP found");
-				break;
-			}
-		}
-	} else {
-		// New universe
-		pTableUniverses->nUniverse = nUniverse;
-		m_nTableUniversesEntries++;
-		DEBUG_PRINTF("New Universe %d", static_cast<int>(nUniverse));
+	if (node.nWheelNext != artnet::POLL_TABLE_NONE) {
+		m_pPollTable[node.nWheelNext].nWheelPrev = node.nWheelPrev;
 	}
+}
 
-	if (!bFoundIp) {
-		if (pTableUniverses->nCount < artnet::POLL_TABLE_SIZE_ENRIES) {
-			pTableUniverses->pIpAddresses[pTableUniverses->nCount] = nIpAddress;
-			pTableUniverses->nCount++;
-			DEBUG_PUTS("It is a new IP for the Universe");
-		} else {
-			DEBUG_PUTS("New IP does not fit");
-		}
+void ArtNetPollTable::NodeHashUnlink(const uint32_t nNode) {
+	auto *pNode = &m_NodesHash[artnet::poll_table_node_hash(m_pPollTable[nNode].IPAddress)];
+
+	while (*pNode != nNode) {
+		assert(*pNode != artnet::POLL_TABLE_NONE);
+		pNode = &m_pPollTable[*pNode].nHashNext;
 	}
 
-	DEBUG_EXIT
+	*pNode = m_pPollTable[nNode].nHashNext;
 }
 
-void ArtNetPollTable::Add(const struct artnet::ArtPollReply *ptArtPollReply) {
-	DEBUG_ENTRY
-
-	auto bFound = false;
+uint32_t ArtNetPollTable::NodeAdd(const uint32_t nIpAddress) {
+	if ((m_nPollTableEntries == m_nPollTableSize) && !table_grow(m_pPollTable, m_nPollTableSize, artnet::POLL_TABLE_SIZE_ENRIES)) {
+		DEBUG_PUTS("Full");
+		return artnet::POLL_TABLE_NONE;
+	}
 
-	memcpy(ip.u8, ptArtPollReply->IPAddress, 4);
+	const auto nNode = m_nPollTableEntries++;
+	auto& node = m_pPollTable[nNode];
 
-	const auto nIpSwap = __builtin_bswap32(ip.u32);
+	memset(&node, 0, sizeof(struct artnet::NodeEntry));
 
-	int32_t i;
-	int32_t nLow = 0;
-	int32_t nMid;
-	auto nHigh = static_cast<int32_t>(m_nPollTableEntries);
+	node.IPAddress = nIpAddress;
+	node.nUniverseFirst = artnet::POLL_TABLE_NONE;
 
-	while (nLow <= nHigh) {
-		nMid = nLow + ((nHigh - nLow) / 2);
-		const auto nMidValue = __builtin_bswap32(m_pPollTable[nMid].IPAddress);
+	auto& nNodeHash = m_NodesHash[artnet::poll_table_node_hash(nIpAddress)];
+	node.nHashNext = nNodeHash;
+	nNodeHash = static_cast<uint16_t>(nNode);
 
-		if (nMidValue < nIpSwap) {
-			nLow = nMid + 1;
-		} else if (nMidValue > nIpSwap) {
-			nHigh = nMid - 1;
-		} else {
-			i = nMid;
-			bFound = true;
-			break;
-		}
-	}
+	node.nLastUpdateMillis = Hardware::Get()->Millis();
+	WheelLink(nNode);
 
-	if (!bFound) {
-		if (m_nPollTableEntries == artnet::POLL_TABLE_SIZE_ENRIES) {
-			DEBUG_PUTS("Full");
-			return;
-		}
+	DEBUG_PRINTF("Add -> %u", nNode);
+	return nNode;
+}
 
-		if (m_nPollTableEntries != static_cast<uint32_t>(nHigh)) {
-			DEBUG_PUTS("Move");
+/**
+ * The last node is moved in place, keeping its position on the timing wheel.
+ */
+void ArtNetPollTable::NodeRemove(const uint32_t nNode) {
+	auto nSubscriber = static_cast<uint32_t>(m_pPollTable[nNode].nUniverseFirst);
+
+	while (nSubscriber != artnet::POLL_TABLE_NONE) {
+		const auto nNext = static_cast<uint32_t>(m_pNodeUniverses[nSubscriber].nNodeNext);
+		UniverseUnsubscribe(nSubscriber);
+		SubscriberFree(nSubscriber);
+		nSubscriber = nNext;
+	}
 
-			auto *pArtNetNodeEntry = m_pPollTable; // TODO
+	NodeHashUnlink(nNode);
+	WheelUnlink(nNode);
 
-			assert(m_nPollTableEntries >= 1);
-			assert(nLow >= 0);
+	const auto nLast = m_nPollTableEntries - 1;
 
-			for (int32_t i = static_cast<int32_t>(m_nPollTableEntries) - 1;i >= nLow; i--) {
-				const struct artnet::NodeEntry *pSrc = &pArtNetNodeEntry[i];
-				struct artnet::NodeEntry *pDst = &pArtNetNodeEntry[i + 1];
-				memcpy(pDst, pSrc, sizeof(struct artnet::NodeEntry));
-			}
+	if (nNode != nLast) {
+		NodeHashUnlink(nLast);
 
-			auto *pDst = &pArtNetNodeEntry[nLow];
-			memset(pDst, 0, sizeof(struct artnet::NodeEntry));
+		auto& node = m_pPollTable[nNode];
+		node = m_pPollTable[nLast];
 
-			i = nLow;
+		if (node.nWheelPrev == artnet::POLL_TABLE_NONE) {
+			m_WheelHead[wheel_slot(node)] = static_cast<uint16_t>(nNode);
 		} else {
-			i = static_cast<int32_t>(m_nPollTableEntries);
-			DEBUG_PRINTF("Add -> i=%d", i);
+			m_pPollTable[node.nWheelPrev].nWheelNext = static_cast<uint16_t>(nNode);
 		}
 
-		m_pPollTable[i].IPAddress = ip.u32;
-		m_nPollTableEntries++;
-	}
+		if (node.nWheelNext != artnet::POLL_TABLE_NONE) {
+			m_pPollTable[node.nWheelNext].nWheelPrev = static_cast<uint16_t>(nNode);
+		}
 
-	if (ptArtPollReply->BindIndex <= 1) {
-		memcpy(m_pPollTable[i].Mac, ptArtPollReply->MAC, artnet::MAC_SIZE);
-		const uint8_t *pSrc = ptArtPollReply->LongName;
-		uint8_t *pDst = m_pPollTable[i].LongName;
-		memcpy(pDst, pSrc, artnet::LONG_NAME_LENGTH);
+		auto& nNodeHash = m_NodesHash[artnet::poll_table_node_hash(node.IPAddress)];
+		node.nHashNext = nNodeHash;
+		nNodeHash = static_cast<uint16_t>(nNode);
 	}
 
-	const auto nMillis = Hardware::Get()->Millis();
-
-	for (uint32_t nIndex = 0; nIndex < artnet::PORTS; nIndex++) {
-		const auto nPortAddress = ptArtPollReply->SwOut[nIndex];
+	m_nPollTableEntries--;
+}
 
-		if (ptArtPollReply->PortTypes[nIndex] == static_cast<uint8_t>(artnet::PortType::OUTPUT_ARTNET)) {
-			const auto nUniverse = artnet::make_port_address(ptArtPollReply->NetSwitch, ptArtPollReply->SubSwitch, nPortAddress);
+/**
+ * An ArtPollReply has the ports of one BindIndex,
+ * the universes of that BindIndex which are not in the reply are removed.
+ */
+void ArtNetPollTable::Add(const struct artnet::ArtPollReply *ptArtPollReply) {
+	DEBUG_ENTRY
 
-			uint32_t nIndexUniverse;
+	memcpy(ip.u8, ptArtPollReply->IPAddress, 4);
 
-			for (nIndexUniverse = 0; nIndexUniverse < m_pPollTable[i].nUniversesCount; nIndexUniverse++) {
-				if (m_pPollTable[i].Universe[nIndexUniverse].nUniverse == nUniverse) {
-					break;
-				}
-			}
+	auto nNode = NodeLookup(ip.u32);
 
-			if (nIndexUniverse == m_pPollTable[i].nUniversesCount) {
-				// Not found
-				if (m_pPollTable[i].nUniversesCount < artnet::POLL_TABLE_SIZE_NODE_UNIVERSES) {
-					m_pPollTable[i].nUniversesCount++;
-					m_pPollTable[i].Universe[nIndexUniverse].nUniverse = nUniverse;
-					const uint8_t *pSrc = ptArtPollReply->ShortName;
-					uint8_t *pDst = m_pPollTable[i].Universe[nIndexUniverse].ShortName;
-					memcpy(pDst, pSrc, artnet::SHORT_NAME_LENGTH);
-					ProcessUniverse(ip.u32, nUniverse);
-				} else {
-					// No room
-					continue;
-				}
-			}
+	if (nNode == artnet::POLL_TABLE_NONE) {
+		nNode = NodeAdd(ip.u32);
 
-			m_pPollTable[i].Universe[nIndexUniverse].nLastUpdateMillis = nMillis;
+		if (nNode == artnet::POLL_TABLE_NONE) {
+			m_nOverflow++;
+			DEBUG_EXIT
+			return;
 		}
+	} else {
+		WheelUnlink(nNode);
+		m_pPollTable[nNode].nLastUpdateMillis = Hardware::Get()->Millis();
+		WheelLink(nNode);
 	}
 
-	DEBUG_EXIT;
-}
+	auto& node = m_pPollTable[nNode];
 
-void ArtNetPollTable::Clean() {
-	if (m_nPollTableEntries == 0) {
-		return;
+	if (ptArtPollReply->BindIndex <= 1) {
+		memcpy(node.Mac, ptArtPollReply->MAC, artnet::MAC_SIZE);
+		memcpy(node.LongName, ptArtPollReply->LongName, artnet::LONG_NAME_LENGTH);
 	}
 
-	assert(m_PollTableClean.nTableIndex < m_nPollTableEntries);
-	assert(m_PollTableClean.nUniverseIndex < artnet::POLL_TABLE_SIZE_NODE_UNIVERSES);
+	const auto nBindIndex = std::max(ptArtPollReply->BindIndex, static_cast<uint8_t>(1));
+	uint16_t nUniverses[artnet::PORTS];
+	uint32_t nUniversesCount = 0;
 
-	if (m_PollTableClean.nUniverseIndex == 0) {
-		m_PollTableClean.bOffLine = true;
+	for (uint32_t nIndex = 0; nIndex < artnet::PORTS; nIndex++) {
+		if (ptArtPollReply->PortTypes[nIndex] == static_cast<uint8_t>(artnet::PortType::OUTPUT_ARTNET)) {
+			nUniverses[nUniversesCount++] = artnet::make_port_address(ptArtPollReply->NetSwitch, ptArtPollReply->SubSwitch, ptArtPollReply->SwOut[nIndex]);
+		}
 	}
 
-	auto *pArtNetNodeEntryBind = &m_pPollTable[m_PollTableClean.nTableIndex].Universe[m_PollTableClean.nUniverseIndex];
+	auto *pSubscriber = &node.nUniverseFirst;
 
-	if (pArtNetNodeEntryBind->nLastUpdateMillis != 0) {
-		if ((Hardware::Get()->Millis() - pArtNetNodeEntryBind->nLastUpdateMillis) > (1.5 * artnet::POLL_INTERVAL_MILLIS)) {
-			pArtNetNodeEntryBind->nLastUpdateMillis = 0;
-			RemoveIpAddress(pArtNetNodeEntryBind->nUniverse, m_pPollTable[m_PollTableClean.nTableIndex].IPAddress);
-		} else {
-			m_PollTableClean.bOffLine = false;
+	while (*pSubscriber != artnet::POLL_TABLE_NONE) {
+		const auto nSubscriber = static_cast<uint32_t>(*pSubscriber);
+		const auto& subscriber = m_pNodeUniverses[nSubscriber];
+
+		if ((subscriber.nBindIndex == nBindIndex) && (std::find(nUniverses, &nUniverses[nUniversesCount], subscriber.nUniverse) == &nUniverses[nUniversesCount])) {
+			*pSubscriber = subscriber.nNodeNext;
+			node.nUniversesCount--;
+			UniverseUnsubscribe(nSubscriber);
+			SubscriberFree(nSubscriber);
+			continue;
 		}
+
+		pSubscriber = &m_pNodeUniverses[nSubscriber].nNodeNext;
 	}
 
-	m_PollTableClean.nUniverseIndex++;
+	for (uint32_t nIndex = 0; nIndex < nUniversesCount; nIndex++) {
+		auto nSubscriber = static_cast<uint32_t>(node.nUniverseFirst);
+
+		while ((nSubscriber != artnet::POLL_TABLE_NONE) && (m_pNodeUniverses[nSubscriber].nUniverse != nUniverses[nIndex])) {
+			nSubscriber = m_pNodeUniverses[nSubscriber].nNodeNext;
+		}
 
-	if (m_PollTableClean.nUniverseIndex == artnet::POLL_TABLE_SIZE_NODE_UNIVERSES) {
-		if (m_PollTableClean.bOffLine) {
-			DEBUG_PUTS("Node is off-line");
+		if (nSubscriber == artnet::POLL_TABLE_NONE) {
+			nSubscriber = SubscriberAlloc();
 
-			auto *pArtNetNodeEntry = m_pPollTable;
-			// Move
-			for (uint32_t i = m_PollTableClean.nTableIndex; i < (m_nPollTableEntries - 1); i++) {
-				const auto *pSrc = &pArtNetNodeEntry[i + 1];
-				auto *pDst = &pArtNetNodeEntry[i];
-				memcpy(pDst, pSrc, sizeof(struct artnet::NodeEntry));
+			if (nSubscriber == artnet::POLL_TABLE_NONE) {
+				m_nOverflow++;
+				continue;
 			}
 
-			m_nPollTableEntries--;
+			auto& subscriber = m_pNodeUniverses[nSubscriber];
+			subscriber.IPAddress = ip.u32;
+			subscriber.nUniverse = nUniverses[nIndex];
 
-			auto *pDst = &pArtNetNodeEntry[m_nPollTableEntries];
-			pDst->IPAddress = 0;
-			pDst->nUniversesCount = 0;
-			memset(pDst->Universe, 0, sizeof(struct artnet::NodeEntryUniverse[artnet::POLL_TABLE_SIZE_NODE_UNIVERSES]));
-#ifndef NDEBUG
-			memset(pDst->Mac, 0, artnet::MAC_SIZE + artnet::LONG_NAME_LENGTH);
-#endif
+			if (!UniverseSubscribe(nSubscriber)) {
+				SubscriberFree(nSubscriber);
+				m_nOverflow++;
+				continue;
+			}
+
+			subscriber.nNodeNext = node.nUniverseFirst;
+			node.nUniverseFirst = static_cast<uint16_t>(nSubscriber);
+			node.nUniversesCount++;
 		}
 
-		m_PollTableClean.nUniverseIndex = 0;
-		m_PollTableClean.bOffLine = true;
-		m_PollTableClean.nTableIndex++;
+		auto& subscriber = m_pNodeUniverses[nSubscriber];
+		subscriber.nBindIndex = nBindIndex;
+		memcpy(subscriber.ShortName, ptArtPollReply->ShortName, artnet::SHORT_NAME_LENGTH);
+	}
+
+	DEBUG_EXIT
+}
 
-		if (m_PollTableClean.nTableIndex >= m_nPollTableEntries) {
-			m_PollTableClean.nTableIndex = 0;
+/**
+ * The timing wheel slots before the current second are expired,
+ * the cost is the number of expired nodes.
+ */
+void ArtNetPollTable::Clean() {
+	const auto nMillis = Hardware::Get()->Millis();
+	const auto nTick = nMillis / artnet::POLL_TABLE_WHEEL_SLOT_MILLIS;
+
+	if ((nTick - m_nWheelTick) > artnet::POLL_TABLE_WHEEL_SLOTS) {
+		m_nWheelTick = nTick - artnet::POLL_TABLE_WHEEL_SLOTS;
+	}
+
+	while (m_nWheelTick != nTick) {
+		auto nNode = static_cast<uint32_t>(m_WheelHead[m_nWheelTick & artnet::POLL_TABLE_WHEEL_MASK]);
+
+		while (nNode != artnet::POLL_TABLE_NONE) {
+			const auto nNext = static_cast<uint32_t>(m_pPollTable[nNode].nWheelNext);
+
+			// Only after Clean has not been called for a full turn of the wheel, a node can be in the slot before expiring
+			if ((nMillis - m_pPollTable[nNode].nLastUpdateMillis) > artnet::POLL_TABLE_TIMEOUT_MILLIS) {
+				DEBUG_PUTS("Node is off-line");
+				const auto nLast = m_nPollTableEntries - 1;
+				NodeRemove(nNode);
+				// The last node has been moved to nNode
+				nNode = (nNext == nLast) ? nNode : nNext;
+			} else {
+				nNode = nNext;
+			}
 		}
+
+		m_nWheelTick++;
 	}
 }
 
 void ArtNetPollTable::Dump() {
 #ifndef NDEBUG
-	printf("Entries : %d\n", m_nPollTableEntries);
+	printf("Entries : %u\n", m_nPollTableEntries);
 
 	for (uint32_t i = 0; i < m_nPollTableEntries; i++) {
-		printf("\t" IPSTR " [" MACSTR "] |%-64s|\n", IP2STR(m_pPollTable[i].IPAddress), MAC2STR(m_pPollTable[i].Mac), m_pPollTable[i].LongName);
+		printf("\t" IPSTR " [" MACSTR "] |%-64s| [%u]\n", IP2STR(m_pPollTable[i].IPAddress), MAC2STR(m_pPollTable[i].Mac), m_pPollTable[i].LongName, (Hardware::Get()->Millis() - m_pPollTable[i].nLastUpdateMillis) / 1000U);
 
-		for (uint32_t nUniverse = 0; nUniverse < m_pPollTable[i].nUniversesCount; nUniverse++) {
-			auto *pArtNetNodeEntryUniverse = &m_pPollTable[i].Universe[nUniverse];
-			printf("\t %u [%u] |%-18s|\n", pArtNetNodeEntryUniverse->nUniverse, (Hardware::Get()->Millis() - pArtNetNodeEntryUniverse->nLastUpdateMillis) / 1000U, pArtNetNodeEntryUniverse->ShortName);
+		for (auto nSubscriber = static_cast<uint32_t>(m_pPollTable[i].nUniverseFirst); nSubscriber != artnet::POLL_TABLE_NONE; nSubscriber = m_pNodeUniverses[nSubscriber].nNodeNext) {
+			const auto *pArtNetNodeEntryUniverse = &m_pNodeUniverses[nSubscriber];
+			printf("\t %u:%u |%-18s|\n", pArtNetNodeEntryUniverse->nBindIndex, pArtNetNodeEntryUniverse->nUniverse, pArtNetNodeEntryUniverse->ShortName);
 		}
 		puts("");
 	}
@@ -412,19 +506,15 @@ void ArtNetPollTable::Dump() {
 
 void ArtNetPollTable::DumpTableUniverses() {
 #ifndef NDEBUG
-	printf("Entries : %d\n", m_nTableUniversesEntries);
+	printf("Entries : %u\n", m_nTableUniversesEntries);
 
 	for (uint32_t nEntry = 0; nEntry < m_nTableUniversesEntries; nEntry++) {
 		const auto *pTableUniverses = &m_pTableUniverses[nEntry];
-		assert(pTableUniverses != nullptr);
-
-		printf("%3d |%4u | %d ", nEntry, pTableUniverses->nUniverse, pTableUniverses->nCount);
 
-		const auto *pIpAddresses = pTableUniverses->pIpAddresses;
-		assert(pIpAddresses != nullptr);
+		printf("%3u |%4u | %u ", nEntry, pTableUniverses->nUniverse, pTableUniverses->nCount);
 
-		for (uint32_t nCount = 0; nCount < pTableUniverses->nCount; nCount++) {
-			printf(" " IPSTR, IP2STR(pIpAddresses[nCount]));
+		for (auto nSubscriber = static_cast<uint32_t>(pTableUniverses->nSubscriberFirst); nSubscriber != artnet::POLL_TABLE_NONE; nSubscriber = m_pNodeUniverses[nSubscriber].nSubscriberNext) {
+			printf(" " IPSTR, IP2STR(m_pNodeUniverses[nSubscriber].IPAddress));
 		}
 
 		puts("");
@@ -2,7 +2,7 @@
  * @file json_status.cpp
  *
  */
-/* Copyright (C) 2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2024-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -52,12 +52,19 @@ static uint32_t get_entry(const uint32_t nIndex, char *pOutBuffer, const uint32_
 			"{\"name\":\"%s\",\"ip\":\"" IPSTR "\",\"mac\":\"" MACSTR "\",\"ports\":[",
 			pPollTable[nIndex].LongName, IP2STR(pPollTable[nIndex].IPAddress), MAC2STR(pPollTable[nIndex].Mac)));
 
-	for (uint32_t nUniverse = 0; nUniverse < pPollTable[nIndex].nUniversesCount; nUniverse++) {
-		const auto *pArtNetNodeEntryUniverse = &pPollTable[nIndex].Universe[nUniverse];
-		nLength += get_port(pArtNetNodeEntryUniverse, &pOutBuffer[nLength], nLength);
+	for (auto nSubscriber = static_cast<uint32_t>(pPollTable[nIndex].nUniverseFirst); (nSubscriber != ::artnet::POLL_TABLE_NONE) && (nLength < nOutBufferSize); nSubscriber = ArtNetController::Get()->GetNodeEntryUniverse(nSubscriber)->nNodeNext) {
+		const auto *pArtNetNodeEntryUniverse = ArtNetController::Get()->GetNodeEntryUniverse(nSubscriber);
+		nLength += get_port(pArtNetNodeEntryUniverse, &pOutBuffer[nLength], nOutBufferSize - nLength);
+	}
+
+	if (nLength >= nOutBufferSize) {
+		return 0;
+	}
+
+	if (pOutBuffer[nLength - 1] == ',') {
+		nLength--;
 	}
 
-	nLength--;
 	nLength += static_cast<uint32_t>(snprintf(&pOutBuffer[nLength], nOutBufferSize - nLength, "]},"));
 
 	if (nLength <= nOutBufferSize) {
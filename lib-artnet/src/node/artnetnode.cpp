@@ -3,7 +3,7 @@
  *
  */
 
-/* Copyright (C) 2016-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2016-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -90,6 +90,7 @@ ArtNetNode::ArtNetNode() {
 #if (ARTNET_VERSION >= 4)
 	m_ArtPollReply.AcnPriority = e131::priority::DEFAULT;
 #endif
+	memset(m_nPollReplyPageGeneration, 0, sizeof(m_nPollReplyPageGeneration));
 
 	memset(&m_State, 0, sizeof(struct artnetnode::State));
 	m_State.reportCode = artnet::ReportCode::RCPOWEROK;
@@ -106,14 +107,15 @@ ArtNetNode::ArtNetNode() {
 		port.direction = lightset::PortDir::DISABLE;
 	}
 
+	UpdatePortAddressHash();
+
 	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
 		SetShortName(nPortIndex, nullptr);	// Set default port label
 	}
 
 	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
 		memset(&m_OutputPort[nPortIndex], 0, sizeof(struct artnetnode::OutputPort));
-		m_OutputPort[nPortIndex].SourceA.nPhysical = 0x100;
-		m_OutputPort[nPortIndex].SourceB.nPhysical = 0x100;
+		SourceClear(nPortIndex);
 		m_OutputPort[nPortIndex].GoodOutputB = artnet::GoodOutputB::RDM_DISABLED | artnet::GoodOutputB::DISCOVERY_NOT_RUNNING;
 		memset(&m_InputPort[nPortIndex], 0, sizeof(struct artnetnode::InputPort));
 		m_InputPort[nPortIndex].nDestinationIp = Network::Get()->GetBroadcastIp();
@@ -140,6 +142,14 @@ ArtNetNode::ArtNetNode() {
 	memcpy(m_DiagData.Id, artnet::NODE_ID, sizeof(m_DiagData.Id));
 	m_DiagData.OpCode = static_cast<uint16_t>(artnet::OpCodes::OP_DIAGDATA);
 	m_DiagData.ProtVerLo = artnet::PROTOCOL_REVISION;
+	memset(&m_DiagCounters, 0, sizeof(struct artnetnode::diag::Counters));
+#endif
+
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	memset(&m_SyncSchedule, 0, sizeof(struct artnetnode::sync::Schedule));
+	m_SyncSchedule.nLatencyMicros = artnetnode::sync::LATENCY_MICROS;
+	m_SyncSchedule.mode = artnetnode::sync::Mode::IMMEDIATE;
+	memset(&m_SyncStatistics, 0, sizeof(struct artnetnode::sync::Statistics));
 #endif
 
 	DEBUG_EXIT
@@ -187,6 +197,8 @@ void ArtNetNode::Start() {
 	m_ArtPollReply.Status3 |= artnet::Status3::OUTPUT_SWITCH;
 #endif
 
+	PollReplyInvalidate();
+
 	m_nHandle = Network::Get()->Begin(artnet::UDP_PORT);
 	assert(m_nHandle != -1);
 
@@ -231,6 +243,9 @@ void ArtNetNode::Start() {
 #endif
 
 	SoftwareTimerAdd(200, StaticCallbackFunctionLedPanelOff);
+#if defined (ARTNET_ENABLE_SENDDIAG)
+	m_DiagTimerId = SoftwareTimerAdd(1000U / artnetnode::diag::PACKETS_PER_SECOND, StaticCallbackFunctionDiagFlush);
+#endif
 
 	m_State.status = artnet::Status::ON;
 	Hardware::Get()->SetMode(hardware::ledblink::Mode::NORMAL);
@@ -241,6 +256,31 @@ void ArtNetNode::Start() {
 void ArtNetNode::Stop() {
 	DEBUG_ENTRY
 
+#if defined (ARTNET_ENABLE_SENDDIAG)
+	if (m_DiagTimerId != TIMER_ID_NONE) {
+		SoftwareTimerDelete(m_DiagTimerId);
+	}
+#endif
+
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	if (m_SyncTimerId != TIMER_ID_NONE) {
+		SoftwareTimerDelete(m_SyncTimerId);
+	}
+	m_SyncSchedule.IsArmed = false;
+#endif
+
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+	if (m_ReorderTimerId != TIMER_ID_NONE) {
+		SoftwareTimerDelete(m_ReorderTimerId);
+	}
+
+	m_IsReorderIdle = false;
+
+	for (auto& outputPort : m_OutputPort) {
+		outputPort.reorderWindow.IsHeld = false;
+	}
+#endif
+
 #if (ARTNET_VERSION >= 4)
 	E131Bridge::Stop();
 #endif
@@ -268,6 +308,7 @@ void ArtNetNode::Stop() {
 
 	m_ArtPollReply.Status1 = static_cast<uint8_t>((m_ArtPollReply.Status1 & ~artnet::Status1::INDICATOR_MASK) | artnet::Status1::INDICATOR_MUTE_MODE);
 	m_State.status = artnet::Status::STANDBY;
+	PollReplyInvalidate();
 
 	DEBUG_EXIT
 }
@@ -284,6 +325,7 @@ void ArtNetNode::SetShortName(const uint32_t nPortIndex, const char *pShortName)
 	}
 
 	m_Node.Port[nPortIndex].ShortName[artnet::SHORT_NAME_LENGTH - 1] = '\0';
+	PollReplyInvalidate();
 
 	if (m_State.status == artnet::Status::ON) {
 		ArtNetStore::SaveShortName(nPortIndex, m_Node.Port[nPortIndex].ShortName);
@@ -324,6 +366,7 @@ void ArtNetNode::SetLongName(const char *pLongName) {
 	}
 
 	m_ArtPollReply.LongName[artnet::LONG_NAME_LENGTH - 1] = '\0';
+	PollReplyInvalidate();
 
 	if (m_State.status == artnet::Status::ON) {
 		ArtNetStore::SaveLongName(reinterpret_cast<char *>(m_ArtPollReply.LongName));
@@ -373,7 +416,7 @@ void ArtNetNode::SetNetworkDataLossCondition() {
 	m_State.IsMergeMode = false;
 	m_State.IsSynchronousMode = false;
 
-	uint32_t nIpCount = 0;
+	uint32_t nSourcesMask = 0;
 
 	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
 #if defined (ARTNET_HAVE_DMXIN)
@@ -381,13 +424,13 @@ void ArtNetNode::SetNetworkDataLossCondition() {
 			continue;
 		}
 #endif
-		nIpCount += (m_OutputPort[nPortIndex].SourceA.nIp + m_OutputPort[nPortIndex].SourceB.nIp);
-		if (nIpCount != 0) {
+		nSourcesMask |= m_OutputPort[nPortIndex].nSourcesMask;
+		if (nSourcesMask != 0) {
 			break;
 		}
 	}
 
-	if (nIpCount == 0) {
+	if (nSourcesMask == 0) {
 		return;
 	}
 
@@ -416,8 +459,7 @@ void ArtNetNode::SetNetworkDataLossCondition() {
 	}
 
 	for (uint32_t i = 0; i < artnetnode::MAX_PORTS; i++) {
-		m_OutputPort[i].SourceA.nIp = 0;
-		m_OutputPort[i].SourceB.nIp = 0;
+		SourceClear(i);
 		lightset::Data::ClearLength(i);
 	}
 
@@ -449,6 +491,16 @@ static artnet::OpCodes get_op_code(const uint32_t nBytesReceived, const uint8_t
 #endif
 
 void ArtNetNode::Process(const uint32_t nBytesReceived) {
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	SyncProcess();
+#endif
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+	if (__builtin_expect(m_IsReorderIdle, 0)) {
+		m_IsReorderIdle = false;
+		SoftwareTimerDelete(m_ReorderTimerId);
+	}
+#endif
+
 	if (__builtin_expect((nBytesReceived == 0), 1)) {
 		const auto nDeltaMillis = m_nCurrentPacketMillis - m_nPreviousPacketMillis;
 
@@ -0,0 +1,136 @@
+/**
+ * @file artnetnodediag.cpp
+ *
+ */
+/**
+ * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if defined (ARTNET_ENABLE_SENDDIAG)
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+#include "artnetnode.h"
+#include "artnet.h"
+
+#include "network.h"
+
+using namespace artnetnode::diag;
+
+/*
+ * The arguments are the port index, arg1 and arg2.
+ */
+static constexpr const char *s_pFormat[] = {
+	"%u: Leaving Merging Mode",
+	"%u: Single source %u",
+	"%u: Merge source %u",
+	"%u: Buffering data",
+	"%u: Send data",
+	"%u:%u More than %u sources, discarding data",
+	"%u:%u New source %u",
+	"%u: Discarded sequence %u",
+	"Sync individual %u",
+	"Sync all",
+	"Sync lost, output immediate",
+	"%u: Input DMX sent",
+	"%u: Input DMX local merge",
+	"%u: Input DMX updates per second is 0",
+	"%u: Input DMX timeout 1 second",
+	"%u: Input DMX sent (timeout)",
+};
+
+static_assert((sizeof(s_pFormat) / sizeof(s_pFormat[0])) == static_cast<uint32_t>(Event::UNDEFINED));
+
+static constexpr uint32_t COUNTERS = EVENTS * PORTS;
+
+/**
+ * Called from the timer, at most PACKETS_PER_SECOND.
+ * One line per event and port, with the number of events and the arguments of the latest one.
+ * The counters which do not fit in this packet are sent first in the next one.
+ */
+void ArtNetNode::DiagFlush() {
+	auto& counters = m_DiagCounters;
+
+	if (counters.nPending == 0) {
+		return;
+	}
+
+	if (!m_State.SendArtDiagData) {
+		memset(&counters, 0, sizeof(counters));
+		return;
+	}
+
+	auto *pText = reinterpret_cast<char *>(m_DiagData.Data);
+	auto *const pLast = pText + sizeof(m_DiagData.Data) - 1;	// Room for the '\0'
+	uint32_t nLines = 0;
+	uint8_t nPriority = 0;
+	auto nIndex = counters.nNext;
+
+	for (uint32_t i = 0; (i < COUNTERS) && (nLines < LINES_MAX) && (pText < pLast); i++) {
+		const auto nEvent = nIndex / PORTS;
+		const auto nPortIndex = nIndex % PORTS;
+		auto& counter = counters.counter[nEvent][nPortIndex];
+
+		nIndex = (nIndex + 1 == COUNTERS) ? 0 : nIndex + 1;
+
+		if (counter.nCount == 0) {
+			continue;
+		}
+
+		const auto nPort = (nPortIndex < artnetnode::MAX_PORTS) ? nPortIndex : PORT_NONE;
+
+		pText = std::min(pText + snprintf(pText, static_cast<size_t>(pLast - pText + 1), s_pFormat[nEvent], static_cast<unsigned int>(nPort), static_cast<unsigned int>(counter.nArg1), static_cast<unsigned int>(counter.nArg2)), pLast);
+
+		if (counter.nCount > 1) {
+			pText = std::min(pText + snprintf(pText, static_cast<size_t>(pLast - pText + 1), " (%u)", static_cast<unsigned int>(counter.nCount)), pLast);
+		}
+
+		if (pText < pLast) {
+			*pText++ = '\n';
+		}
+
+		nPriority = std::max(nPriority, counter.nPriority);
+		counter.nCount = 0;
+		counters.nPending--;
+		nLines++;
+	}
+
+	counters.nNext = nIndex;
+
+	*pText = '\0';
+
+	const auto nLength = static_cast<uint32_t>(pText - reinterpret_cast<char *>(m_DiagData.Data)) + 1;	// Text length including the '\0'
+
+	m_DiagData.Priority = nPriority;
+	m_DiagData.LengthHi = static_cast<uint8_t>(nLength >> 8);
+	m_DiagData.LengthLo = static_cast<uint8_t>(nLength);
+
+	const auto nSize = sizeof(struct artnet::ArtDiagData) - sizeof(m_DiagData.Data) + nLength;
+
+	Network::Get()->SendTo(m_nHandle, &m_DiagData, static_cast<uint16_t>(nSize), m_State.ArtDiagIpAddress, artnet::UDP_PORT);
+}
+#endif
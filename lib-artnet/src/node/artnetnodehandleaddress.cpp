@@ -2,7 +2,7 @@
  * @file artnetnodehandleaddress.cpp
  *
  */
-/* Copyright (C) 2021-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -61,17 +61,9 @@ void ArtNetNode::SetLocalMerging() {
 					artnet::get_protocol_mode(m_Node.Port[nOutputPortIndex].protocol),
 					m_Node.Port[nOutputPortIndex].PortAddress);
 
+			// The input is merged as source IPADDR_LOOPBACK with Physical the input port
 			if ((m_Node.Port[nInputPortIndex].protocol == m_Node.Port[nOutputPortIndex].protocol) &&
 					(m_Node.Port[nInputPortIndex].PortAddress == m_Node.Port[nOutputPortIndex].PortAddress)) {
-
-				if (!m_Node.Port[nOutputPortIndex].bLocalMerge) {
-					m_OutputPort[nOutputPortIndex].SourceA.nIp = net::IPADDR_LOOPBACK;
-					DEBUG_PUTS("Local merge Source A");
-				} else {
-					m_OutputPort[nOutputPortIndex].SourceB.nIp = net::IPADDR_LOOPBACK;
-					DEBUG_PUTS("Local merge Source B");
-				}
-
 				m_Node.Port[nInputPortIndex].bLocalMerge = true;
 				m_Node.Port[nOutputPortIndex].bLocalMerge = true;
 			}
@@ -85,6 +77,28 @@ void ArtNetNode::SetLocalMerging() {
 	DEBUG_EXIT
 }
 
+void ArtNetNode::UpdatePortAddressHash() {
+	for (auto& nEntry : m_PortAddressHash) {
+		nEntry = artnetnode::PORT_NONE;
+	}
+
+	// Inserted in reverse, so a chain is in port order
+	for (auto nPortIndex = artnetnode::MAX_PORTS; nPortIndex-- > 0;) {
+		m_PortAddressNext[nPortIndex] = artnetnode::PORT_NONE;
+
+		if (m_Node.Port[nPortIndex].direction == lightset::PortDir::DISABLE) {
+			continue;
+		}
+
+		const auto nBucket = artnetnode::port_address_hash(m_Node.Port[nPortIndex].PortAddress);
+
+		m_PortAddressNext[nPortIndex] = m_PortAddressHash[nBucket];
+		m_PortAddressHash[nBucket] = static_cast<uint8_t>(nPortIndex);
+	}
+
+	PollReplyInvalidate();
+}
+
 void ArtNetNode::SetUniverse(const uint32_t nPortIndex, const lightset::PortDir dir, const uint16_t nUniverse) {
 	assert(nPortIndex < artnetnode::MAX_PORTS);
 
@@ -153,6 +167,8 @@ void ArtNetNode::SetUniverseSwitch(const uint32_t nPortIndex, const lightset::Po
 		m_Node.Port[nPortIndex].direction = lightset::PortDir::OUTPUT;
 	}
 
+	UpdatePortAddressHash();
+
 #if (ARTNET_VERSION >= 4)
 	SetUniverse4(nPortIndex, dir);
 #endif
@@ -176,6 +192,8 @@ void ArtNetNode::SetSubnetSwitch(const uint32_t nPortIndex, const uint8_t nSubne
 	m_Node.Port[nPortIndex].SubSwitch = nSubnetSwitch;
 	m_Node.Port[nPortIndex].PortAddress = MakePortAddress(m_Node.Port[nPortIndex].PortAddress, nPortIndex);
 
+	UpdatePortAddressHash();
+
 	if (m_State.status == artnet::Status::ON) {
 		ArtNetStore::SaveSubnetSwitch(nPortIndex, nSubnetSwitch);
 	}
@@ -190,6 +208,8 @@ void ArtNetNode::SetNetSwitch(const uint32_t nPortIndex, const uint8_t nNetSwitc
 	m_Node.Port[nPortIndex].NetSwitch = nNetSwitch;
 	m_Node.Port[nPortIndex].PortAddress = MakePortAddress(m_Node.Port[nPortIndex].PortAddress, nPortIndex);
 
+	UpdatePortAddressHash();
+
 	if (m_State.status == artnet::Status::ON) {
 		ArtNetStore::SaveNetSwitch(nPortIndex, nNetSwitch);
 	}
@@ -255,6 +275,7 @@ void ArtNetNode::SetFailSafe(const artnetnode::FailSafe failsafe) {
 #endif
 
 	m_ArtPollReply.Status3 &= static_cast<uint8_t>(~artnet::Status3::NETWORKLOSS_MASK);
+	PollReplyInvalidate();
 
 	switch (failsafe) {
 	case artnetnode::FailSafe::LAST:
@@ -387,8 +408,7 @@ void ArtNetNode::HandleAddress() {
 	case artnet::PortCommand::CANCEL:
 		m_State.IsMergeMode = false;
 		for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
-			m_OutputPort[nPortIndex].SourceA.nIp = 0;
-			m_OutputPort[nPortIndex].SourceB.nIp = 0;
+			SourceClear(nPortIndex);
 			m_OutputPort[nPortIndex].GoodOutput &= static_cast<uint8_t>(~artnet::GoodOutput::OUTPUT_IS_MERGING);
 		}
 		break;
@@ -396,6 +416,7 @@ void ArtNetNode::HandleAddress() {
 	case artnet::PortCommand::LED_NORMAL:
 		Hardware::Get()->SetModeWithLock(hardware::ledblink::Mode::NORMAL, false);
 		m_ArtPollReply.Status1 = static_cast<uint8_t>((m_ArtPollReply.Status1 & ~artnet::Status1::INDICATOR_MASK) | artnet::Status1::INDICATOR_NORMAL_MODE);
+		PollReplyInvalidate();
 #if (ARTNET_VERSION >= 4)
 		E131Bridge::SetEnableDataIndicator(true);
 #endif
@@ -404,6 +425,7 @@ void ArtNetNode::HandleAddress() {
 	case artnet::PortCommand::LED_MUTE:
 		Hardware::Get()->SetModeWithLock(hardware::ledblink::Mode::OFF_OFF, true);
 		m_ArtPollReply.Status1 = static_cast<uint8_t>((m_ArtPollReply.Status1 & ~artnet::Status1::INDICATOR_MASK) | artnet::Status1::INDICATOR_MUTE_MODE);
+		PollReplyInvalidate();
 #if (ARTNET_VERSION >= 4)
 		E131Bridge::SetEnableDataIndicator(false);
 #endif
@@ -412,6 +434,7 @@ void ArtNetNode::HandleAddress() {
 	case artnet::PortCommand::LED_LOCATE:
 		Hardware::Get()->SetModeWithLock(hardware::ledblink::Mode::FAST, true);
 		m_ArtPollReply.Status1 = static_cast<uint8_t>((m_ArtPollReply.Status1 & ~artnet::Status1::INDICATOR_MASK) | artnet::Status1::INDICATOR_LOCATE_MODE);
+		PollReplyInvalidate();
 #if (ARTNET_VERSION >= 4)
 		E131Bridge::SetEnableDataIndicator(false);
 #endif
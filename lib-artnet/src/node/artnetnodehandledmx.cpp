@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2021-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -53,18 +53,99 @@ void ArtNetNode::UpdateMergeStatus(const uint32_t nPortIndex) {
 	m_OutputPort[nPortIndex].GoodOutput |= artnet::GoodOutput::OUTPUT_IS_MERGING;
 }
 
-void ArtNetNode::CheckMergeTimeouts(const uint32_t nPortIndex) {
-	const auto nTimeOutAMillis = m_nCurrentPacketMillis - m_OutputPort[nPortIndex].SourceA.nMillis;
+uint32_t ArtNetNode::SourceLookup(const uint32_t nPortIndex, const uint32_t nIp, const uint8_t nPhysical) const {
+	const auto& outputPort = m_OutputPort[nPortIndex];
 
-	if (nTimeOutAMillis > (artnet::MERGE_TIMEOUT_SECONDS * 1000U)) {
-		m_OutputPort[nPortIndex].SourceA.nIp = 0;
-		m_OutputPort[nPortIndex].GoodOutput &= static_cast<uint8_t>(~artnet::GoodOutput::OUTPUT_IS_MERGING);
+	for (auto nIndex = outputPort.sourceHash[artnetnode::source_hash(nIp, nPhysical)]; nIndex != artnetnode::SOURCE_NONE; nIndex = outputPort.source[nIndex].nHashNext) {
+		if ((outputPort.source[nIndex].nIp == nIp) && (outputPort.source[nIndex].nPhysical == nPhysical)) {
+			return nIndex;
+		}
+	}
+
+	return artnetnode::SOURCE_NONE;
+}
+
+uint32_t ArtNetNode::SourceAdd(const uint32_t nPortIndex, const uint32_t nIp, const uint8_t nPhysical) {
+	auto& outputPort = m_OutputPort[nPortIndex];
+	const auto nFree = ~outputPort.nSourcesMask & ((1U << artnetnode::MAX_SOURCES) - 1);
+
+	if (nFree == 0) {
+		return artnetnode::SOURCE_NONE;
 	}
 
-	const auto nTimeOutBMillis = m_nCurrentPacketMillis - m_OutputPort[nPortIndex].SourceB.nMillis;
+	const auto nIndex = static_cast<uint32_t>(__builtin_ctz(nFree));
+	auto& source = outputPort.source[nIndex];
+	const auto nBucket = artnetnode::source_hash(nIp, nPhysical);
+
+	source.nIp = nIp;
+	source.nPhysical = nPhysical;
+	source.nMillis = m_nCurrentPacketMillis;
+	source.nSequence = 0;
+	source.nContiguous = 0;
+	source.nHashNext = outputPort.sourceHash[nBucket];
+
+	outputPort.sourceHash[nBucket] = static_cast<uint8_t>(nIndex);
+	outputPort.nSourcesMask |= (1U << nIndex);
+
+	return nIndex;
+}
+
+void ArtNetNode::SourceRemove(const uint32_t nPortIndex, const uint32_t nSourceIndex) {
+	auto& outputPort = m_OutputPort[nPortIndex];
+	auto& source = outputPort.source[nSourceIndex];
+	auto *pLink = &outputPort.sourceHash[artnetnode::source_hash(source.nIp, source.nPhysical)];
+
+	while (*pLink != artnetnode::SOURCE_NONE) {
+		if (*pLink == nSourceIndex) {
+			*pLink = source.nHashNext;
+			break;
+		}
+		pLink = &outputPort.source[*pLink].nHashNext;
+	}
+
+	source.nIp = 0;
+	outputPort.nSourcesMask &= ~(1U << nSourceIndex);
+
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+	if (outputPort.reorderWindow.nSourceIndex == nSourceIndex) {
+		outputPort.reorderWindow.IsHeld = false;
+	}
+#endif
+}
+
+void ArtNetNode::SourceClear(const uint32_t nPortIndex) {
+	auto& outputPort = m_OutputPort[nPortIndex];
+
+	for (auto& nEntry : outputPort.sourceHash) {
+		nEntry = artnetnode::SOURCE_NONE;
+	}
+
+	for (auto& source : outputPort.source) {
+		source.nIp = 0;
+	}
+
+	outputPort.nSourcesMask = 0;
+
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+	outputPort.reorderWindow.IsHeld = false;
+#endif
+}
+
+void ArtNetNode::CheckMergeTimeouts(const uint32_t nPortIndex) {
+	auto nSourcesMask = m_OutputPort[nPortIndex].nSourcesMask;
+
+	while (nSourcesMask != 0) {
+		const auto nSourceIndex = static_cast<uint32_t>(__builtin_ctz(nSourcesMask));
+		nSourcesMask &= nSourcesMask - 1;
+
+		const auto nTimeOutMillis = m_nCurrentPacketMillis - m_OutputPort[nPortIndex].source[nSourceIndex].nMillis;
+
+		if (nTimeOutMillis > (artnet::MERGE_TIMEOUT_SECONDS * 1000U)) {
+			SourceRemove(nPortIndex, nSourceIndex);
+		}
+	}
 
-	if (nTimeOutBMillis > (artnet::MERGE_TIMEOUT_SECONDS * 1000U)) {
-		m_OutputPort[nPortIndex].SourceB.nIp = 0;
+	if (__builtin_popcount(m_OutputPort[nPortIndex].nSourcesMask) <= 1) {
 		m_OutputPort[nPortIndex].GoodOutput &= static_cast<uint8_t>(~artnet::GoodOutput::OUTPUT_IS_MERGING);
 	}
 
@@ -77,18 +158,172 @@ void ArtNetNode::CheckMergeTimeouts(const uint32_t nPortIndex) {
 	if (!bIsMerging) {
 		m_State.IsChanged = true;
 		m_State.IsMergeMode = false;
-		SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Leaving Merging Mode", nPortIndex);
+		SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::LEAVING_MERGE, nPortIndex);
+	}
+}
+
+static int32_t sequence_delta(const uint8_t nSequence, const uint8_t nLatest) {
+	auto nDelta = static_cast<int32_t>(nSequence) - static_cast<int32_t>(nLatest);
+
+	if (nDelta > 127) {
+		nDelta -= 255;
+	} else if (nDelta < -127) {
+		nDelta += 255;
 	}
+
+	return nDelta;
 }
 
+void ArtNetNode::DmxOutput(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t *pData, const uint32_t nLength) {
+	const auto nSourcesMask = m_OutputPort[nPortIndex].nSourcesMask;
+
+	if (__builtin_expect(((nSourcesMask & (nSourcesMask - 1)) == 0), 1)) {
+		lightset::Data::SetSource(nPortIndex, nSourceIndex, pData, nLength);
+		SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::SINGLE_SOURCE, nPortIndex, nSourceIndex);
+	} else {
+		const auto mergeMode = ((m_OutputPort[nPortIndex].GoodOutput & artnet::GoodOutput::MERGE_MODE_LTP) == artnet::GoodOutput::MERGE_MODE_LTP) ? lightset::MergeMode::LTP : lightset::MergeMode::HTP;
+		UpdateMergeStatus(nPortIndex);
+		lightset::Data::MergeSource(nPortIndex, nSourceIndex, pData, nLength, mergeMode, nSourcesMask);
+		SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::MERGE_SOURCE, nPortIndex, nSourceIndex);
+	}
+
+	if ((m_State.IsSynchronousMode) && ((m_OutputPort[nPortIndex].GoodOutput & artnet::GoodOutput::OUTPUT_IS_MERGING) != artnet::GoodOutput::OUTPUT_IS_MERGING)) {
+		lightset::data_set(m_pLightSet, nPortIndex);
+		m_OutputPort[nPortIndex].IsDataPending = true;
+		SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::BUFFERING_DATA, nPortIndex);
+	} else {
+		lightset::data_output(m_pLightSet, nPortIndex);
+
+		if (!m_OutputPort[nPortIndex].IsTransmitting) {
+			m_pLightSet->Start(nPortIndex);
+			m_State.IsChanged = true;
+			m_OutputPort[nPortIndex].IsTransmitting = true;
+		}
+
+		SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::SEND_DATA, nPortIndex);
+	}
+}
+
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+/**
+ * Hold the packet after a gap, the timer outputs it when the window expires.
+ */
+void ArtNetNode::ReorderHold(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t nSequence, const uint8_t *pData, const uint32_t nLength) {
+	auto& reorderWindow = m_OutputPort[nPortIndex].reorderWindow;
+
+	reorderWindow.nMillis = m_nCurrentPacketMillis;
+	reorderWindow.nLength = nLength;
+	reorderWindow.nSourceIndex = static_cast<uint8_t>(nSourceIndex);
+	reorderWindow.nSequence = nSequence;
+	reorderWindow.IsHeld = true;
+	memcpy(reorderWindow.data, pData, nLength);
+
+	m_IsReorderIdle = false;
+
+	if (m_ReorderTimerId == TIMER_ID_NONE) {
+		m_ReorderTimerId = SoftwareTimerAdd(1, StaticCallbackFunctionReorderExpire);
+	}
+}
+
+/**
+ * Output the held packet, the missing sequence numbers are lost.
+ */
+void ArtNetNode::ReorderFlush(const uint32_t nPortIndex) {
+	auto& outputPort = m_OutputPort[nPortIndex];
+	auto& reorderWindow = outputPort.reorderWindow;
+	auto& source = outputPort.source[reorderWindow.nSourceIndex];
+
+	outputPort.sequenceCounters.nLost += static_cast<uint32_t>(sequence_delta(reorderWindow.nSequence, source.nSequence) - 1);
+	source.nSequence = reorderWindow.nSequence;
+	reorderWindow.IsHeld = false;
+
+	DmxOutput(nPortIndex, reorderWindow.nSourceIndex, reorderWindow.data, reorderWindow.nLength);
+}
+
+/**
+ * The held packet of a sender which has restarted is not output.
+ */
+void ArtNetNode::ReorderDrop(const uint32_t nPortIndex, const uint32_t nSourceIndex) {
+	auto& outputPort = m_OutputPort[nPortIndex];
+
+	if (outputPort.reorderWindow.IsHeld && (outputPort.reorderWindow.nSourceIndex == nSourceIndex)) {
+		outputPort.sequenceCounters.nDiscarded++;
+		outputPort.reorderWindow.IsHeld = false;
+	}
+}
+
+/**
+ * Output the held packet when it is next in sequence, drop it when it is behind.
+ */
+void ArtNetNode::ReorderRelease(const uint32_t nPortIndex, const uint32_t nSourceIndex) {
+	auto& outputPort = m_OutputPort[nPortIndex];
+	auto& reorderWindow = outputPort.reorderWindow;
+
+	if (!reorderWindow.IsHeld || (reorderWindow.nSourceIndex != nSourceIndex)) {
+		return;
+	}
+
+	auto& source = outputPort.source[nSourceIndex];
+	const auto nDelta = sequence_delta(reorderWindow.nSequence, source.nSequence);
+
+	if (nDelta == 1) {
+		outputPort.sequenceCounters.nReordered++;
+		source.nSequence = reorderWindow.nSequence;
+		reorderWindow.IsHeld = false;
+		DmxOutput(nPortIndex, nSourceIndex, reorderWindow.data, reorderWindow.nLength);
+	} else if (nDelta <= 0) {
+		outputPort.sequenceCounters.nDiscarded++;
+		reorderWindow.IsHeld = false;
+	}
+}
+
+/**
+ * Called from the software timer while a packet is held, also when no packets are received.
+ * The timer must not be deleted from its own callback, Process() deletes it when idle.
+ */
+void ArtNetNode::ReorderExpire() {
+	const auto nMillis = Hardware::Get()->Millis();
+	auto isHeld = false;
+
+	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
+		const auto& reorderWindow = m_OutputPort[nPortIndex].reorderWindow;
+
+		if (reorderWindow.IsHeld) {
+			if ((nMillis - reorderWindow.nMillis) >= artnetnode::REORDER_WINDOW_MILLIS) {
+				ReorderFlush(nPortIndex);
+			} else {
+				isHeld = true;
+			}
+		}
+	}
+
+	m_IsReorderIdle = !isHeld;
+}
+#endif
+
+/*
+ * A source is an IP address and Physical. Up to artnetnode::MAX_SOURCES sources are merged,
+ * a source is released after artnet::MERGE_TIMEOUT_SECONDS without data.
+ * The output of a source only moves forward in sequence.
+ */
 void ArtNetNode::HandleDmx() {
 	const auto *const pArtDmx = reinterpret_cast<artnet::ArtDmx *>(m_pReceiveBuffer);
 	const auto nDmxSlots = std::min(static_cast<uint32_t>(((pArtDmx->LengthHi << 8) & 0xff00) | pArtDmx->Length), artnet::DMX_LENGTH);
+	const auto nPortAddress = pArtDmx->PortAddress;
 
-	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	/*
+	 * The ArtDmx packets after an ArtSync are for the next frame,
+	 * the scheduled frame is output before it is overwritten.
+	 */
+	if (m_SyncSchedule.IsArmed) {
+		SyncDeadline(Hardware::Get()->Micros());
+	}
+#endif
+
+	for (auto nPortIndex = PortAddressFirst(nPortAddress); nPortIndex != artnetnode::PORT_NONE; nPortIndex = PortAddressNext(nPortIndex, nPortAddress)) {
 		if ((m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT)
-		 && (m_Node.Port[nPortIndex].protocol == artnet::PortProtocol::ARTNET)
-		 && (m_Node.Port[nPortIndex].PortAddress == pArtDmx->PortAddress)) {
+		 && (m_Node.Port[nPortIndex].protocol == artnet::PortProtocol::ARTNET)) {
 
 			m_OutputPort[nPortIndex].GoodOutput |= artnet::GoodOutput::DATA_IS_BEING_TRANSMITTED;
 
@@ -98,132 +333,74 @@ void ArtNetNode::HandleDmx() {
 				}
 			}
 
-			const auto ipA = m_OutputPort[nPortIndex].SourceA.nIp;
-			const auto ipB = m_OutputPort[nPortIndex].SourceB.nIp;
-			const auto mergeMode = ((m_OutputPort[nPortIndex].GoodOutput & artnet::GoodOutput::MERGE_MODE_LTP) == artnet::GoodOutput::MERGE_MODE_LTP) ? lightset::MergeMode::LTP : lightset::MergeMode::HTP;
-
-			if (__builtin_expect((ipA == 0 && ipB == 0), 0)) {							// Case 1.
-				m_OutputPort[nPortIndex].SourceA.nIp = m_nIpAddressFrom;
-				m_OutputPort[nPortIndex].SourceA.nMillis = m_nCurrentPacketMillis;
-				m_OutputPort[nPortIndex].SourceA.nPhysical = pArtDmx->Physical;
-				lightset::Data::SetSourceA(nPortIndex, pArtDmx->Data, nDmxSlots);
-				SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 1. First packet", nPortIndex, pArtDmx->Physical);
-			} else if (ipA == m_nIpAddressFrom && ipB == 0) {							// Case 2.
-				if (m_OutputPort[nPortIndex].SourceA.nPhysical == pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceA.nMillis = m_nCurrentPacketMillis;
-					lightset::Data::SetSourceA(nPortIndex, pArtDmx->Data, nDmxSlots);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 2. continued transmission from the same ip (source A)", nPortIndex, pArtDmx->Physical);
-				} else if (m_OutputPort[nPortIndex].SourceB.nPhysical != pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceB.nIp = m_nIpAddressFrom;
-					m_OutputPort[nPortIndex].SourceB.nMillis = m_nCurrentPacketMillis;
-					m_OutputPort[nPortIndex].SourceB.nPhysical = pArtDmx->Physical;
-					UpdateMergeStatus(nPortIndex);
-					lightset::Data::MergeSourceB(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 2. New source from same ip (source B), start the merge", nPortIndex, pArtDmx->Physical);
-				} else {
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 2. More than two sources, discarding data", nPortIndex, pArtDmx->Physical);
-					return;
-				}
-			} else if (ipA == 0 && ipB == m_nIpAddressFrom) {							// Case 3.
-				if (m_OutputPort[nPortIndex].SourceB.nPhysical == pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceB.nMillis = m_nCurrentPacketMillis;
-					lightset::Data::SetSourceB(nPortIndex, pArtDmx->Data, nDmxSlots);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 3. continued transmission from the same ip (source B)", nPortIndex, pArtDmx->Physical);
-				} else if (m_OutputPort[nPortIndex].SourceA.nPhysical != pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceA.nIp = m_nIpAddressFrom;
-					m_OutputPort[nPortIndex].SourceA.nMillis = m_nCurrentPacketMillis;
-					m_OutputPort[nPortIndex].SourceA.nPhysical = pArtDmx->Physical;
-					UpdateMergeStatus(nPortIndex);
-					lightset::Data::MergeSourceA(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 3. New source from same ip (source A), start the merge", nPortIndex, pArtDmx->Physical);
-				} else {
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 3. More than two sources, discarding data", nPortIndex, pArtDmx->Physical);
-					return;
-				}
-			} else if (ipA != m_nIpAddressFrom && ipB == 0) {							// Case 4.
-				m_OutputPort[nPortIndex].SourceB.nIp = m_nIpAddressFrom;
-				m_OutputPort[nPortIndex].SourceB.nMillis = m_nCurrentPacketMillis;
-				m_OutputPort[nPortIndex].SourceB.nPhysical = pArtDmx->Physical;
-				UpdateMergeStatus(nPortIndex);
-				lightset::Data::MergeSourceB(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-				SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 4. new source, start the merge", nPortIndex, pArtDmx->Physical);
-			} else if (ipA == 0 && ipB != m_nIpAddressFrom) {							// Case 5.
-				m_OutputPort[nPortIndex].SourceA.nIp = m_nIpAddressFrom;
-				m_OutputPort[nPortIndex].SourceA.nMillis = m_nCurrentPacketMillis;
-				m_OutputPort[nPortIndex].SourceA.nPhysical = pArtDmx->Physical;
-				UpdateMergeStatus(nPortIndex);
-				lightset::Data::MergeSourceA(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-				SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 5. new source, start the merge", nPortIndex, pArtDmx->Physical);
-			} else if (ipA == m_nIpAddressFrom && ipB != m_nIpAddressFrom) {			// Case 6.
-				if (m_OutputPort[nPortIndex].SourceA.nPhysical == pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceA.nMillis = m_nCurrentPacketMillis;
-					UpdateMergeStatus(nPortIndex);
-					lightset::Data::MergeSourceA(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 6. continue merge (Source A)", nPortIndex, pArtDmx->Physical);
-				} else {
-					SendDiag(artnet::PriorityCodes::DIAG_MED, "%u:%u 6. More than two sources, discarding data", nPortIndex, pArtDmx->Physical);
-					return;
-				}
-			} else if (ipA != m_nIpAddressFrom && ipB == m_nIpAddressFrom) {			// Case 7.
-				if (m_OutputPort[nPortIndex].SourceB.nPhysical == pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceB.nMillis = m_nCurrentPacketMillis;
-					UpdateMergeStatus(nPortIndex);
-					lightset::Data::MergeSourceB(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 7. continue merge (Source B)", nPortIndex, pArtDmx->Physical);
-				} else {
-					SendDiag(artnet::PriorityCodes::DIAG_MED, "%u:%u 7. More than two sources, discarding data", nPortIndex, pArtDmx->Physical);
-					puts("WARN: 7. More than two sources, discarding data");
-					return;
-				}
-			} else if (ipA == m_nIpAddressFrom && ipB == m_nIpAddressFrom) {			// Case 8.
-				if (m_OutputPort[nPortIndex].SourceA.nPhysical == pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceA.nMillis = m_nCurrentPacketMillis;
-					UpdateMergeStatus(nPortIndex);
-					lightset::Data::MergeSourceA(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 8. Source matches both ip, merging Physical (SourceA)", nPortIndex, pArtDmx->Physical);
-				} else if (m_OutputPort[nPortIndex].SourceB.nPhysical == pArtDmx->Physical) {
-					m_OutputPort[nPortIndex].SourceB.nMillis = m_nCurrentPacketMillis;
-					UpdateMergeStatus(nPortIndex);
-					lightset::Data::MergeSourceB(nPortIndex, pArtDmx->Data, nDmxSlots, mergeMode);
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 8. Source matches both ip, merging Physical (SourceB)", nPortIndex, pArtDmx->Physical);
-				} else {
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u 8. Source matches both ip, more than two sources, discarding data", nPortIndex, pArtDmx->Physical);
-					puts("WARN: 8. Source matches both ip, discarding data");
-					return;
+			auto nSourceIndex = SourceLookup(nPortIndex, m_nIpAddressFrom, pArtDmx->Physical);
+
+			if (__builtin_expect((nSourceIndex == artnetnode::SOURCE_NONE), 0)) {
+				nSourceIndex = SourceAdd(nPortIndex, m_nIpAddressFrom, pArtDmx->Physical);
+
+				if (nSourceIndex == artnetnode::SOURCE_NONE) {
+					SendDiag(artnet::PriorityCodes::DIAG_MED, artnetnode::diag::Event::MORE_SOURCES, nPortIndex, pArtDmx->Physical, artnetnode::MAX_SOURCES);
+					continue;
 				}
-			}
-#ifndef NDEBUG
-			else if (ipA != m_nIpAddressFrom && ipB != m_nIpAddressFrom) {				// Case 9.
-				SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: 9. More than two sources, discarding data", nPortIndex);
-				puts("WARN: 9. More than two sources, discarding data");
-				return;
-			}
-#endif
-			else {																		// Case 0.
-				SendDiag(artnet::PriorityCodes::DIAG_HIGH, "%u: 0. No cases matched, this shouldn't happen!", nPortIndex);
-#ifndef NDEBUG
-				puts("ERROR: 0. No cases matched, this shouldn't happen!");
-#endif
-				return;
+
+				SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::NEW_SOURCE, nPortIndex, pArtDmx->Physical, nSourceIndex);
 			}
 
-			if ((m_State.IsSynchronousMode) && ((m_OutputPort[nPortIndex].GoodOutput & artnet::GoodOutput::OUTPUT_IS_MERGING) != artnet::GoodOutput::OUTPUT_IS_MERGING)) {
-				lightset::data_set(m_pLightSet, nPortIndex);
-				m_OutputPort[nPortIndex].IsDataPending = true;
-				SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Buffering data", nPortIndex);
-			} else {
-				lightset::data_output(m_pLightSet, nPortIndex);
+			auto& outputPort = m_OutputPort[nPortIndex];
+			auto& source = outputPort.source[nSourceIndex];
+			const auto nSequence = pArtDmx->Sequence;
+
+			source.nMillis = m_nCurrentPacketMillis;
+			m_State.nReceivingDmx |= (1U << static_cast<uint8_t>(lightset::PortDir::OUTPUT));
 
-				if (!m_OutputPort[nPortIndex].IsTransmitting) {
-					m_pLightSet->Start(nPortIndex);
-					m_State.IsChanged = true;
-					m_OutputPort[nPortIndex].IsTransmitting = true;
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+			auto& reorderWindow = outputPort.reorderWindow;
+#endif
+
+			if (nSequence == 0) {
+				// Sequence disabled, or the sender has restarted
+				source.nContiguous = 0;
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+				ReorderDrop(nPortIndex, nSourceIndex);
+#endif
+			} else if (source.nSequence != 0) {
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+				if (reorderWindow.IsHeld && (reorderWindow.nSourceIndex == nSourceIndex) && (sequence_delta(nSequence, reorderWindow.nSequence) > 0)) {
+					ReorderFlush(nPortIndex);
 				}
+#endif
+				const auto nDelta = sequence_delta(nSequence, source.nSequence);
 
-				SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Send data", nPortIndex);
+				if (source.nContiguous < artnetnode::SEQUENCE_CONTIGUOUS) {
+					source.nContiguous = (nDelta == 1) ? static_cast<uint8_t>(source.nContiguous + 1) : 0;
+				} else if ((nDelta <= 0) && (nDelta > -artnetnode::SEQUENCE_DISCARD_RANGE)) {
+					outputPort.sequenceCounters.nDiscarded++;
+					SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::DISCARDED_SEQUENCE, nPortIndex, nSequence);
+					continue;
+				} else if ((nDelta > 1) && (nDelta < artnetnode::SEQUENCE_DISCARD_RANGE)) {
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+					if (!reorderWindow.IsHeld) {
+						ReorderHold(nPortIndex, nSourceIndex, nSequence, pArtDmx->Data, nDmxSlots);
+						continue;
+					}
+#endif
+					outputPort.sequenceCounters.nLost += static_cast<uint32_t>(nDelta - 1);
+				} else if (nDelta != 1) {
+					// Far out of sequence, the sender has restarted
+					source.nContiguous = 0;
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+					ReorderDrop(nPortIndex, nSourceIndex);
+#endif
+				}
 			}
 
-			m_State.nReceivingDmx |= (1U << static_cast<uint8_t>(lightset::PortDir::OUTPUT));
+			source.nSequence = nSequence;
+
+			DmxOutput(nPortIndex, nSourceIndex, pArtDmx->Data, nDmxSlots);
+
+#if defined (CONFIG_ARTNET_DMX_REORDER)
+			ReorderRelease(nPortIndex, nSourceIndex);
+#endif
 		}
 	}
 }
@@ -2,7 +2,7 @@
  * @file artnetnodehandleipprog.cpp
  *
  */
-/* Copyright (C) 2021-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -110,6 +110,8 @@ void ArtNetNode::HandleIpProg() {
 #if (ARTNET_VERSION >= 4)
 		memcpy(m_ArtPollReply.BindIp, &pArtIpProgReply->ProgIpHi, artnet::IP_SIZE);
 #endif
+		PollReplyInvalidate();
+
 		if (m_State.SendArtPollReplyOnChange) {
 			SendPollReply(0, m_nIpAddressFrom);
 		}
@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2021-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -105,6 +105,8 @@ static const char *get_report_code_string(const ReportCode code) {
  * xxxx is a hex status code as defined in Table 3.
  * yyyy is a decimal counter that increments every time the Node sends an ArtPollResponse.
  */
+static constexpr uint32_t NODE_REPORT_COUNTER_OFFSET = 7;
+
 static void create_node_report(uint8_t *pNodeReport, const ReportCode code, const uint32_t nCounter) {
 	[[maybe_unused]] const auto *pBegin = pNodeReport;
 
@@ -113,6 +115,7 @@ static void create_node_report(uint8_t *pNodeReport, const ReportCode code, cons
 	pNodeReport += 4;
 	*pNodeReport++ = ' ';
 	*pNodeReport++ = '[';
+	assert((pNodeReport - pBegin) == NODE_REPORT_COUNTER_OFFSET);
 	uitoa<4>(nCounter, pNodeReport);
 	pNodeReport += 4;
 	*pNodeReport++ = ']';
@@ -130,7 +133,10 @@ union uip {
 	uint8_t u8[4];
 } static ip;
 
-void ArtNetNode::ProcessPollReply(const uint32_t nPortIndex, [[maybe_unused]] uint32_t& NumPortsInput, uint32_t& NumPortsOutput) {
+/*
+ * The port status, which changes at runtime, is updated for each ArtPollReply sent.
+ */
+void ArtNetNode::ProcessPollReply(const uint32_t nPortIndex, ArtPollReply& artPollReply) {
 	if (m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT) {
 #if (ARTNET_VERSION >= 4)
 		if (m_Node.Port[nPortIndex].protocol == PortProtocol::SACN) {
@@ -141,50 +147,80 @@ void ArtNetNode::ProcessPollReply(const uint32_t nPortIndex, [[maybe_unused]] ui
 			m_OutputPort[nPortIndex].GoodOutput = GoodOutput;
 		}
 #endif
-		m_ArtPollReply.PortTypes[0] |= PortType::OUTPUT_ARTNET;
-		m_ArtPollReply.GoodOutput[0] = m_OutputPort[nPortIndex].GoodOutput;
-		m_ArtPollReply.GoodOutputB[0] = m_OutputPort[nPortIndex].GoodOutputB;
-		m_ArtPollReply.GoodInput[0] = 0;
-		m_ArtPollReply.SwOut[0] = m_Node.Port[nPortIndex].DefaultAddress;
-		m_ArtPollReply.SwIn[0] = 0;
-		NumPortsOutput++;
+		artPollReply.PortTypes[0] = PortType::OUTPUT_ARTNET;
+		artPollReply.GoodOutput[0] = m_OutputPort[nPortIndex].GoodOutput;
+		artPollReply.GoodOutputB[0] = m_OutputPort[nPortIndex].GoodOutputB;
+		artPollReply.GoodInput[0] = 0;
+		artPollReply.SwOut[0] = m_Node.Port[nPortIndex].DefaultAddress;
+		artPollReply.SwIn[0] = 0;
+		artPollReply.NumPortsLo = 1;
 		return;
 	}
 
 #if defined (ARTNET_HAVE_DMXIN)
 	if (m_Node.Port[nPortIndex].direction == lightset::PortDir::INPUT) {
-#if (ARTNET_VERSION >= 4)
-		if (m_Node.Port[nPortIndex].protocol == PortProtocol::SACN) {
-
-		}
-#endif
-		m_ArtPollReply.PortTypes[0] |= PortType::INPUT_ARTNET;
-		m_ArtPollReply.GoodOutput[0] = 0;
-		m_ArtPollReply.GoodOutputB[0] = 0;
-		m_ArtPollReply.GoodInput[0] = m_InputPort[nPortIndex].GoodInput;
-		m_ArtPollReply.SwOut[0] = 0;
-		m_ArtPollReply.SwIn[0] = m_Node.Port[nPortIndex].DefaultAddress;
-		NumPortsInput++;
+		artPollReply.PortTypes[0] = PortType::INPUT_ARTNET;
+		artPollReply.GoodOutput[0] = 0;
+		artPollReply.GoodOutputB[0] = 0;
+		artPollReply.GoodInput[0] = m_InputPort[nPortIndex].GoodInput;
+		artPollReply.SwOut[0] = 0;
+		artPollReply.SwIn[0] = m_Node.Port[nPortIndex].DefaultAddress;
+		artPollReply.NumPortsLo = 1;
 		return;
 	}
 #endif
 
-	m_ArtPollReply.PortTypes[0] = 0;
-	m_ArtPollReply.GoodOutput[0] = 0;
-	m_ArtPollReply.GoodOutputB[0] = 0;
-	m_ArtPollReply.GoodInput[0] = 0;
-	m_ArtPollReply.SwOut[0] = 0;
-	m_ArtPollReply.SwIn[0] = 0;
+	artPollReply.PortTypes[0] = 0;
+	artPollReply.GoodOutput[0] = 0;
+	artPollReply.GoodOutputB[0] = 0;
+	artPollReply.GoodInput[0] = 0;
+	artPollReply.SwOut[0] = 0;
+	artPollReply.SwIn[0] = 0;
+	artPollReply.NumPortsLo = 0;
+}
+
+/*
+ * The page is build from m_ArtPollReply, which holds the fields common to all pages.
+ */
+void ArtNetNode::PollReplyBuild(const uint32_t nPortIndex) {
+	auto& artPollReply = m_ArtPollReplyPage[nPortIndex];
+
+	memcpy(&artPollReply, &m_ArtPollReply, sizeof(ArtPollReply));
+
+	artPollReply.NetSwitch = m_Node.Port[nPortIndex].NetSwitch;
+	artPollReply.SubSwitch = m_Node.Port[nPortIndex].SubSwitch;
+	artPollReply.BindIndex = static_cast<uint8_t>(nPortIndex + 1);
+
+	memcpy(artPollReply.ShortName, m_Node.Port[nPortIndex].ShortName, SHORT_NAME_LENGTH);
+
+	if (__builtin_expect((m_pLightSet != nullptr), 1)) {
+		const auto nRefreshRate = m_pLightSet->GetRefreshRate();
+		artPollReply.RefreshRateLo = static_cast<uint8_t>(nRefreshRate);
+		artPollReply.RefreshRateHi = static_cast<uint8_t>(nRefreshRate >> 8);
+		const auto nUserData = m_pLightSet->GetUserData();
+		artPollReply.UserLo = static_cast<uint8_t>(nUserData);
+		artPollReply.UserHi = static_cast<uint8_t>(nUserData >> 8);
+	}
+
+	create_node_report(artPollReply.NodeReport, m_State.reportCode, 0);
+
+	m_nPollReplyPageGeneration[nPortIndex] = m_nPollReplyGeneration;
 }
 
 void ArtNetNode::SendPollReply(const uint32_t nBindIndex, const uint32_t nDestinationIp, ArtPollQueue *pQueue) {
 	DEBUG_PRINTF("nBindIndex=%u", nBindIndex);
 
 	ip.u32 = Network::Get()->GetIp();
-	memcpy(m_ArtPollReply.IPAddress, ip.u8, sizeof(m_ArtPollReply.IPAddress));
+
+	if ((ip.u32 != m_nPollReplyIp) || (m_State.reportCode != m_PollReplyReportCode)) {
+		m_nPollReplyIp = ip.u32;
+		m_PollReplyReportCode = m_State.reportCode;
+		memcpy(m_ArtPollReply.IPAddress, ip.u8, sizeof(m_ArtPollReply.IPAddress));
 #if (ARTNET_VERSION >= 4)
-	memcpy(m_ArtPollReply.BindIp, ip.u8, sizeof(m_ArtPollReply.BindIp));
+		memcpy(m_ArtPollReply.BindIp, ip.u8, sizeof(m_ArtPollReply.BindIp));
 #endif
+		PollReplyInvalidate();
+	}
 
 	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
 		if ((nBindIndex != 0) && (nBindIndex != (nPortIndex + 1))) {
@@ -203,31 +239,18 @@ void ArtNetNode::SendPollReply(const uint32_t nBindIndex, const uint32_t nDestin
 			}
 		}
 
-		m_ArtPollReply.NetSwitch = m_Node.Port[nPortIndex].NetSwitch;
-		m_ArtPollReply.SubSwitch = m_Node.Port[nPortIndex].SubSwitch;
-		m_ArtPollReply.BindIndex = static_cast<uint8_t>(nPortIndex + 1);
-
-		memcpy(m_ArtPollReply.ShortName, m_Node.Port[nPortIndex].ShortName, SHORT_NAME_LENGTH);
-
-		if (__builtin_expect((m_pLightSet != nullptr), 1)) {
-			const auto nRefreshRate = m_pLightSet->GetRefreshRate();
-			m_ArtPollReply.RefreshRateLo = static_cast<uint8_t>(nRefreshRate);
-			m_ArtPollReply.RefreshRateHi = static_cast<uint8_t>(nRefreshRate >> 8);
-			const auto nUserData = m_pLightSet->GetUserData();
-			m_ArtPollReply.UserLo = static_cast<uint8_t>(nUserData);
-			m_ArtPollReply.UserHi = static_cast<uint8_t>(nUserData >> 8);
+		if (m_nPollReplyPageGeneration[nPortIndex] != m_nPollReplyGeneration) {
+			PollReplyBuild(nPortIndex);
 		}
 
-		m_State.ArtPollReplyCount++;
-		create_node_report(m_ArtPollReply.NodeReport, m_State.reportCode, m_State.ArtPollReplyCount);
+		auto& artPollReply = m_ArtPollReplyPage[nPortIndex];
 
-		uint32_t nPortsOutput = 0;
-		uint32_t nPortsInput = 0;
-		ProcessPollReply(nPortIndex, nPortsInput, nPortsOutput);
+		ProcessPollReply(nPortIndex, artPollReply);
 
-		m_ArtPollReply.NumPortsLo = static_cast<uint8_t>(std::max(nPortsInput, nPortsOutput));
+		m_State.ArtPollReplyCount++;
+		uitoa<4>(m_State.ArtPollReplyCount, &artPollReply.NodeReport[NODE_REPORT_COUNTER_OFFSET]);
 
-		Network::Get()->SendTo(m_nHandle, &m_ArtPollReply, sizeof(ArtPollReply), nDestinationIp, UDP_PORT);
+		Network::Get()->SendTo(m_nHandle, &artPollReply, sizeof(ArtPollReply), nDestinationIp, UDP_PORT);
 	}
 
 	m_State.IsChanged = false;
@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2021-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,33 +27,82 @@
  */
 
 #include <cstdint>
+#include <algorithm>
 
 #include "artnetnode.h"
 #include "artnet.h"
 
 #include "lightsetdata.h"
 
+#include "hardware.h"
+#include "softwaretimers.h"
+
 /**
  * When a node receives an ArtSync packet it should transfer to synchronous operation.
  * This means that received ArtDmx packets will be buffered
  * and output when the next ArtSync is received.
  */
 void ArtNetNode::HandleSync() {
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	const auto nMicros = Hardware::Get()->Micros();
+
+	if (m_SyncSchedule.IsArmed) {
+		SyncDeadline(nMicros);
+	}
+
+	SyncMeasure(nMicros);
+#endif
+
 	if (!m_State.IsSynchronousMode) {
 		m_State.IsSynchronousMode = true;
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+		m_SyncSchedule.nDeadlineMicros = nMicros + m_SyncSchedule.nLatencyMicros;
+#endif
 		return;
 	}
 
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	m_SyncStatistics.nSyncs++;
+
+	auto& schedule = m_SyncSchedule;
+
+	if (schedule.mode != artnetnode::sync::Mode::IMMEDIATE) {
+		auto nDeadlineMicros = nMicros + schedule.nLatencyMicros;
+
+		if (schedule.mode == artnetnode::sync::Mode::FRAME) {
+			/*
+			 * Stay on the frame grid when the ArtSync is in time for the next grid point,
+			 * else the grid starts again from this ArtSync.
+			 */
+			const auto nPeriodMicros = m_SyncStatistics.nPeriodMicros;
+			const auto nNextMicros = schedule.nDeadlineMicros + nPeriodMicros;
+			const auto nAheadMicros = static_cast<int32_t>(nNextMicros - nMicros);
+
+			if ((nPeriodMicros != 0) && (nAheadMicros >= 0) && (static_cast<uint32_t>(nAheadMicros) <= nPeriodMicros)) {
+				nDeadlineMicros = nNextMicros;
+			}
+		}
+
+		schedule.nDeadlineMicros = nDeadlineMicros;
+		schedule.IsArmed = true;
+		return;
+	}
+#endif
+
+	SyncOutput();
+}
+
+void ArtNetNode::SyncOutput() {
 	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
 		if (m_OutputPort[nPortIndex].IsDataPending) {
 			m_pLightSet->Sync(nPortIndex);
-			SendDiag(artnet::PriorityCodes::DIAG_LOW, "Sync individual %u", nPortIndex);
+			SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::SYNC_INDIVIDUAL, nPortIndex);
 		}
 	}
 
 	m_pLightSet->Sync();
 
-	SendDiag(artnet::PriorityCodes::DIAG_LOW, "Sync all");
+	SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::SYNC_ALL);
 
 	for (auto &outputPort : m_OutputPort) {
 		if (outputPort.IsDataPending) {
@@ -65,3 +114,105 @@ void ArtNetNode::HandleSync() {
 		}
 	}
 }
+
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+/**
+ * The ArtSync period is smoothed with 1/8 of the new interval.
+ */
+void ArtNetNode::SyncMeasure(const uint32_t nMicros) {
+	auto& statistics = m_SyncStatistics;
+	const auto nIntervalMicros = nMicros - m_SyncSchedule.nArrivalMicros;
+
+	m_SyncSchedule.nArrivalMicros = nMicros;
+
+	if (!m_State.IsSynchronousMode || (nIntervalMicros >= artnetnode::sync::WATCHDOG_MAX_MICROS)) {
+		return;
+	}
+
+	if (statistics.nPeriodMicros == 0) {
+		statistics.nPeriodMicros = nIntervalMicros;
+		return;
+	}
+
+	const auto nDeltaMicros = static_cast<int32_t>(nIntervalMicros - statistics.nPeriodMicros);
+
+	statistics.nJitterMicros = static_cast<uint32_t>(nDeltaMicros >= 0 ? nDeltaMicros : -nDeltaMicros);
+
+	if (statistics.nJitterMicros > statistics.nJitterMaxMicros) {
+		statistics.nJitterMaxMicros = statistics.nJitterMicros;
+	}
+
+	statistics.nPeriodMicros = static_cast<uint32_t>(static_cast<int32_t>(statistics.nPeriodMicros) + (nDeltaMicros / 8));
+}
+
+/**
+ * Output the scheduled frame. When nMicros is before the deadline,
+ * the next frame has arrived and the scheduled frame cannot wait any longer.
+ */
+void ArtNetNode::SyncDeadline(const uint32_t nMicros) {
+	auto& statistics = m_SyncStatistics;
+	const auto nLateMicros = static_cast<int32_t>(nMicros - m_SyncSchedule.nDeadlineMicros);
+
+	m_SyncSchedule.IsArmed = false;
+
+	if (nLateMicros < 0) {
+		statistics.nForced++;
+		statistics.nLateMicros = 0;
+	} else {
+		statistics.nLateMicros = static_cast<uint32_t>(nLateMicros);
+
+		if (statistics.nLateMicros > statistics.nLateMaxMicros) {
+			statistics.nLateMaxMicros = statistics.nLateMicros;
+		}
+	}
+
+	SyncOutput();
+}
+
+/**
+ * Called from Process for each loop, with or without a packet received.
+ */
+void ArtNetNode::SyncProcess() {
+	if (!m_State.IsSynchronousMode) {
+		m_SyncSchedule.IsArmed = false;
+
+		if (m_SyncTimerId != TIMER_ID_NONE) {
+			SoftwareTimerDelete(m_SyncTimerId);
+		}
+		return;
+	}
+
+	/*
+	 * The timer guarantees that the deadline is checked when there is no packet received.
+	 */
+	if (m_SyncTimerId == TIMER_ID_NONE) {
+		m_SyncTimerId = SoftwareTimerAdd(1, StaticCallbackFunctionSyncDeadline);
+	}
+
+	const auto nMicros = Hardware::Get()->Micros();
+
+	if (m_SyncSchedule.IsArmed) {
+		if (static_cast<int32_t>(nMicros - m_SyncSchedule.nDeadlineMicros) >= 0) {
+			SyncDeadline(nMicros);
+		}
+		return;
+	}
+
+	auto nWatchdogMicros = artnetnode::sync::WATCHDOG_MAX_MICROS;
+	const auto nPeriodMicros = m_SyncStatistics.nPeriodMicros;
+
+	if (nPeriodMicros != 0) {
+		nWatchdogMicros = std::max(artnetnode::sync::WATCHDOG_MIN_MICROS, std::min(nWatchdogMicros, artnetnode::sync::WATCHDOG_PERIODS * nPeriodMicros));
+	}
+
+	if ((nMicros - m_SyncSchedule.nArrivalMicros) >= nWatchdogMicros) {
+		m_State.IsSynchronousMode = false;
+		m_SyncStatistics.nPeriodMicros = 0;
+		m_SyncStatistics.nFallbacks++;
+
+		SyncOutput();
+
+		SendDiag(artnet::PriorityCodes::DIAG_MED, artnetnode::diag::Event::SYNC_FALLBACK);
+	}
+}
+#endif
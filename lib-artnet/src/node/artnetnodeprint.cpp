@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2018-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2018-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -91,6 +91,14 @@ void ArtNetNode::Print() {
 	}
 #endif
 
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	printf(" ArtSync    : %s", artnetnode::sync::get_mode(m_SyncSchedule.mode));
+	if (m_SyncSchedule.mode == artnetnode::sync::Mode::LATENCY) {
+		printf(" %u us", static_cast<unsigned int>(m_SyncSchedule.nLatencyMicros));
+	}
+	puts("");
+#endif
+
 #if (ARTNET_VERSION >= 4)
 	if (ArtNetNode::GetActiveOutputPorts() != 0) {
 		if (IsMapUniverse0()) {
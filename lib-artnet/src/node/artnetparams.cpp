@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2016-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2016-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -327,6 +327,37 @@ void ArtNetParams::callbackFunction(const char *pLine) {
 		return;
 	}
 
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	nLength = 9;
+
+	if (Sscan::Char(pLine, ArtNetParamsConst::SYNC_MODE, aValue, nLength) == Sscan::OK) {
+		aValue[nLength] = '\0';
+		const auto mode = artnetnode::sync::get_mode(aValue);
+
+		if (mode == artnetnode::sync::Mode::IMMEDIATE) {
+			m_Params.nSetList &= ~Mask::SYNC_MODE;
+		} else {
+			m_Params.nSetList |= Mask::SYNC_MODE;
+		}
+
+		m_Params.nSyncMode = static_cast<uint8_t>(mode);
+		return;
+	}
+
+	uint16_t nValue16;
+
+	if (Sscan::Uint16(pLine, ArtNetParamsConst::SYNC_LATENCY_US, nValue16) == Sscan::OK) {
+		if ((nValue16 != 0) && (nValue16 != artnetnode::sync::LATENCY_MICROS)) {
+			m_Params.nSyncLatencyMicros = nValue16;
+			m_Params.nSetList |= Mask::SYNC_LATENCY;
+		} else {
+			m_Params.nSyncLatencyMicros = artnetnode::sync::LATENCY_MICROS;
+			m_Params.nSetList &= ~Mask::SYNC_LATENCY;
+		}
+		return;
+	}
+#endif
+
 	/**
 	 * Extra's
 	 */
@@ -420,6 +451,15 @@ void ArtNetParams::Builder(const struct Params *pParams, char *pBuffer, uint32_t
 	}
 	builder.Add(ArtNetParamsConst::MAP_UNIVERSE0, isMaskSet(Mask::MAP_UNIVERSE0));
 
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	builder.AddComment("ArtSync");
+	builder.Add(ArtNetParamsConst::SYNC_MODE, artnetnode::sync::get_mode(static_cast<artnetnode::sync::Mode>(m_Params.nSyncMode)), isMaskSet(Mask::SYNC_MODE));
+	if (!isMaskSet(Mask::SYNC_LATENCY)) {
+		m_Params.nSyncLatencyMicros = artnetnode::sync::LATENCY_MICROS;
+	}
+	builder.Add(ArtNetParamsConst::SYNC_LATENCY_US, m_Params.nSyncLatencyMicros, isMaskSet(Mask::SYNC_LATENCY));
+#endif
+
 	builder.AddComment("#");
 
 	builder.Add(LightSetParamsConst::DISABLE_MERGE_TIMEOUT, isMaskSet(Mask::DISABLE_MERGE_TIMEOUT));
@@ -497,6 +537,13 @@ void ArtNetParams::Set() {
 	}
 #endif
 
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	if (isMaskSet(Mask::SYNC_MODE)) {
+		const auto nLatencyMicros = isMaskSet(Mask::SYNC_LATENCY) ? m_Params.nSyncLatencyMicros : artnetnode::sync::LATENCY_MICROS;
+		p->SetSyncMode(static_cast<artnetnode::sync::Mode>(m_Params.nSyncMode), nLatencyMicros);
+	}
+#endif
+
 	/**
 	 * Extra's
 	 */
@@ -565,6 +612,15 @@ void ArtNetParams::Dump() {
 		printf(" %s=%u\n", LightSetParamsConst::PRIORITY[i], m_Params.nPriority[i]);
 	}
 
+	/**
+	 * ArtSync
+	 */
+
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	printf(" %s=%u [%s]\n", ArtNetParamsConst::SYNC_MODE, m_Params.nSyncMode, artnetnode::sync::get_mode(static_cast<artnetnode::sync::Mode>(m_Params.nSyncMode)));
+	printf(" %s=%u\n", ArtNetParamsConst::SYNC_LATENCY_US, m_Params.nSyncLatencyMicros);
+#endif
+
 	/**
 	 * Extra's
 	 */
@@ -2,7 +2,7 @@
  * @file handledmxin.cpp
  *
  */
-/* Copyright (C) 2019-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2019-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -76,14 +76,14 @@ void ArtNetNode::HandleDmxIn() {
 
 				Network::Get()->SendTo(m_nHandle, &m_ArtDmx, sizeof(struct artnet::ArtDmx), m_InputPort[nPortIndex].nDestinationIp, artnet::UDP_PORT);
 
-				SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Input DMX sent", nPortIndex);
+				SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::INPUT_SENT, nPortIndex);
 
 				if (m_Node.Port[nPortIndex].bLocalMerge) {
 					m_pReceiveBuffer = reinterpret_cast<uint8_t *>(&m_ArtDmx);
 					m_nIpAddressFrom = net::IPADDR_LOOPBACK;
 					HandleDmx();
 
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Input DMX local merge", nPortIndex);
+					SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::INPUT_LOCAL_MERGE, nPortIndex);
 				}
 
 				if ((s_ReceivingMask & (1U << nPortIndex)) != (1U << nPortIndex)) {
@@ -110,14 +110,14 @@ void ArtNetNode::HandleDmxIn() {
 						m_State.nReceivingDmx &= static_cast<uint8_t>(~(1U << static_cast<uint8_t>(lightset::PortDir::INPUT)));
 					}
 
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Input DMX updates per second is 0", nPortIndex);
+					SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::INPUT_RATE_ZERO, nPortIndex);
 				} else if (m_InputPort[nPortIndex].nMillis != 0) {
 					const auto nMillis = Hardware::Get()->Millis();
 					if ((nMillis - m_InputPort[nPortIndex].nMillis) > 1000) {
 						m_InputPort[nPortIndex].nMillis = nMillis;
 						sendArtDmx = true;
 
-						SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Input DMX timeout 1 second", nPortIndex);
+						SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::INPUT_TIMEOUT, nPortIndex);
 					}
 				}
 
@@ -142,14 +142,14 @@ void ArtNetNode::HandleDmxIn() {
 
 					Network::Get()->SendTo(m_nHandle, &m_ArtDmx, sizeof(struct artnet::ArtDmx), m_InputPort[nPortIndex].nDestinationIp, artnet::UDP_PORT);
 
-					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Input DMX sent (timeout)", nPortIndex);
+					SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::INPUT_SENT_TIMEOUT, nPortIndex);
 
 					if (m_Node.Port[nPortIndex].bLocalMerge) {
 						m_pReceiveBuffer = reinterpret_cast<uint8_t *>(&m_ArtDmx);
 						m_nIpAddressFrom = net::IPADDR_LOOPBACK;
 						HandleDmx();
 
-						SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Input DMX local merge", nPortIndex);
+						SendDiag(artnet::PriorityCodes::DIAG_LOW, artnetnode::diag::Event::INPUT_LOCAL_MERGE, nPortIndex);
 					}
 				}
 			}
@@ -0,0 +1,101 @@
+/**
+ * @file json_get_status.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+
+#include "artnetnode.h"
+#include "artnet.h"
+
+namespace remoteconfig::artnet {
+static uint32_t get_port(const uint32_t nPortIndex, const uint16_t nUniverse, char *pOutBuffer, const uint32_t nOutBufferSize) {
+	const auto& counters = ArtNetNode::Get()->GetSequenceCounters(nPortIndex);
+	const auto nLength = static_cast<uint32_t>(snprintf(pOutBuffer, nOutBufferSize,
+			"{\"port\":%u,\"universe\":%u,\"sequence\":{\"discarded\":%u,\"reordered\":%u,\"lost\":%u}},",
+			static_cast<unsigned int>(nPortIndex),
+			static_cast<unsigned int>(nUniverse),
+			static_cast<unsigned int>(counters.nDiscarded),
+			static_cast<unsigned int>(counters.nReordered),
+			static_cast<unsigned int>(counters.nLost)));
+
+	if (nLength < nOutBufferSize) {
+		return nLength;
+	}
+
+	return 0;
+}
+
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+static uint32_t get_sync(char *pOutBuffer, const uint32_t nOutBufferSize) {
+	const auto *pArtNetNode = ArtNetNode::Get();
+	const auto& statistics = pArtNetNode->GetSyncStatistics();
+	const auto nLength = static_cast<uint32_t>(snprintf(pOutBuffer, nOutBufferSize,
+			",\"sync\":{\"mode\":\"%s\",\"syncs\":%u,\"forced\":%u,\"fallbacks\":%u,\"period_us\":%u,\"jitter_us\":%u,\"jitter_max_us\":%u,\"late_us\":%u,\"late_max_us\":%u}",
+			artnetnode::sync::get_mode(pArtNetNode->GetSyncMode()),
+			static_cast<unsigned int>(statistics.nSyncs),
+			static_cast<unsigned int>(statistics.nForced),
+			static_cast<unsigned int>(statistics.nFallbacks),
+			static_cast<unsigned int>(statistics.nPeriodMicros),
+			static_cast<unsigned int>(statistics.nJitterMicros),
+			static_cast<unsigned int>(statistics.nJitterMaxMicros),
+			static_cast<unsigned int>(statistics.nLateMicros),
+			static_cast<unsigned int>(statistics.nLateMaxMicros)));
+
+	if (nLength < nOutBufferSize) {
+		return nLength;
+	}
+
+	return 0;
+}
+#endif
+
+uint32_t json_get_status(char *pOutBuffer, const uint32_t nOutBufferSize) {
+	const auto nBufferSize = nOutBufferSize - 2U;
+	auto nLength = static_cast<uint32_t>(snprintf(pOutBuffer, nBufferSize, "{\"output\":["));
+
+	for (uint32_t nPortIndex = 0; (nPortIndex < artnetnode::MAX_PORTS) && (nLength < nBufferSize); nPortIndex++) {
+		uint16_t nUniverse;
+		if (ArtNetNode::Get()->GetPortAddress(nPortIndex, nUniverse, lightset::PortDir::OUTPUT)) {
+			nLength += get_port(nPortIndex, nUniverse, &pOutBuffer[nLength], nBufferSize - nLength);
+		}
+	}
+
+	if (pOutBuffer[nLength - 1] == ',') {
+		nLength--;
+	}
+
+	pOutBuffer[nLength++] = ']';
+
+#if defined (CONFIG_ARTNET_SYNC_DEADLINE)
+	if (nLength < nBufferSize) {
+		nLength += get_sync(&pOutBuffer[nLength], nBufferSize - nLength);
+	}
+#endif
+
+	pOutBuffer[nLength++] = '}';
+
+	return nLength;
+}
+}  // namespace remoteconfig::artnet
@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2017-2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -53,11 +53,7 @@ void ArtNetNode::HandleTodControl() {
 
 	const auto portAddress = static_cast<uint16_t>((pArtTodControl->Net << 8)) | static_cast<uint16_t>((pArtTodControl->Address));
 
-	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
-		if (portAddress != m_Node.Port[nPortIndex].PortAddress) {
-			continue;
-		}
-
+	for (auto nPortIndex = PortAddressFirst(portAddress); nPortIndex != artnetnode::PORT_NONE; nPortIndex = PortAddressNext(nPortIndex, portAddress)) {
 		if ((m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT) &&
 				((m_OutputPort[nPortIndex].GoodOutputB & artnet::GoodOutputB::RDM_DISABLED) != artnet::GoodOutputB::RDM_DISABLED)) {
 			switch (pArtTodControl->Command) {
@@ -100,12 +96,8 @@ void ArtNetNode::HandleTodData() {
 
 	const auto portAddress = static_cast<uint16_t>((pArtTodData->Net << 8)) | static_cast<uint16_t>((pArtTodData->Address));
 
-	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
-		if (m_Node.Port[nPortIndex].direction != lightset::PortDir::INPUT) {
-			continue;
-		}
-
-		if (m_Node.Port[nPortIndex].PortAddress == portAddress) {
+	for (auto nPortIndex = PortAddressFirst(portAddress); nPortIndex != artnetnode::PORT_NONE; nPortIndex = PortAddressNext(nPortIndex, portAddress)) {
+		if (m_Node.Port[nPortIndex].direction == lightset::PortDir::INPUT) {
 			DEBUG_PRINTF("nPortIndex=%u, portAddress=%u, pArtTodData->UidCount=%u",nPortIndex, portAddress, pArtTodData->UidCount);
 
 			for (uint32_t nUidIndex = 0; nUidIndex < pArtTodData->UidCount; nUidIndex++) {
@@ -209,11 +201,7 @@ void ArtNetNode::HandleRdm() {
 
 	const auto portAddress = static_cast<uint16_t>((pArtRdm->Net << 8)) | static_cast<uint16_t>((pArtRdm->Address));
 
-	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
-		if (m_Node.Port[nPortIndex].PortAddress != portAddress) {
-			continue;
-		}
-
+	for (auto nPortIndex = PortAddressFirst(portAddress); nPortIndex != artnetnode::PORT_NONE; nPortIndex = PortAddressNext(nPortIndex, portAddress)) {
 		if ((m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT) &&
 		   ((m_OutputPort[nPortIndex].GoodOutputB & artnet::GoodOutputB::RDM_DISABLED) != artnet::GoodOutputB::RDM_DISABLED)) {
 # if (ARTNET_VERSION >= 4)
@@ -2,7 +2,7 @@
  * @file handlerdm.cpp
  *
  */
-/* Copyright (C) 2023 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2023-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -43,12 +43,12 @@ void ArtNetNode::HandleTodRequest() {
 	for (auto nCount = 0; nCount < nAddCount; nCount++) {
 		const auto portAddress = static_cast<uint16_t>((pArtTodRequest->Net << 8)) | static_cast<uint16_t>((pArtTodRequest->Address[nCount]));
 
-		for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
+		for (auto nPortIndex = PortAddressFirst(portAddress); nPortIndex != artnetnode::PORT_NONE; nPortIndex = PortAddressNext(nPortIndex, portAddress)) {
 			if ((m_OutputPort[nPortIndex].GoodOutputB & artnet::GoodOutputB::RDM_DISABLED) == artnet::GoodOutputB::RDM_DISABLED) {
 				continue;
 			}
 
-			if ((portAddress == m_Node.Port[nPortIndex].PortAddress) && (m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT)) {
+			if (m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT) {
 				SendTod(nPortIndex);
 			}
 		}
@@ -5,7 +5,7 @@
 /**
  * Art-Net Designed by and Copyright Artistic Licence Holdings Ltd.
  */
-/* Copyright (C) 2017-2023 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -45,12 +45,12 @@ void ArtNetNode::HandleRdm() {
 
 	const auto portAddress = static_cast<uint16_t>((pArtRdm->Net << 8)) | static_cast<uint16_t>((pArtRdm->Address));
 
-	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
+	for (auto nPortIndex = PortAddressFirst(portAddress); nPortIndex != artnetnode::PORT_NONE; nPortIndex = PortAddressNext(nPortIndex, portAddress)) {
 		if ((m_OutputPort[nPortIndex].GoodOutputB & artnet::GoodOutputB::RDM_DISABLED) == artnet::GoodOutputB::RDM_DISABLED) {
 			continue;
 		}
 
-		if ((portAddress == m_Node.Port[nPortIndex].PortAddress) && (m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT)) {
+		if (m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT) {
 			const auto *pRdmResponse = const_cast<uint8_t*>(m_pArtNetRdmResponder->Handler(nPortIndex, pArtRdm->RdmPacket));
 
 			if (pRdmResponse != nullptr) {
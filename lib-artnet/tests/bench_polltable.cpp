@@ -0,0 +1,268 @@
+/**
+ * @file bench_polltable.cpp
+ *
+ * ArtNetPollTable of a large installation: 1000 nodes with 4 output ports
+ * each, 4000 universes. The ArtPollReply processing of a poll cycle, and the
+ * universe lookup done by ArtNetController::HandleDmxOut() for every frame.
+ * The expiry by Clean(): when nothing expires, when the nodes expire spread
+ * over the poll interval, and when all nodes expire at once.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+
+#include "artnetpolltable.h"
+#include "artnet.h"
+
+#include "hardware.h"
+
+static constexpr uint32_t NODES = 1000;
+static constexpr uint32_t PORTS = 4;
+static constexpr uint32_t UNIVERSES = NODES * PORTS;
+static constexpr uint32_t CYCLES = 100;
+static constexpr uint32_t FRAMES = 1000;
+static constexpr uint32_t CLEANS = 100000;
+static constexpr uint32_t RUNS = 7;	///< The fastest run is reported
+
+static_assert(NODES <= artnet::POLL_TABLE_SIZE_ENRIES);
+static_assert(UNIVERSES <= artnet::POLL_TABLE_SIZE_UNIVERSES);
+
+static artnet::ArtPollReply s_Replies[NODES];
+static uint16_t s_PortAddress[UNIVERSES];
+
+static uint64_t nanos_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000U + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * Node n is 10.0.x.y and outputs the 4 universes from Port-Address 4 * n
+ */
+static void replies_set() {
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		auto& reply = s_Replies[nNode];
+		memset(&reply, 0, sizeof(struct artnet::ArtPollReply));
+
+		const auto nIpAddress = 0x0A000000U | (nNode + 1);
+		reply.IPAddress[0] = static_cast<uint8_t>(nIpAddress >> 24);
+		reply.IPAddress[1] = static_cast<uint8_t>(nIpAddress >> 16);
+		reply.IPAddress[2] = static_cast<uint8_t>(nIpAddress >> 8);
+		reply.IPAddress[3] = static_cast<uint8_t>(nIpAddress);
+		reply.NetSwitch = static_cast<uint8_t>(nNode >> 6);
+		reply.SubSwitch = static_cast<uint8_t>((nNode >> 2) & 0x0F);
+		reply.BindIndex = 1;
+
+		for (uint32_t nPort = 0; nPort < PORTS; nPort++) {
+			reply.PortTypes[nPort] = static_cast<uint8_t>(artnet::PortType::OUTPUT_ARTNET);
+			reply.SwOut[nPort] = static_cast<uint8_t>(((nNode & 0x3) << 2) | nPort);
+			s_PortAddress[nNode * PORTS + nPort] = artnet::make_port_address(reply.NetSwitch, reply.SubSwitch, reply.SwOut[nPort]);
+		}
+	}
+}
+
+static void poll_cycle(ArtNetPollTable& pollTable) {
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		pollTable.Add(&s_Replies[nNode]);
+	}
+}
+
+/**
+ * Node n replies n * 8 ms into the poll interval.
+ * Clean() is called every millisecond, as from the controller loop, until all nodes have expired.
+ */
+static void clean_staggered(uint64_t& nWorst, uint64_t& nTotal, uint32_t& nCalls) {
+	Hardware::SetMillis(5000);
+
+	auto *pPollTable = new ArtNetPollTable;
+
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		Hardware::SetMillis(5000 + (nNode * artnet::POLL_INTERVAL_MILLIS) / NODES);
+		pPollTable->Add(&s_Replies[nNode]);
+	}
+
+	nWorst = 0;
+	nTotal = 0;
+	nCalls = 0;
+
+	while (pPollTable->GetPollTableEntries() != 0) {
+		Hardware::AddMillis(1);
+
+		const auto nStart = nanos_now();
+		pPollTable->Clean();
+		const auto nElapsed = nanos_now() - nStart;
+
+		nWorst = std::max(nWorst, nElapsed);
+		nTotal += nElapsed;
+		nCalls++;
+	}
+
+	delete pPollTable;
+}
+
+/**
+ * All nodes replied in the same second, one Clean() expires them all
+ */
+static uint64_t clean_all() {
+	Hardware::SetMillis(5000);
+
+	auto *pPollTable = new ArtNetPollTable;
+	poll_cycle(*pPollTable);
+
+	Hardware::AddMillis(artnet::POLL_TABLE_TIMEOUT_MILLIS + artnet::POLL_TABLE_WHEEL_SLOT_MILLIS);
+
+	const auto nStart = nanos_now();
+	pPollTable->Clean();
+	const auto nElapsed = nanos_now() - nStart;
+
+	if (pPollTable->GetPollTableEntries() != 0) {
+		fprintf(stderr, "%u nodes not expired\n", pPollTable->GetPollTableEntries());
+		exit(EXIT_FAILURE);
+	}
+
+	delete pPollTable;
+
+	return nElapsed;
+}
+
+int main() {
+	replies_set();
+	Hardware::SetMillis(5000);
+
+	/*
+	 * The first poll cycle, the tables grow from their initial size
+	 */
+
+	auto nBestFirst = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		auto *pPollTable = new ArtNetPollTable;
+
+		const auto nStart = nanos_now();
+		poll_cycle(*pPollTable);
+		nBestFirst = std::min(nBestFirst, nanos_now() - nStart);
+
+		delete pPollTable;
+	}
+
+	ArtNetPollTable pollTable;
+	poll_cycle(pollTable);
+
+	if ((pollTable.GetPollTableEntries() != NODES) || (pollTable.GetPollTableOverflow() != 0)) {
+		fprintf(stderr, "%u nodes, %u overflow\n", pollTable.GetPollTableEntries(), pollTable.GetPollTableOverflow());
+		return EXIT_FAILURE;
+	}
+
+	/*
+	 * The next poll cycles, all nodes and universes are known
+	 */
+
+	auto nBestRefresh = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+
+		for (uint32_t nCycle = 0; nCycle < CYCLES; nCycle++) {
+			poll_cycle(pollTable);
+		}
+
+		nBestRefresh = std::min(nBestRefresh, nanos_now() - nStart);
+	}
+
+	/*
+	 * The lookups of a frame, every universe has one subscriber
+	 */
+
+	auto nBestLookup = UINT64_MAX;
+	uint32_t nSubscribers = 0;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+
+		for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+			for (uint32_t nUniverse = 0; nUniverse < UNIVERSES; nUniverse++) {
+				const auto *pUniverse = pollTable.GetIpAddress(s_PortAddress[nUniverse]);
+				if (pUniverse != nullptr) {
+					nSubscribers += pUniverse->nCount;
+				}
+			}
+		}
+
+		nBestLookup = std::min(nBestLookup, nanos_now() - nStart);
+	}
+
+	if (nSubscribers != RUNS * FRAMES * UNIVERSES) {
+		fprintf(stderr, "%u subscribers, expected %u\n", nSubscribers, RUNS * FRAMES * UNIVERSES);
+		return EXIT_FAILURE;
+	}
+
+	/*
+	 * Clean() when no node expires, the controller loop calls it continuously
+	 */
+
+	auto nBestIdle = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+
+		for (uint32_t i = 0; i < CLEANS; i++) {
+			pollTable.Clean();
+		}
+
+		nBestIdle = std::min(nBestIdle, nanos_now() - nStart);
+	}
+
+	if (pollTable.GetPollTableEntries() != NODES) {
+		fprintf(stderr, "%u nodes expired\n", NODES - pollTable.GetPollTableEntries());
+		return EXIT_FAILURE;
+	}
+
+	auto nBestStaggeredWorst = UINT64_MAX;
+	auto nBestStaggeredTotal = UINT64_MAX;
+	uint32_t nStaggeredCalls = 0;
+	auto nBestAll = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		uint64_t nWorst, nTotal;
+		clean_staggered(nWorst, nTotal, nStaggeredCalls);
+		nBestStaggeredWorst = std::min(nBestStaggeredWorst, nWorst);
+		nBestStaggeredTotal = std::min(nBestStaggeredTotal, nTotal);
+		nBestAll = std::min(nBestAll, clean_all());
+	}
+
+	printf("ArtNetPollTable, %u nodes, %u universes, best of %u runs\n", NODES, UNIVERSES, RUNS);
+	printf("  First poll cycle  : %8.1f us (%.1f ns per ArtPollReply)\n", static_cast<double>(nBestFirst) / 1e3, static_cast<double>(nBestFirst) / NODES);
+	printf("  Poll cycle        : %8.1f us (%.1f ns per ArtPollReply)\n", static_cast<double>(nBestRefresh) / (1e3 * CYCLES), static_cast<double>(nBestRefresh) / (static_cast<double>(CYCLES) * NODES));
+	printf("  Lookup per frame  : %8.1f us (%.1f ns per universe)\n", static_cast<double>(nBestLookup) / (1e3 * FRAMES), static_cast<double>(nBestLookup) / (static_cast<double>(FRAMES) * UNIVERSES));
+
+	printf("  Clean, no expiry  : %8.1f ns per call\n", static_cast<double>(nBestIdle) / CLEANS);
+	printf("  Clean, staggered  : %8.1f us worst call, %.1f ns per call over %u calls\n", static_cast<double>(nBestStaggeredWorst) / 1e3, static_cast<double>(nBestStaggeredTotal) / nStaggeredCalls, nStaggeredCalls);
+	printf("  Clean, all at once: %8.1f us (%.1f ns per node)\n", static_cast<double>(nBestAll) / 1e3, static_cast<double>(nBestAll) / NODES);
+
+	return EXIT_SUCCESS;
+}
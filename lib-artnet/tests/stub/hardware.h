@@ -0,0 +1,67 @@
+/**
+ * @file hardware.h
+ *
+ * The clock of the tests, Millis() returns what the test has set.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef HARDWARE_H_
+#define HARDWARE_H_
+
+#include <cstdint>
+
+class Hardware {
+public:
+	static Hardware *Get() {
+		static Hardware instance;
+		return &instance;
+	}
+
+	uint32_t Millis() const {
+		return s_nMillis;
+	}
+
+	static void SetMillis(const uint32_t nMillis) {
+		s_nMillis = nMillis;
+	}
+
+	static void AddMillis(const uint32_t nMillis) {
+		s_nMillis += nMillis;
+	}
+
+	const char *GetBoardName(uint8_t& nLength) const {
+		nLength = sizeof("Linux") - 1;
+		return "Linux";
+	}
+
+	const char *GetWebsiteUrl() const {
+		return "www.gd32-dmx.org";
+	}
+
+private:
+	Hardware() {}
+
+	static inline uint32_t s_nMillis;
+};
+
+#endif /* HARDWARE_H_ */
@@ -0,0 +1,128 @@
+/**
+ * @file network.h
+ *
+ * The UDP packets sent are kept in a log for the tests, nothing is received.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef NETWORK_H_
+#define NETWORK_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "net/ip4_address.h"
+
+class Network {
+public:
+	static constexpr uint32_t IP_ADDRESS = 0x0100000A;	///< 10.0.0.1
+	static constexpr uint32_t BROADCAST_IP = 0xFFFFFFFF;
+	static constexpr uint32_t PACKET_SIZE = 576;
+	static constexpr uint32_t PACKETS_MAX = 64;
+
+	struct Packet {
+		uint32_t nToIp;
+		uint32_t nLength;
+		uint8_t Buffer[PACKET_SIZE];
+	};
+
+	static Network *Get() {
+		static Network instance;
+		return &instance;
+	}
+
+	int32_t Begin([[maybe_unused]] const uint16_t nPort) {
+		return 0;
+	}
+
+	void MacAddressCopyTo(uint8_t *pMacAddress) const {
+		memset(pMacAddress, 0, 6);
+	}
+
+	uint32_t GetIp() const {
+		return IP_ADDRESS;
+	}
+
+	uint32_t GetBroadcastIp() const {
+		return BROADCAST_IP;
+	}
+
+	bool IsDhcpCapable() const {
+		return false;
+	}
+
+	bool IsDhcpUsed() const {
+		return false;
+	}
+
+	uint32_t RecvFrom([[maybe_unused]] const int32_t nHandle, [[maybe_unused]] void *pBuffer, [[maybe_unused]] const uint32_t nLength, [[maybe_unused]] uint32_t *pFromIp, [[maybe_unused]] uint16_t *pFromPort) {
+		return 0;
+	}
+
+	void SendTo([[maybe_unused]] const int32_t nHandle, const void *pBuffer, const uint32_t nLength, const uint32_t nToIp, [[maybe_unused]] const uint16_t nRemotePort) {
+		if (m_nPackets < PACKETS_MAX) {
+			auto& packet = m_Packets[m_nPackets++];
+			packet.nToIp = nToIp;
+			packet.nLength = (nLength < PACKET_SIZE) ? nLength : PACKET_SIZE;
+			memcpy(packet.Buffer, pBuffer, packet.nLength);
+		} else {
+			m_nOverflow++;
+		}
+	}
+
+	void SendToQueue(const int32_t nHandle, const void *pBuffer, const uint32_t nLength, const uint32_t nToIp, const uint16_t nRemotePort) {
+		SendTo(nHandle, pBuffer, nLength, nToIp, nRemotePort);
+	}
+
+	void SendToQueueFlush() {}
+
+	/*
+	 * The log
+	 */
+
+	uint32_t GetPackets() const {
+		return m_nPackets;
+	}
+
+	const Packet& GetPacket(const uint32_t nIndex) const {
+		return m_Packets[nIndex];
+	}
+
+	uint32_t GetOverflow() const {
+		return m_nOverflow;
+	}
+
+	void Clear() {
+		m_nPackets = 0;
+		m_nOverflow = 0;
+	}
+
+private:
+	Network() {}
+
+	Packet m_Packets[PACKETS_MAX];
+	uint32_t m_nPackets { 0 };
+	uint32_t m_nOverflow { 0 };
+};
+
+#endif /* NETWORK_H_ */
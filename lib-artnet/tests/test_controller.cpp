@@ -0,0 +1,274 @@
+/**
+ * @file test_controller.cpp
+ *
+ * ArtNetController::HandleDmxOut() sending on change: which universes are
+ * sent, to which nodes, the sequence number per universe, the keep-alive
+ * refresh, the master, the blackout and the full active universes table.
+ * The ArtDmx packets are taken from the log of the network stub.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+#include "artnetcontroller.h"
+#include "artnet.h"
+
+#include "hardware.h"
+#include "network.h"
+
+static_assert(artnetcontroller::MAX_UNIVERSES == 4, "Build with -DCONFIG_ARTNET_CONTROLLER_MAX_UNIVERSES=4");
+
+static constexpr uint32_t NODE_A = 0x0101000A;	///< 10.0.1.1
+static constexpr uint32_t NODE_B = 0x0201000A;
+static constexpr uint32_t NODE_C = 0x0301000A;
+static constexpr uint32_t NODE_D = 0x0401000A;
+static constexpr uint32_t NODE_E = 0x0501000A;
+static constexpr uint32_t FRAME_MILLIS = 25;
+
+static uint8_t s_Data[16][artnet::DMX_LENGTH];
+static uint32_t s_nErrors;
+static uint32_t s_nTests;
+
+static void check(const bool bCondition, const char *pTest, const char *pMessage) {
+	s_nTests++;
+
+	if (!bCondition && (s_nErrors++ < 16)) {
+		printf("%s: %s\n", pTest, pMessage);
+	}
+}
+
+static void node_add(ArtNetController& controller, const uint32_t nIpAddress, const uint8_t nBindIndex, const uint8_t *pUniverses, const uint32_t nUniverses) {
+	artnet::ArtPollReply reply;
+	memset(&reply, 0, sizeof(struct artnet::ArtPollReply));
+
+	memcpy(reply.IPAddress, &nIpAddress, sizeof(reply.IPAddress));
+	reply.BindIndex = nBindIndex;
+
+	for (uint32_t nPort = 0; nPort < nUniverses; nPort++) {
+		reply.PortTypes[nPort] = static_cast<uint8_t>(artnet::PortType::OUTPUT_ARTNET);
+		reply.SwOut[nPort] = pUniverses[nPort];
+	}
+
+	controller.Add(&reply);
+}
+
+static bool dmx_get(const uint32_t nIndex, artnet::ArtDmx& artDmx) {
+	const auto& packet = Network::Get()->GetPacket(nIndex);
+	memcpy(&artDmx, packet.Buffer, sizeof(struct artnet::ArtDmx));
+	return artDmx.OpCode == static_cast<uint16_t>(artnet::OpCodes::OP_DMX);
+}
+
+/**
+ * @return The number of ArtDmx packets for the universe, to nToIp when not 0
+ */
+static uint32_t dmx_sent(const uint16_t nUniverse, const uint32_t nToIp = 0) {
+	uint32_t nCount = 0;
+
+	for (uint32_t i = 0; i < Network::Get()->GetPackets(); i++) {
+		artnet::ArtDmx artDmx;
+		if (dmx_get(i, artDmx) && (artDmx.PortAddress == nUniverse) && ((nToIp == 0) || (Network::Get()->GetPacket(i).nToIp == nToIp))) {
+			nCount++;
+		}
+	}
+
+	return nCount;
+}
+
+/**
+ * @return The sequence of the last ArtDmx packet for the universe, 0 when not sent
+ */
+static uint8_t dmx_sequence(const uint16_t nUniverse) {
+	uint8_t nSequence = 0;
+
+	for (uint32_t i = 0; i < Network::Get()->GetPackets(); i++) {
+		artnet::ArtDmx artDmx;
+		if (dmx_get(i, artDmx) && (artDmx.PortAddress == nUniverse)) {
+			nSequence = artDmx.Sequence;
+		}
+	}
+
+	return nSequence;
+}
+
+static uint32_t dmx_total() {
+	uint32_t nCount = 0;
+
+	for (uint32_t i = 0; i < Network::Get()->GetPackets(); i++) {
+		artnet::ArtDmx artDmx;
+		if (dmx_get(i, artDmx)) {
+			nCount++;
+		}
+	}
+
+	return nCount;
+}
+
+/**
+ * One frame of the show: the universes in the list, then the ArtSync.
+ */
+static void frame(ArtNetController& controller, const uint8_t *pUniverses, const uint32_t nUniverses, const uint32_t nLength = artnet::DMX_LENGTH) {
+	Hardware::AddMillis(FRAME_MILLIS);
+	Network::Get()->Clear();
+
+	for (uint32_t i = 0; i < nUniverses; i++) {
+		controller.HandleDmxOut(pUniverses[i], s_Data[pUniverses[i]], nLength);
+	}
+
+	controller.HandleSync();
+}
+
+int main() {
+	Hardware::SetMillis(1000);
+
+	for (uint32_t nUniverse = 0; nUniverse < 16; nUniverse++) {
+		for (uint32_t i = 0; i < artnet::DMX_LENGTH; i++) {
+			s_Data[nUniverse][i] = static_cast<uint8_t>(nUniverse + i);
+		}
+	}
+
+	auto *pController = new ArtNetController;
+	auto& controller = *pController;
+
+	static constexpr uint8_t UNIVERSES_A[] = { 1, 2 };
+	static constexpr uint8_t UNIVERSES_B[] = { 2 };
+	static constexpr uint8_t UNIVERSES_C[] = { 1 };
+	node_add(controller, NODE_A, 1, UNIVERSES_A, sizeof(UNIVERSES_A));
+	node_add(controller, NODE_B, 1, UNIVERSES_B, sizeof(UNIVERSES_B));
+
+	static constexpr uint8_t SHOW[] = { 1, 2 };
+	const auto& statistics = controller.GetDmxStatistics();
+
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1, NODE_A) == 1) && (dmx_sent(2, NODE_A) == 1) && (dmx_sent(2, NODE_B) == 1) && (dmx_total() == 3), "first frame", "not sent to the subscribers");
+	check((dmx_sequence(1) == 1) && (dmx_sequence(2) == 1), "first frame", "the sequence is not per universe");
+	check(Network::Get()->GetPackets() == 4, "first frame", "no ArtSync");
+
+	frame(controller, SHOW, sizeof(SHOW));
+	check(Network::Get()->GetPackets() == 0, "unchanged", "sent");
+	check(statistics.nSuppressed == 2, "unchanged", "not counted as suppressed");
+
+	s_Data[1][511]++;
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1) == 1) && (dmx_sent(2) == 0), "last slot changed", "wrong universes sent");
+	check(dmx_sequence(1) == 2, "last slot changed", "wrong sequence");
+
+	Hardware::AddMillis(artnetcontroller::DMX_REFRESH_MILLIS_DEFAULT);
+	const auto nRefresh = statistics.nRefresh;
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1) == 1) && (dmx_sent(2) == 2), "refresh", "not sent");
+	check((dmx_sequence(1) == 3) && (dmx_sequence(2) == 2), "refresh", "wrong sequence");
+	check(statistics.nRefresh == nRefresh + 2, "refresh", "not counted as refresh");
+
+	frame(controller, SHOW, sizeof(SHOW), artnet::DMX_LENGTH / 2);
+	check((dmx_sent(1) == 1) && (dmx_sent(2) == 2), "length changed", "not sent");
+
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1) == 1) && (dmx_sent(2) == 2), "length restored", "not sent");
+
+	controller.SetMaster(128);
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1) == 1) && (dmx_sent(2) == 2), "master changed", "not sent");
+	{
+		artnet::ArtDmx artDmx;
+		dmx_get(0, artDmx);
+		check(artDmx.Data[100] == ((128U * s_Data[1][100]) / DMX_MAX_VALUE), "master changed", "wrong level");
+	}
+	controller.SetMaster(DMX_MAX_VALUE);
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1) == 1) && (dmx_sent(2) == 2), "master restored", "not sent");
+
+	node_add(controller, NODE_C, 1, UNIVERSES_C, sizeof(UNIVERSES_C));
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1, NODE_A) == 1) && (dmx_sent(1, NODE_C) == 1) && (dmx_sent(2) == 0), "subscriber added", "wrong universes sent");
+
+	// Node C moves to universe 3 and node E takes its place, the number of subscribers of universe 1 is the same
+	static constexpr uint8_t UNIVERSES_C_MOVED[] = { 3 };
+	node_add(controller, NODE_C, 1, UNIVERSES_C_MOVED, sizeof(UNIVERSES_C_MOVED));
+	node_add(controller, NODE_E, 1, UNIVERSES_C, sizeof(UNIVERSES_C));
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1, NODE_A) == 1) && (dmx_sent(1, NODE_E) == 1) && (dmx_sent(1, NODE_C) == 0) && (dmx_sent(2) == 0), "subscriber replaced", "wrong universes sent");
+
+	auto nSequence1 = dmx_sequence(1);
+	Network::Get()->Clear();
+	controller.HandleBlackout();
+	{
+		bool bIsBlack = true;
+		for (uint32_t i = 0; i < Network::Get()->GetPackets(); i++) {
+			artnet::ArtDmx artDmx;
+			if (dmx_get(i, artDmx)) {
+				for (uint32_t nSlot = 0; nSlot < artnet::DMX_LENGTH; nSlot++) {
+					bIsBlack &= (artDmx.Data[nSlot] == 0);
+				}
+			}
+		}
+		check((dmx_sent(1) == 2) && (dmx_sent(2) == 2) && bIsBlack, "blackout", "not sent");
+		check(dmx_sequence(1) == static_cast<uint8_t>(nSequence1 + 1), "blackout", "wrong sequence");
+	}
+
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1) == 2) && (dmx_sent(2) == 2), "after blackout", "not sent");
+
+	// The sequence wraps from 255 to 1
+	static constexpr uint8_t SHOW_1[] = { 1 };
+	nSequence1 = dmx_sequence(1);
+	bool bIsConsecutive = true;
+
+	for (uint32_t nFrame = 0; nFrame < 600; nFrame++) {
+		s_Data[1][0]++;
+		frame(controller, SHOW_1, sizeof(SHOW_1));
+		const auto nSequence = dmx_sequence(1);
+		bIsConsecutive &= (nSequence == ((nSequence1 == 0xFF) ? 1 : nSequence1 + 1));
+		nSequence1 = nSequence;
+	}
+
+	check(bIsConsecutive, "sequence", "not consecutive from 1 to 255");
+
+	// Universes 1, 2, 5 and 6 fill the active universes table, universe 7 is sent every frame
+	static constexpr uint8_t UNIVERSES_D[] = { 5, 6, 7 };
+	node_add(controller, NODE_D, 1, UNIVERSES_D, sizeof(UNIVERSES_D));
+	static constexpr uint8_t SHOW_FULL[] = { 1, 2, 5, 6, 7 };
+	frame(controller, SHOW_FULL, sizeof(SHOW_FULL));
+	check((dmx_sent(5) == 1) && (dmx_sent(6) == 1) && (dmx_sent(7) == 1), "table full", "not sent");
+	frame(controller, SHOW_FULL, sizeof(SHOW_FULL));
+	check((dmx_sent(5) == 0) && (dmx_sent(6) == 0) && (dmx_sent(7) == 1), "table full", "universe 7 not sent every frame");
+	check(dmx_sequence(7) == 2, "table full", "wrong sequence");
+
+	controller.SetDmxRefresh(0);
+	frame(controller, SHOW, sizeof(SHOW));
+	check((dmx_sent(1) == 2) && (dmx_sent(2) == 2), "refresh 0", "not sent every frame");
+
+	check(Network::Get()->GetOverflow() == 0, "network", "log overflow");
+
+	delete pController;
+
+	if (s_nErrors != 0) {
+		printf("test_controller: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+	printf("test_controller: %u tests passed\n", s_nTests);
+	return EXIT_SUCCESS;
+}
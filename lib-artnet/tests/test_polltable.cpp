@@ -0,0 +1,265 @@
+/**
+ * @file test_polltable.cpp
+ *
+ * ArtNetPollTable against a model of the nodes and their universes. Random
+ * ArtPollReply packets, Clean() calls and clock steps; after every few steps
+ * the node, universe and subscriber chains are checked against the model.
+ * Built with small table sizes the tables overflow, then the contents must
+ * be a subset of the model.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <map>
+#include <set>
+
+#include "artnetpolltable.h"
+#include "artnet.h"
+
+#include "hardware.h"
+
+static constexpr uint32_t STEPS = 200000;
+static constexpr uint32_t CHECK_INTERVAL = 101;
+static constexpr uint32_t NODES = 60;
+static constexpr uint32_t SUBNETS = 3;
+static constexpr uint32_t PORT_ADDRESS_MAX = 0x7FFF;	///< 15 bits
+
+static constexpr bool IS_OVERFLOW = (artnet::POLL_TABLE_SIZE_ENRIES < NODES) || (artnet::POLL_TABLE_SIZE_UNIVERSES < (SUBNETS * 16));
+
+struct ModelNode {
+	uint32_t nLastUpdateMillis;
+	std::map<uint16_t, uint8_t> universes;	///< Port-Address, BindIndex
+};
+
+static std::map<uint32_t, ModelNode> s_Model;
+static uint32_t s_nErrors;
+
+static void error(const uint32_t nStep, const char *pMessage, const uint32_t nValue) {
+	if (s_nErrors++ < 16) {
+		printf("step %u: %s [%u]\n", nStep, pMessage, nValue);
+	}
+}
+
+static uint32_t random_below(const uint32_t nValue) {
+	return static_cast<uint32_t>(random()) % nValue;
+}
+
+static void poll_reply(ArtNetPollTable& pollTable) {
+	artnet::ArtPollReply reply;
+	memset(&reply, 0, sizeof(struct artnet::ArtPollReply));
+
+	const auto nIpAddress = 0x0A000000U | (1 + random_below(NODES));
+	memcpy(reply.IPAddress, &nIpAddress, sizeof(reply.IPAddress));
+	reply.SubSwitch = static_cast<uint8_t>(random_below(SUBNETS));
+	reply.BindIndex = static_cast<uint8_t>(random_below(3));
+
+	std::set<uint16_t> universes;
+
+	for (uint32_t nPort = 0; nPort < artnet::PORTS; nPort++) {
+		if (random_below(4) != 0) {
+			reply.PortTypes[nPort] = static_cast<uint8_t>(artnet::PortType::OUTPUT_ARTNET);
+			reply.SwOut[nPort] = static_cast<uint8_t>(random_below(16));
+			universes.insert(artnet::make_port_address(reply.NetSwitch, reply.SubSwitch, reply.SwOut[nPort]));
+		}
+	}
+
+	pollTable.Add(&reply);
+
+	// The universes of this BindIndex which are not reported anymore are removed
+	auto& node = s_Model[nIpAddress];
+	node.nLastUpdateMillis = Hardware::Get()->Millis();
+	const auto nBindIndex = static_cast<uint8_t>((reply.BindIndex == 0) ? 1 : reply.BindIndex);
+
+	for (auto it = node.universes.begin(); it != node.universes.end();) {
+		if ((it->second == nBindIndex) && (universes.count(it->first) == 0)) {
+			it = node.universes.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	for (const auto nUniverse : universes) {
+		node.universes[nUniverse] = nBindIndex;
+	}
+}
+
+/**
+ * A node expires in the first Clean() after the second in which its time-out passed
+ */
+static void clean(ArtNetPollTable& pollTable) {
+	pollTable.Clean();
+
+	const auto nTick = Hardware::Get()->Millis() / artnet::POLL_TABLE_WHEEL_SLOT_MILLIS;
+
+	for (auto it = s_Model.begin(); it != s_Model.end();) {
+		if (((it->second.nLastUpdateMillis + artnet::POLL_TABLE_TIMEOUT_MILLIS) / artnet::POLL_TABLE_WHEEL_SLOT_MILLIS) < nTick) {
+			it = s_Model.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+static void check(const ArtNetPollTable& pollTable, const uint32_t nStep) {
+	std::map<uint16_t, std::set<uint32_t>> subscribers;
+
+	for (uint32_t nNode = 0; nNode < pollTable.GetPollTableEntries(); nNode++) {
+		const auto& node = pollTable.GetPollTable()[nNode];
+		const auto it = s_Model.find(node.IPAddress);
+
+		if (it == s_Model.end()) {
+			error(nStep, "node not in the model", node.IPAddress);
+			continue;
+		}
+
+		std::set<uint16_t> universes;
+		uint32_t nLength = 0;
+
+		for (auto nEntry = static_cast<uint32_t>(node.nUniverseFirst); nEntry != artnet::POLL_TABLE_NONE; nEntry = pollTable.GetNodeEntryUniverse(nEntry)->nNodeNext) {
+			const auto *pEntry = pollTable.GetNodeEntryUniverse(nEntry);
+
+			if (nLength++ == artnet::POLL_TABLE_SIZE_NODE_UNIVERSES) {
+				error(nStep, "universes of the node in a loop", nNode);
+				break;
+			}
+
+			if (pEntry->IPAddress != node.IPAddress) {
+				error(nStep, "universe of another node", pEntry->nUniverse);
+			}
+
+			if (!universes.insert(pEntry->nUniverse).second) {
+				error(nStep, "universe twice", pEntry->nUniverse);
+			}
+
+			const auto itUniverse = it->second.universes.find(pEntry->nUniverse);
+
+			if (itUniverse == it->second.universes.end()) {
+				error(nStep, "universe not in the model", pEntry->nUniverse);
+			} else if (itUniverse->second != pEntry->nBindIndex) {
+				error(nStep, "wrong BindIndex", pEntry->nBindIndex);
+			}
+
+			subscribers[pEntry->nUniverse].insert(node.IPAddress);
+		}
+
+		if (universes.size() != node.nUniversesCount) {
+			error(nStep, "wrong universes count", node.nUniversesCount);
+		}
+
+		if (!IS_OVERFLOW && (universes.size() != it->second.universes.size())) {
+			error(nStep, "universes missing", static_cast<uint32_t>(it->second.universes.size() - universes.size()));
+		}
+	}
+
+	if (!IS_OVERFLOW && (pollTable.GetPollTableEntries() != s_Model.size())) {
+		error(nStep, "wrong node count", pollTable.GetPollTableEntries());
+	}
+
+	for (uint32_t nUniverse = 0; nUniverse <= PORT_ADDRESS_MAX; nUniverse++) {
+		const auto *pUniverse = pollTable.GetIpAddress(static_cast<uint16_t>(nUniverse));
+		const auto it = subscribers.find(static_cast<uint16_t>(nUniverse));
+
+		if (pUniverse == nullptr) {
+			if (it != subscribers.end()) {
+				error(nStep, "universe missing", nUniverse);
+			}
+			continue;
+		}
+
+		if (it == subscribers.end()) {
+			error(nStep, "universe without subscribers", nUniverse);
+			continue;
+		}
+
+		std::set<uint32_t> ipAddresses;
+		uint32_t nCount = 0;
+
+		for (auto nEntry = static_cast<uint32_t>(pUniverse->nSubscriberFirst); nEntry != artnet::POLL_TABLE_NONE; nEntry = pollTable.GetNodeEntryUniverse(nEntry)->nSubscriberNext) {
+			const auto *pEntry = pollTable.GetNodeEntryUniverse(nEntry);
+
+			if (nCount == artnet::POLL_TABLE_SIZE_NODE_UNIVERSES) {
+				error(nStep, "subscribers in a loop", nUniverse);
+				break;
+			}
+
+			if (pEntry->nUniverse != nUniverse) {
+				error(nStep, "subscriber of another universe", pEntry->nUniverse);
+			}
+
+			ipAddresses.insert(pEntry->IPAddress);
+			nCount++;
+		}
+
+		if ((nCount != pUniverse->nCount) || (ipAddresses != it->second)) {
+			error(nStep, "wrong subscribers", nUniverse);
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	srandom((argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 1);
+	Hardware::SetMillis(5000);
+
+	auto *pPollTable = new ArtNetPollTable;
+
+	for (uint32_t nStep = 0; nStep < STEPS; nStep++) {
+		const auto nOperation = random_below(20);
+
+		if (nOperation < 8) {
+			poll_reply(*pPollTable);
+		} else if (nOperation < 16) {
+			clean(*pPollTable);
+		} else {
+			// Mostly short steps, sometimes the controller loop has stalled
+			Hardware::AddMillis(random_below((nOperation == 19) ? 3000 : 300));
+		}
+
+		if ((nStep % CHECK_INTERVAL) == 0) {
+			check(*pPollTable, nStep);
+
+			// The chains are broken, the next operations could loop
+			if (s_nErrors != 0) {
+				break;
+			}
+		}
+	}
+
+	if (IS_OVERFLOW && (pPollTable->GetPollTableOverflow() == 0)) {
+		error(STEPS, "no overflow", 0);
+	}
+
+	const auto nOverflow = pPollTable->GetPollTableOverflow();
+	delete pPollTable;
+
+	if (s_nErrors != 0) {
+		printf("test_polltable: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+	printf("test_polltable (%u nodes, %u universes): %u steps passed, %u ports overflow\n", artnet::POLL_TABLE_SIZE_ENRIES, artnet::POLL_TABLE_SIZE_UNIVERSES, STEPS, nOverflow);
+
+	return EXIT_SUCCESS;
+}
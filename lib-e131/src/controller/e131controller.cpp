@@ -219,14 +219,19 @@ void E131Controller::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData, u
 
 	m_pE131DataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(static_cast<uint16_t>(1 + nLength));
 
-	Network::Get()->SendTo(m_nHandle, m_pE131DataPacket, static_cast<uint16_t>(DATA_PACKET_SIZE(1U + nLength)), nIp, e131::UDP_PORT);
+	Network::Get()->SendToQueue(m_nHandle, m_pE131DataPacket, static_cast<uint16_t>(DATA_PACKET_SIZE(1U + nLength)), nIp, e131::UDP_PORT);
 }
 
+/**
+ * End of frame: the queued data packets and the synchronization packet leave together.
+ */
 void E131Controller::HandleSync() {
 	if (m_State.SynchronizationPacket.nUniverseNumber != 0) {
 		m_pE131SynchronizationPacket->FrameLayer.SequenceNumber = m_State.SynchronizationPacket.nSequenceNumber++;
-		Network::Get()->SendTo(m_nHandle, m_pE131SynchronizationPacket, SYNCHRONIZATION_PACKET_SIZE, m_State.SynchronizationPacket.nIpAddress, e131::UDP_PORT);
+		Network::Get()->SendToQueue(m_nHandle, m_pE131SynchronizationPacket, SYNCHRONIZATION_PACKET_SIZE, m_State.SynchronizationPacket.nIpAddress, e131::UDP_PORT);
 	}
+
+	Network::Get()->SendToQueueFlush();
 }
 
 void E131Controller::HandleBlackout() {
@@ -248,12 +253,10 @@ void E131Controller::HandleBlackout() {
 		m_pE131DataPacket->FrameLayer.SequenceNumber = GetSequenceNumber(nUniverse, nIp);
 		m_pE131DataPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
 
-		Network::Get()->SendTo(m_nHandle, m_pE131DataPacket, DATA_PACKET_SIZE(513), nIp, e131::UDP_PORT);
+		Network::Get()->SendToQueue(m_nHandle, m_pE131DataPacket, DATA_PACKET_SIZE(513), nIp, e131::UDP_PORT);
 	}
 
-	if (m_State.SynchronizationPacket.nUniverseNumber != 0) {
-		HandleSync();
-	}
+	HandleSync();
 }
 
 const uint8_t *E131Controller::GetSoftwareVersion() {
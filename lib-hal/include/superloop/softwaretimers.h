@@ -35,6 +35,8 @@ TimerHandle_t SoftwareTimerAdd(const uint32_t nIntervalMillis, const TimerCallba
 bool SoftwareTimerDelete(TimerHandle_t& nId);
 bool SoftwareTimerChange(const TimerHandle_t nId, const uint32_t nIntervalMillis);
 
+uint32_t SoftwareTimerNextExpire();
+
 void SoftwareTimerRun();
 
 #endif /* HAL_SUPERLOOP_TIMERS_H_ */
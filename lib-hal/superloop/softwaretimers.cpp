@@ -111,6 +111,28 @@ bool SoftwareTimerChange(const TimerHandle_t nId, const uint32_t nIntervalMillis
 	return false;
 }
 
+/**
+ * @return milliseconds until the first timer expires, 0 when a timer is due and UINT32_MAX when there are no timers
+ */
+uint32_t SoftwareTimerNextExpire() {
+	const auto nCurrentTime = Hardware::Get()->Millis();
+	uint32_t nNextExpire = UINT32_MAX;
+
+	for (uint32_t i = 0; i < m_nTimersCount; i++) {
+		if (m_Timers[i].nExpireTime <= nCurrentTime) {
+			return 0;
+		}
+
+		const auto nDelta = m_Timers[i].nExpireTime - nCurrentTime;
+
+		if (nDelta < nNextExpire) {
+			nNextExpire = nDelta;
+		}
+	}
+
+	return nNextExpire;
+}
+
 void SoftwareTimerRun() {
     const auto nCurrentTime = Hardware::Get()->Millis();
 
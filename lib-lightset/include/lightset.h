@@ -2,7 +2,7 @@
  * @file lightset.h
  *
  */
-/* Copyright (C) 2016-2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2016-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -32,7 +32,14 @@
 #include <climits>
 #include <cassert>
 
+#if !defined (CONFIG_LIGHTSET_MERGE_SOURCES)
+# define CONFIG_LIGHTSET_MERGE_SOURCES	2
+#endif
+
 namespace lightset {
+static constexpr uint32_t MERGE_SOURCES = CONFIG_LIGHTSET_MERGE_SOURCES;	///< Sources per output port which can be merged
+static_assert((MERGE_SOURCES >= 2) && (MERGE_SOURCES <= 16));
+
 namespace dmx {
 static constexpr uint16_t ADDRESS_INVALID = 0xFFFF;
 static constexpr uint32_t START_ADDRESS_DEFAULT = 1;
@@ -0,0 +1,197 @@
+/**
+ * @file lightset_merge.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LIGHTSET_MERGE_H_
+#define LIGHTSET_MERGE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined (__ARM_NEON)
+# include <arm_neon.h>
+#elif defined (__AVX2__)
+# include <immintrin.h>
+#elif defined (__SSE2__)
+# include <emmintrin.h>
+#endif
+
+/*
+ * HTP merge kernels, the highest value per slot wins, and the LTP kernel,
+ * a copy which reports the changed slots.
+ * The implementation is selected at compile time: NEON, AVX2/SSE2,
+ * the Cortex-M SIMD instructions or a portable SWAR fallback.
+ */
+
+namespace lightset::merge {
+/**
+ * Per byte maximum of 4 slots.
+ */
+inline uint32_t htp(const uint32_t a, const uint32_t b) {
+#if defined (__ARM_FEATURE_SIMD32) && !defined (__ARM_NEON)
+	uint32_t nResult;
+	asm ("usub8 %0, %1, %2\n\tsel %0, %1, %2" : "=&r" (nResult) : "r" (a), "r" (b) : "cc");
+	return nResult;
+#else
+	/* The high bit of each byte is set when a >= b */
+	const auto nLow = (a | 0x80808080U) - (b & 0x7F7F7F7FU);
+	const auto nGreaterEqual = ((a & ~b) | (~(a ^ b) & nLow)) & 0x80808080U;
+	const auto nMask = (nGreaterEqual >> 7) * 0xFFU;
+	return (a & nMask) | (b & ~nMask);
+#endif
+}
+
+/**
+ * pDestination[i] = max(pDestination[i], pSource[i])
+ */
+inline void htp(uint8_t *pDestination, const uint8_t *pSource, uint32_t nLength) {
+#if defined (__ARM_NEON)
+	while (nLength >= 16) {
+		vst1q_u8(pDestination, vmaxq_u8(vld1q_u8(pDestination), vld1q_u8(pSource)));
+		pDestination += 16;
+		pSource += 16;
+		nLength -= 16;
+	}
+#elif defined (__AVX2__)
+	while (nLength >= 32) {
+		const auto vDestination = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pDestination));
+		const auto vSource = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pSource));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(pDestination), _mm256_max_epu8(vDestination, vSource));
+		pDestination += 32;
+		pSource += 32;
+		nLength -= 32;
+	}
+#elif defined (__SSE2__)
+	while (nLength >= 16) {
+		const auto vDestination = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pDestination));
+		const auto vSource = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSource));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(pDestination), _mm_max_epu8(vDestination, vSource));
+		pDestination += 16;
+		pSource += 16;
+		nLength -= 16;
+	}
+#endif
+
+	while (nLength >= 4) {
+		uint32_t nDestination, nSource;
+		memcpy(&nDestination, pDestination, 4);
+		memcpy(&nSource, pSource, 4);
+		nDestination = htp(nDestination, nSource);
+		memcpy(pDestination, &nDestination, 4);
+		pDestination += 4;
+		pSource += 4;
+		nLength -= 4;
+	}
+
+	while (nLength-- != 0) {
+		*pDestination = std::max(*pDestination, *pSource);
+		pDestination++;
+		pSource++;
+	}
+}
+/**
+ * Bit n is set when byte n of nChanged is not zero.
+ */
+inline uint32_t changed_bits(const uint32_t nChanged) {
+	const auto nNonZero = (((nChanged & 0x7F7F7F7FU) + 0x7F7F7F7FU) | nChanged) & 0x80808080U;
+	/* Moves the bits 7, 15, 23 and 31 to the bits 21 to 24 */
+	return (((nNonZero >> 7) * 0x00204081U) >> 21) & 0xFU;
+}
+
+/**
+ * pDestination[i] = pSource[i]
+ * Bit n of the pChanged bitmap is set when slot n has changed, the other bits are kept.
+ */
+inline void ltp(uint8_t *pDestination, const uint8_t *pSource, const uint32_t nLength, uint32_t *pChanged) {
+	uint32_t nSlot = 0;
+
+#if defined (__ARM_NEON)
+	static constexpr uint8_t WEIGHTS[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	const auto vWeights = vld1q_u8(WEIGHTS);
+
+	for (; (nSlot + 32) <= nLength; nSlot += 32) {
+		const auto vSourceLow = vld1q_u8(&pSource[nSlot]);
+		const auto vSourceHigh = vld1q_u8(&pSource[nSlot + 16]);
+		const auto vLow = vandq_u8(vmvnq_u8(vceqq_u8(vld1q_u8(&pDestination[nSlot]), vSourceLow)), vWeights);
+		const auto vHigh = vandq_u8(vmvnq_u8(vceqq_u8(vld1q_u8(&pDestination[nSlot + 16]), vSourceHigh)), vWeights);
+		/* Three pairwise additions give one byte per 8 slots */
+		auto vBits = vpadd_u8(vpadd_u8(vget_low_u8(vLow), vget_high_u8(vLow)), vpadd_u8(vget_low_u8(vHigh), vget_high_u8(vHigh)));
+		vBits = vpadd_u8(vBits, vBits);
+		const auto nChanged = vget_lane_u32(vreinterpret_u32_u8(vBits), 0);
+
+		if (nChanged != 0) {
+			vst1q_u8(&pDestination[nSlot], vSourceLow);
+			vst1q_u8(&pDestination[nSlot + 16], vSourceHigh);
+			pChanged[nSlot / 32] |= nChanged;
+		}
+	}
+#elif defined (__AVX2__)
+	for (; (nSlot + 32) <= nLength; nSlot += 32) {
+		const auto vSource = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&pSource[nSlot]));
+		const auto vEqual = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(&pDestination[nSlot])), vSource);
+		const auto nChanged = ~static_cast<uint32_t>(_mm256_movemask_epi8(vEqual));
+
+		if (nChanged != 0) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(&pDestination[nSlot]), vSource);
+			pChanged[nSlot / 32] |= nChanged;
+		}
+	}
+#elif defined (__SSE2__)
+	for (; (nSlot + 32) <= nLength; nSlot += 32) {
+		const auto vSourceLow = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pSource[nSlot]));
+		const auto vSourceHigh = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pSource[nSlot + 16]));
+		const auto nEqualLow = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&pDestination[nSlot])), vSourceLow)));
+		const auto nEqualHigh = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&pDestination[nSlot + 16])), vSourceHigh)));
+		const auto nChanged = ~(nEqualLow | (nEqualHigh << 16));
+
+		if (nChanged != 0) {
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(&pDestination[nSlot]), vSourceLow);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(&pDestination[nSlot + 16]), vSourceHigh);
+			pChanged[nSlot / 32] |= nChanged;
+		}
+	}
+#endif
+
+	for (; (nSlot + 4) <= nLength; nSlot += 4) {
+		uint32_t nDestination, nSource;
+		memcpy(&nDestination, &pDestination[nSlot], 4);
+		memcpy(&nSource, &pSource[nSlot], 4);
+
+		if (nDestination != nSource) {
+			memcpy(&pDestination[nSlot], &nSource, 4);
+			pChanged[nSlot / 32] |= changed_bits(nDestination ^ nSource) << (nSlot & 0x1F);
+		}
+	}
+
+	for (; nSlot < nLength; nSlot++) {
+		if (pDestination[nSlot] != pSource[nSlot]) {
+			pDestination[nSlot] = pSource[nSlot];
+			pChanged[nSlot / 32] |= 1U << (nSlot & 0x1F);
+		}
+	}
+}
+}  // namespace lightset::merge
+
+#endif /* LIGHTSET_MERGE_H_ */
@@ -2,7 +2,7 @@
  * @file lightsetdata.h
  *
  */
-/* Copyright (C) 2021-2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -32,6 +32,7 @@
 #include <cassert>
 
 #include "lightset.h"
+#include "lightset_merge.h"
 
 #if defined (GD32)
 /**
@@ -58,19 +59,30 @@ public:
 	}
 
 	static void SetSourceA(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength) {
-		Get().IMergeSourceA(nPortIndex, pData, nLength, MergeMode::LTP);
+		Get().IMergeSource(nPortIndex, 0, pData, nLength, MergeMode::LTP, SOURCES_A_B);
 	}
 
 	static void MergeSourceA(const uint32_t nPortIndex, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode) {
-		 Get().IMergeSourceA(nPortIndex, pData, nLength, mergeMode);
+		 Get().IMergeSource(nPortIndex, 0, pData, nLength, mergeMode, SOURCES_A_B);
 	}
 
 	static void SetSourceB(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength) {
-		Get().IMergeSourceB(nPortIndex, pData, nLength, MergeMode::LTP);
+		Get().IMergeSource(nPortIndex, 1, pData, nLength, MergeMode::LTP, SOURCES_A_B);
 	}
 
 	static void MergeSourceB(const uint32_t nPortIndex, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode) {
-		 Get().IMergeSourceB(nPortIndex, pData, nLength, mergeMode);
+		 Get().IMergeSource(nPortIndex, 1, pData, nLength, mergeMode, SOURCES_A_B);
+	}
+
+	static void SetSource(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t *pData, uint32_t nLength) {
+		Get().IMergeSource(nPortIndex, nSourceIndex, pData, nLength, MergeMode::LTP, 1U << nSourceIndex);
+	}
+
+	/**
+	 * @param nSourcesMask The sources to be merged, bit n is source n. Includes nSourceIndex.
+	 */
+	static void MergeSource(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode, const uint32_t nSourcesMask) {
+		Get().IMergeSource(nPortIndex, nSourceIndex, pData, nLength, mergeMode, nSourcesMask);
 	}
 
 	static void Clear(uint32_t nPortIndex) {
@@ -93,47 +105,116 @@ public:
 		Get().IRestore(nPortIndex, pData);
 	}
 
+	/**
+	 * Bit n is set when slot n of the output has changed since the last ClearDirty.
+	 */
+	static const uint32_t *GetDirty(const uint32_t nPortIndex) {
+		return Get().IGetDirty(nPortIndex);
+	}
+
+	static void ClearDirty(const uint32_t nPortIndex) {
+		Get().IClearDirty(nPortIndex);
+	}
+
 private:
 //	Data() {}
 
-	void IMergeSourceA(const uint32_t nPortIndex, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode) {
+#if !defined (LIGHTSET_PORTS)
+# define LIGHTSET_PORTS 0
+#endif
+
+#if (LIGHTSET_PORTS == 0)
+	static constexpr auto PORTS = 1;	// ISO C++ forbids zero-size array
+#else
+	static constexpr auto PORTS = LIGHTSET_PORTS;
+#endif
+
+	struct Source {
+		uint8_t data[dmx::UNIVERSE_SIZE] __attribute__ ((aligned (4)));
+	};
+
+	static constexpr uint32_t SOURCES_A_B = 0x3;
+	static constexpr uint32_t MERGE_BLOCK_SIZE = 32;	///< One word of the dirty slot bitmap
+
+	static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The slot of a byte in a word assumes little endian");
+
+	struct OutputPort {
+		Source source[MERGE_SOURCES];
+		uint8_t data[dmx::UNIVERSE_SIZE] __attribute__ ((aligned (4)));
+		uint32_t dirty[dmx::UNIVERSE_SIZE / 32];
+		uint32_t nLength;
+		uint32_t nMergedMask;
+	};
+
+	/*
+	 * Only the blocks with slots that differ from the stored source are merged again.
+	 * A full merge is done when the set of sources, the merge mode or the length changes.
+	 */
+	void IMergeSource(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode, const uint32_t nSourcesMask) {
 		assert(nPortIndex < PORTS);
+		assert(nSourceIndex < MERGE_SOURCES);
 		assert(pData != nullptr);
+		assert(nLength <= dmx::UNIVERSE_SIZE);
+		assert((nSourcesMask & (1U << nSourceIndex)) != 0);
 
-		memcpy(m_OutputPort[nPortIndex].sourceA.data, pData, nLength);
-
-		m_OutputPort[nPortIndex].nLength = nLength;
+		auto& outputPort = m_OutputPort[nPortIndex];
+		auto *pSource = outputPort.source[nSourceIndex].data;
 
-		if (mergeMode == MergeMode::HTP) {
-			for (uint32_t i = 0; i < nLength; i++) {
-				const auto data = std::max(m_OutputPort[nPortIndex].sourceA.data[i], m_OutputPort[nPortIndex].sourceB.data[i]);
-				m_OutputPort[nPortIndex].data[i] = data;
-			}
+		if (mergeMode == MergeMode::LTP) {
+			memcpy(pSource, pData, nLength);
+			ICopySlots(outputPort, 0, pData, nLength);
+			outputPort.nLength = nLength;
+			outputPort.nMergedMask = 0;
+			return;
+		}
 
+		if ((nSourcesMask != outputPort.nMergedMask) || (nLength != outputPort.nLength)) {
+			memcpy(pSource, pData, nLength);
+			IMergeSlots(outputPort, nLength, nSourcesMask);
+			outputPort.nLength = nLength;
+			outputPort.nMergedMask = nSourcesMask;
 			return;
 		}
 
-		memcpy(m_OutputPort[nPortIndex].data, pData, nLength);
+		for (uint32_t nOffset = 0; nOffset < nLength; nOffset += MERGE_BLOCK_SIZE) {
+			const auto nBlockLength = std::min(MERGE_BLOCK_SIZE, nLength - nOffset);
+
+			if (memcmp(&pData[nOffset], &pSource[nOffset], nBlockLength) != 0) {
+				memcpy(&pSource[nOffset], &pData[nOffset], nBlockLength);
+				IMergeBlock(outputPort, nOffset, nBlockLength, nSourcesMask);
+			}
+		}
 	}
 
-	void IMergeSourceB(const uint32_t nPortIndex, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode) {
-		assert(nPortIndex < PORTS);
-		assert(pData != nullptr);
+	static void ICopySlots(OutputPort& outputPort, const uint32_t nOffset, const uint8_t *pData, const uint32_t nLength) {
+		assert((nOffset % 32) == 0);
+		merge::ltp(&outputPort.data[nOffset], pData, nLength, &outputPort.dirty[nOffset / 32]);
+	}
 
-		memcpy(m_OutputPort[nPortIndex].sourceB.data, pData, nLength);
+	/*
+	 * The sources are merged with the HTP kernel, then copied to the output with the LTP kernel.
+	 */
+	static void IMergeBlock(OutputPort& outputPort, const uint32_t nOffset, const uint32_t nBlockLength, uint32_t nSourcesMask) {
+		uint8_t merged[MERGE_BLOCK_SIZE] __attribute__ ((aligned (4)));
 
-		m_OutputPort[nPortIndex].nLength = nLength;
+		auto nIndex = static_cast<uint32_t>(__builtin_ctz(nSourcesMask));
+		nSourcesMask &= nSourcesMask - 1;
 
-		if (mergeMode == MergeMode::HTP) {
-			for (uint32_t i = 0; i < nLength; i++) {
-				const auto data = std::max(m_OutputPort[nPortIndex].sourceA.data[i], m_OutputPort[nPortIndex].sourceB.data[i]);
-				m_OutputPort[nPortIndex].data[i] = data;
-			}
+		memcpy(merged, &outputPort.source[nIndex].data[nOffset], nBlockLength);
 
-			return;
+		while (nSourcesMask != 0) {
+			nIndex = static_cast<uint32_t>(__builtin_ctz(nSourcesMask));
+			nSourcesMask &= nSourcesMask - 1;
+			merge::htp(merged, &outputPort.source[nIndex].data[nOffset], nBlockLength);
 		}
 
-		memcpy(m_OutputPort[nPortIndex].data, pData, nLength);
+		ICopySlots(outputPort, nOffset, merged, nBlockLength);
+	}
+
+	static void IMergeSlots(OutputPort& outputPort, const uint32_t nLength, const uint32_t nSourcesMask) {
+		for (uint32_t nOffset = 0; nOffset < nLength; nOffset += MERGE_BLOCK_SIZE) {
+			IMergeBlock(outputPort, nOffset, std::min(MERGE_BLOCK_SIZE, nLength - nOffset), nSourcesMask);
+		}
 	}
 
 //	void ISet(LightSet *const pLightSet, const uint32_t nPortIndex) const {
@@ -164,6 +245,8 @@ private:
 
 		memset(m_OutputPort[nPortIndex].data, 0, dmx::UNIVERSE_SIZE);
 		m_OutputPort[nPortIndex].nLength = dmx::UNIVERSE_SIZE;
+		m_OutputPort[nPortIndex].nMergedMask = 0;
+		memset(m_OutputPort[nPortIndex].dirty, 0xFF, sizeof(m_OutputPort[nPortIndex].dirty));
 	}
 
 	void IClearLength(const uint32_t nPortIndex) {
@@ -186,30 +269,21 @@ private:
 		assert(pData != nullptr);
 
 		memcpy(m_OutputPort[nPortIndex].data, pData, dmx::UNIVERSE_SIZE);
+		m_OutputPort[nPortIndex].nMergedMask = 0;
+		memset(m_OutputPort[nPortIndex].dirty, 0xFF, sizeof(m_OutputPort[nPortIndex].dirty));
 	}
 
-private:
-#if !defined (LIGHTSET_PORTS)
-# define LIGHTSET_PORTS 0
-#endif
-
-#if (LIGHTSET_PORTS == 0)
-	static constexpr auto PORTS = 1;	// ISO C++ forbids zero-size array
-#else
-	static constexpr auto PORTS = LIGHTSET_PORTS;
-#endif
-
-	struct Source {
-		uint8_t data[dmx::UNIVERSE_SIZE] __attribute__ ((aligned (4)));
-	};
+	const uint32_t *IGetDirty(const uint32_t nPortIndex) const {
+		assert(nPortIndex < PORTS);
+		return m_OutputPort[nPortIndex].dirty;
+	}
 
-	struct OutputPort {
-		Source sourceA;
-		Source sourceB;
-		uint8_t data[dmx::UNIVERSE_SIZE] __attribute__ ((aligned (4)));
-		uint32_t nLength;
-	};
+	void IClearDirty(const uint32_t nPortIndex) {
+		assert(nPortIndex < PORTS);
+		memset(m_OutputPort[nPortIndex].dirty, 0, sizeof(m_OutputPort[nPortIndex].dirty));
+	}
 
+private:
 	OutputPort m_OutputPort[PORTS];
 };
 
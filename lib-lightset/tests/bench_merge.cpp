@@ -0,0 +1,128 @@
+/**
+ * @file bench_merge.cpp
+ *
+ * Cost per received universe of lightset::Data::MergeSource(), for HTP and LTP
+ * with 1, 2 and 4 sources. Every source sends a new frame in turn, either with
+ * all slots changed or with a few slots changed, as with a slow fade.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+
+#include "lightsetdata.h"
+
+using lightset::dmx::UNIVERSE_SIZE;
+
+static constexpr uint32_t FRAMES = 100000;
+static constexpr uint32_t RUNS = 7;	///< The fastest run is reported
+static constexpr uint32_t SOURCES[] = { 1, 2, 4 };
+static constexpr uint32_t FADE_SLOTS = 8;
+
+static_assert(lightset::MERGE_SOURCES >= 4, "Build with -DCONFIG_LIGHTSET_MERGE_SOURCES=4");
+
+/// Two frames per source, the benchmark alternates between them
+static uint8_t s_Frames[4][2][UNIVERSE_SIZE];
+
+static uint64_t nanos_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000U + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void frames_set(const uint32_t nChangedSlots) {
+	for (uint32_t nSource = 0; nSource < 4; nSource++) {
+		for (uint32_t i = 0; i < UNIVERSE_SIZE; i++) {
+			s_Frames[nSource][0][i] = static_cast<uint8_t>(random());
+		}
+
+		memcpy(s_Frames[nSource][1], s_Frames[nSource][0], UNIVERSE_SIZE);
+
+		for (uint32_t i = 0; i < nChangedSlots; i++) {
+			const auto nSlot = (nChangedSlots == UNIVERSE_SIZE) ? i : static_cast<uint32_t>(random()) % UNIVERSE_SIZE;
+			s_Frames[nSource][1][nSlot] ^= static_cast<uint8_t>(1 + (random() % 255));
+		}
+	}
+}
+
+/**
+ * Returns ns per universe
+ */
+static double bench(const lightset::MergeMode mergeMode, const uint32_t nSources) {
+	const auto nSourcesMask = (1U << nSources) - 1;
+	auto nBest = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		lightset::Data::Clear(0);
+
+		const auto nStart = nanos_now();
+
+		for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+			for (uint32_t nSource = 0; nSource < nSources; nSource++) {
+				lightset::Data::MergeSource(0, nSource, s_Frames[nSource][nFrame & 1], UNIVERSE_SIZE, mergeMode, nSourcesMask);
+			}
+
+			// As done by the output after sending the changed slots
+			lightset::Data::ClearDirty(0);
+		}
+
+		nBest = std::min(nBest, nanos_now() - nStart);
+	}
+
+	return static_cast<double>(nBest) / (static_cast<double>(FRAMES) * nSources);
+}
+
+int main() {
+	srandom(1071);
+
+#if defined (__ARM_NEON)
+	const char *pKernel = "NEON";
+#elif defined (__AVX2__)
+	const char *pKernel = "AVX2";
+#elif defined (__SSE2__)
+	const char *pKernel = "SSE2";
+#else
+	const char *pKernel = "SWAR";
+#endif
+
+	printf("lightset::Data::MergeSource (%s), best of %u runs of %u frames per source\n", pKernel, RUNS, FRAMES);
+
+	static constexpr uint32_t CHANGED_SLOTS[] = { UNIVERSE_SIZE, FADE_SLOTS };
+
+	for (const auto nChangedSlots : CHANGED_SLOTS) {
+		frames_set(nChangedSlots);
+
+		printf("  %3u slots changed per frame\n", nChangedSlots);
+
+		for (const auto nSources : SOURCES) {
+			const auto fHtp = bench(lightset::MergeMode::HTP, nSources);
+			const auto fLtp = bench(lightset::MergeMode::LTP, nSources);
+			printf("    %u source%s: HTP %7.1f ns, LTP %7.1f ns per universe\n", nSources, nSources == 1 ? " " : "s", fHtp, fLtp);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file arm_neon.h
+ *
+ * Plain C++ versions of the NEON intrinsics used by lightset_merge.h,
+ * so that its NEON path is tested on the build host (test_merge_neon).
+ * The lanes are in little endian order, as on Cortex-A7.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ARM_NEON_H_
+#define ARM_NEON_H_
+
+#include <cstdint>
+#include <cstring>
+
+struct uint8x8_t {
+	uint8_t val[8];
+};
+
+struct uint8x16_t {
+	uint8_t val[16];
+};
+
+struct uint32x2_t {
+	uint32_t val[2];
+};
+
+inline uint8x16_t vld1q_u8(const uint8_t *p) {
+	uint8x16_t v;
+	memcpy(v.val, p, sizeof(v.val));
+	return v;
+}
+
+inline void vst1q_u8(uint8_t *p, const uint8x16_t v) {
+	memcpy(p, v.val, sizeof(v.val));
+}
+
+inline uint8x16_t vmaxq_u8(const uint8x16_t a, const uint8x16_t b) {
+	uint8x16_t r;
+	for (uint32_t i = 0; i < 16; i++) {
+		r.val[i] = a.val[i] > b.val[i] ? a.val[i] : b.val[i];
+	}
+	return r;
+}
+
+inline uint8x16_t vceqq_u8(const uint8x16_t a, const uint8x16_t b) {
+	uint8x16_t r;
+	for (uint32_t i = 0; i < 16; i++) {
+		r.val[i] = a.val[i] == b.val[i] ? 0xFF : 0x00;
+	}
+	return r;
+}
+
+inline uint8x16_t vmvnq_u8(const uint8x16_t a) {
+	uint8x16_t r;
+	for (uint32_t i = 0; i < 16; i++) {
+		r.val[i] = static_cast<uint8_t>(~a.val[i]);
+	}
+	return r;
+}
+
+inline uint8x16_t vandq_u8(const uint8x16_t a, const uint8x16_t b) {
+	uint8x16_t r;
+	for (uint32_t i = 0; i < 16; i++) {
+		r.val[i] = a.val[i] & b.val[i];
+	}
+	return r;
+}
+
+inline uint8x8_t vget_low_u8(const uint8x16_t a) {
+	uint8x8_t r;
+	memcpy(r.val, &a.val[0], sizeof(r.val));
+	return r;
+}
+
+inline uint8x8_t vget_high_u8(const uint8x16_t a) {
+	uint8x8_t r;
+	memcpy(r.val, &a.val[8], sizeof(r.val));
+	return r;
+}
+
+/// Pairwise add, the lower half from a and the upper half from b
+inline uint8x8_t vpadd_u8(const uint8x8_t a, const uint8x8_t b) {
+	uint8x8_t r;
+	for (uint32_t i = 0; i < 4; i++) {
+		r.val[i] = static_cast<uint8_t>(a.val[2 * i] + a.val[2 * i + 1]);
+		r.val[4 + i] = static_cast<uint8_t>(b.val[2 * i] + b.val[2 * i + 1]);
+	}
+	return r;
+}
+
+inline uint32x2_t vreinterpret_u32_u8(const uint8x8_t a) {
+	uint32x2_t r;
+	memcpy(r.val, a.val, sizeof(r.val));
+	return r;
+}
+
+#define vget_lane_u32(v, lane)	((v).val[(lane)])
+
+#endif /* ARM_NEON_H_ */
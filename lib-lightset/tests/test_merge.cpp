@@ -0,0 +1,295 @@
+/**
+ * @file test_merge.cpp
+ *
+ * The HTP and LTP kernels of lightset_merge.h and the merge of lightset::Data
+ * against plain per slot reference implementations.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "lightsetdata.h"
+
+using lightset::dmx::UNIVERSE_SIZE;
+
+static constexpr uint32_t GUARD = 40;	///< Bytes after the buffer which must not be written
+static constexpr uint32_t SOURCES = lightset::MERGE_SOURCES;
+
+static uint32_t s_nErrors;
+
+static void error(const char *pName, const uint32_t nOffset, const uint32_t nLength, const char *pMessage) {
+	if (s_nErrors++ < 16) {
+		printf("%s: offset=%u, length=%u: %s\n", pName, nOffset, nLength, pMessage);
+	}
+}
+
+static uint8_t random_byte() {
+	return static_cast<uint8_t>(random());
+}
+
+static uint32_t test_htp_word() {
+	uint32_t nTests = 0;
+
+	// Every pair of values, in every byte of the word
+	for (uint32_t a = 0; a < 256; a++) {
+		for (uint32_t b = 0; b < 256; b++) {
+			for (uint32_t nShift = 0; nShift < 32; nShift += 8) {
+				const auto nMask = ~(0xFFU << nShift);
+				const auto nA = (static_cast<uint32_t>(random()) & nMask) | (a << nShift);
+				const auto nB = (static_cast<uint32_t>(random()) & nMask) | (b << nShift);
+				const auto nResult = lightset::merge::htp(nA, nB);
+
+				for (uint32_t i = 0; i < 32; i += 8) {
+					if (((nResult >> i) & 0xFF) != std::max((nA >> i) & 0xFF, (nB >> i) & 0xFF)) {
+						error("htp word", a, b, "wrong maximum");
+						break;
+					}
+				}
+
+				nTests++;
+			}
+		}
+	}
+
+	return nTests;
+}
+
+static uint32_t test_htp(const uint32_t nOffset, const uint32_t nLength) {
+	uint8_t destination[UNIVERSE_SIZE + 8 + GUARD];
+	uint8_t source[UNIVERSE_SIZE + 8];
+	uint8_t expected[UNIVERSE_SIZE + 8 + GUARD];
+
+	for (auto& n : destination) {
+		n = random_byte();
+	}
+
+	for (auto& n : source) {
+		n = random_byte();
+	}
+
+	memcpy(expected, destination, sizeof(expected));
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		expected[nOffset + i] = std::max(destination[nOffset + i], source[nOffset + i]);
+	}
+
+	lightset::merge::htp(&destination[nOffset], &source[nOffset], nLength);
+
+	if (memcmp(destination, expected, sizeof(expected)) != 0) {
+		error("htp", nOffset, nLength, "wrong maximum or written outside");
+	}
+
+	return 1;
+}
+
+static uint32_t test_changed_bits() {
+	for (uint32_t nBytes = 0; nBytes < 16; nBytes++) {
+		uint32_t nChanged = 0;
+
+		for (uint32_t i = 0; i < 4; i++) {
+			if (nBytes & (1U << i)) {
+				nChanged |= static_cast<uint32_t>(1 + (random() % 255)) << (i * 8);
+			}
+		}
+
+		if (lightset::merge::changed_bits(nChanged) != nBytes) {
+			error("changed_bits", 0, nBytes, "wrong bits");
+		}
+	}
+
+	return 16;
+}
+
+/**
+ * nDifferences slots of the source differ from the destination.
+ */
+static uint32_t test_ltp(const uint32_t nLength, const uint32_t nDifferences) {
+	uint8_t destination[UNIVERSE_SIZE + GUARD];
+	uint8_t source[UNIVERSE_SIZE];
+	uint32_t changed[UNIVERSE_SIZE / 32 + 1];
+	uint32_t expectedChanged[UNIVERSE_SIZE / 32 + 1];
+
+	for (auto& n : destination) {
+		n = random_byte();
+	}
+
+	memcpy(source, destination, sizeof(source));
+
+	for (uint32_t i = 0; i < nDifferences; i++) {
+		source[random() % UNIVERSE_SIZE] ^= static_cast<uint8_t>(1 + (random() % 255));
+	}
+
+	// The bits which are already set must be kept
+	for (uint32_t i = 0; i < sizeof(changed) / sizeof(changed[0]); i++) {
+		changed[i] = static_cast<uint32_t>(random()) & static_cast<uint32_t>(random());
+	}
+
+	memcpy(expectedChanged, changed, sizeof(changed));
+
+	uint8_t expected[UNIVERSE_SIZE + GUARD];
+	memcpy(expected, destination, sizeof(expected));
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		if (destination[i] != source[i]) {
+			expected[i] = source[i];
+			expectedChanged[i / 32] |= 1U << (i & 0x1F);
+		}
+	}
+
+	lightset::merge::ltp(destination, source, nLength, changed);
+
+	if (memcmp(destination, expected, sizeof(expected)) != 0) {
+		error("ltp", nDifferences, nLength, "wrong copy or written outside");
+	}
+
+	if (memcmp(changed, expectedChanged, sizeof(changed)) != 0) {
+		error("ltp", nDifferences, nLength, "wrong changed bits");
+	}
+
+	return 1;
+}
+
+/**
+ * lightset::Data with random frames, merge modes and sets of sources.
+ * The output and the dirty bits are compared with a full merge per frame.
+ */
+static uint32_t test_data() {
+	static constexpr uint32_t FRAMES = 20000;
+	static constexpr uint32_t LENGTHS[] = { UNIVERSE_SIZE, UNIVERSE_SIZE, UNIVERSE_SIZE, UNIVERSE_SIZE - 2, 100, 37 };
+
+	uint8_t sources[SOURCES][UNIVERSE_SIZE] = {};
+	uint8_t output[UNIVERSE_SIZE] = {};
+	uint8_t data[UNIVERSE_SIZE];
+
+	lightset::Data::Clear(0);
+	lightset::Data::ClearDirty(0);
+
+	auto nSourcesMask = (1U << SOURCES) - 1;
+	auto nLength = UNIVERSE_SIZE;
+
+	for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+		// The set of sources and the length change now and then, as when a source appears or times out
+		if ((random() % 64) == 0) {
+			nSourcesMask = 1 + static_cast<uint32_t>(random()) % ((1U << SOURCES) - 1);
+			nLength = LENGTHS[static_cast<uint32_t>(random()) % (sizeof(LENGTHS) / sizeof(LENGTHS[0]))];
+		}
+
+		const auto mergeMode = (random() % 16) == 0 ? lightset::MergeMode::LTP : lightset::MergeMode::HTP;
+
+		uint32_t nSourceIndex;
+		do {
+			nSourceIndex = static_cast<uint32_t>(random()) % SOURCES;
+		} while ((nSourcesMask & (1U << nSourceIndex)) == 0);
+
+		// From a few slots, as with a fade, to all slots
+		memcpy(data, sources[nSourceIndex], sizeof(data));
+		const auto nChanges = ((random() % 4) == 0) ? UNIVERSE_SIZE : static_cast<uint32_t>(random()) % 16;
+
+		for (uint32_t i = 0; i < nChanges; i++) {
+			data[random() % UNIVERSE_SIZE] = random_byte();
+		}
+
+		lightset::Data::MergeSource(0, nSourceIndex, data, nLength, mergeMode, nSourcesMask);
+
+		uint8_t previous[UNIVERSE_SIZE];
+		memcpy(previous, output, sizeof(output));
+		memcpy(sources[nSourceIndex], data, nLength);
+
+		for (uint32_t i = 0; i < nLength; i++) {
+			if (mergeMode == lightset::MergeMode::LTP) {
+				output[i] = data[i];
+			} else {
+				uint8_t nValue = 0;
+
+				for (uint32_t nIndex = 0; nIndex < SOURCES; nIndex++) {
+					if (nSourcesMask & (1U << nIndex)) {
+						nValue = std::max(nValue, sources[nIndex][i]);
+					}
+				}
+
+				output[i] = nValue;
+			}
+		}
+
+		if ((lightset::Data::GetLength(0) != nLength) || (memcmp(lightset::Data::Backup(0), output, sizeof(output)) != 0)) {
+			error("Data", nFrame, nLength, "wrong output");
+		}
+
+		const auto *pDirty = lightset::Data::GetDirty(0);
+
+		for (uint32_t i = 0; i < UNIVERSE_SIZE; i++) {
+			const auto isDirty = (pDirty[i / 32] & (1U << (i & 0x1F))) != 0;
+
+			if (isDirty != (output[i] != previous[i])) {
+				error("Data", nFrame, i, "wrong dirty bit");
+				break;
+			}
+		}
+
+		lightset::Data::ClearDirty(0);
+	}
+
+	return FRAMES;
+}
+
+int main() {
+	srandom(1071);
+
+	auto nTests = test_htp_word();
+	nTests += test_changed_bits();
+
+	for (uint32_t nOffset = 0; nOffset < 8; nOffset++) {
+		for (uint32_t nLength = 0; nLength <= UNIVERSE_SIZE; nLength++) {
+			nTests += test_htp(nOffset, nLength);
+		}
+	}
+
+	static constexpr uint32_t DIFFERENCES[] = { 0, 1, 2, 8, 64, UNIVERSE_SIZE };
+
+	for (const auto nDifferences : DIFFERENCES) {
+		for (uint32_t nLength = 0; nLength <= UNIVERSE_SIZE; nLength++) {
+			nTests += test_ltp(nLength, nDifferences);
+		}
+	}
+
+	nTests += test_data();
+
+	if (s_nErrors != 0) {
+		printf("test_merge: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+#if defined (__ARM_NEON)
+	printf("test_merge (NEON): %u tests passed\n", nTests);
+#elif defined (__AVX2__)
+	printf("test_merge (AVX2): %u tests passed\n", nTests);
+#elif defined (__SSE2__)
+	printf("test_merge (SSE2): %u tests passed\n", nTests);
+#else
+	printf("test_merge (SWAR): %u tests passed\n", nTests);
+#endif
+	return EXIT_SUCCESS;
+}
@@ -2,7 +2,7 @@
  * @file net_config
  *
  */
-/* Copyright (C) 2021-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -28,9 +28,35 @@
 
 #if defined(__linux__) || defined (__APPLE__)
 # define UDP_MAX_PORTS_ALLOWED			32
-# define IGMP_MAX_JOINS_ALLOWED			(4 + (8 * 4)) /* 8 outputs x 4 Universes */
 # define TCP_MAX_TCBS_ALLOWED			16
 # define TCP_MAX_PORTS_ALLOWED			2
+# if !defined (UDP_RX_BATCH_SIZE)
+#  define UDP_RX_BATCH_SIZE				8	/* Datagrams per recvmmsg(), 1 disables batching */
+# endif
+# if !defined (UDP_TX_QUEUE_SIZE)
+#  define UDP_TX_QUEUE_SIZE				64	/* Datagrams per sendmmsg(), 1 disables queuing */
+# endif
+# if defined (CONFIG_NETWORK_UDP_RX_THREAD) && !defined (UDP_RX_QUEUE_SIZE)
+#  define UDP_RX_QUEUE_SIZE				256	/* Receive thread queue entries, must be a power of 2 */
+# endif
+# if defined (CONFIG_NETWORK_USE_IO_URING) && !defined (UDP_IO_URING_BUFFERS)
+#  define UDP_IO_URING_BUFFERS			64	/* Provided receive buffers per port, must be a power of 2 */
+# endif
+# if defined (CONFIG_NETWORK_USE_TAP) && !defined(HOST_NAME_PREFIX)
+#  define HOST_NAME_PREFIX				"linux_"
+# endif
+# if !defined (ARP_MAX_RECORDS)
+#  define ARP_MAX_RECORDS				128
+# endif
+# if !defined (UDP_RX_RING_SIZE)
+#  define UDP_RX_RING_SIZE				4	/* Datagrams per polled port, must be a power of 2 */
+# endif
+# if !defined (TCP_RX_MAX_ENTRIES)
+#  define TCP_RX_MAX_ENTRIES			32	/* Receive window in segments */
+# endif
+# if !defined (TCP_TX_QUEUE_SIZE)
+#  define TCP_TX_QUEUE_SIZE				4	/* Writes waiting for the send window per connection, must be a power of 2 */
+# endif
 #else
 # define TCP_MAX_PORTS_ALLOWED			1
 # if defined (H3)
@@ -38,8 +64,16 @@
 #   define HOST_NAME_PREFIX				"allwinner_"
 #  endif
 #  define UDP_MAX_PORTS_ALLOWED			16
-#  define IGMP_MAX_JOINS_ALLOWED		(4 + (8 * 4)) /* 8 outputs x 4 Universes */
 #  define TCP_MAX_TCBS_ALLOWED			16
+#  if !defined (ARP_MAX_RECORDS)
+#   define ARP_MAX_RECORDS				128
+#  endif
+#  if !defined (UDP_RX_RING_SIZE)
+#   define UDP_RX_RING_SIZE				4
+#  endif
+#  if !defined (TCP_RX_MAX_ENTRIES)
+#   define TCP_RX_MAX_ENTRIES			16	/* Less than the EMAC receive descriptors */
+#  endif
 # elif defined (GD32)
 /*
  * Supports checking IPv4 header checksum and TCP, UDP, or ICMP checksum encapsulated in IPv4 or IPv6 datagram.
@@ -51,12 +85,18 @@
 #  if !defined (UDP_MAX_PORTS_ALLOWED)
 #   define UDP_MAX_PORTS_ALLOWED		8
 #  endif
-#  if !defined (IGMP_MAX_JOINS_ALLOWED)
-#   define IGMP_MAX_JOINS_ALLOWED		(4 + (8 * 4)) /* 8 outputs x 4 Universes */
-#  endif
 #  if !defined (TCP_MAX_TCBS_ALLOWED)
 #   define TCP_MAX_TCBS_ALLOWED			6
 #  endif
+#  if !defined (ARP_MAX_RECORDS)
+#   define ARP_MAX_RECORDS				32
+#  endif
+#  if !defined (UDP_RX_RING_SIZE)
+#   define UDP_RX_RING_SIZE				1
+#  endif
+#  if !defined (TCP_RX_MAX_ENTRIES)
+#   define TCP_RX_MAX_ENTRIES			2
+#  endif
 # else
 #  error
 # endif
@@ -66,8 +106,15 @@
 # error
 #endif
 
+/*
+ * One group per universe, the 4 extra are for the discovery and synchronization groups.
+ */
 #if !defined (IGMP_MAX_JOINS_ALLOWED)
-# error
+# if defined (LIGHTSET_PORTS) && (LIGHTSET_PORTS > (8 * 4))
+#  define IGMP_MAX_JOINS_ALLOWED			(4 + LIGHTSET_PORTS)
+# else
+#  define IGMP_MAX_JOINS_ALLOWED			(4 + (8 * 4)) /* 8 outputs x 4 Universes */
+# endif
 #endif
 
 #if !defined (TCP_MAX_PORTS_ALLOWED)
@@ -78,4 +125,16 @@
 # error
 #endif
 
+#if !defined (TCP_RX_MAX_ENTRIES)
+# error
+#endif
+
+#if !defined (TCP_TX_QUEUE_SIZE)
+# define TCP_TX_QUEUE_SIZE				4
+#endif
+
+#if !defined (ARP_MAX_QUEUE)
+# define ARP_MAX_QUEUE					4	/* Packets waiting for an ARP reply per record */
+#endif
+
 #endif /* NET_CONFIG_H_ */
@@ -37,6 +37,7 @@ void ptp_run();
 }  // namespace net
 
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <cassert>
 #include <net/if.h>
@@ -61,6 +62,10 @@ void ethernet_input(const uint8_t *pBuffer, const uint32_t nLength);
 
 void network_init();
 uint32_t emac_eth_recv(uint8_t **ppPacket);
+#if defined (CONFIG_NETWORK_USE_TAP)
+void emac_tap_set_ifname(const char *pIfName);
+void emac_tap_wait(uint32_t nTimeoutMillis);
+#endif
 
 namespace global::network {
 extern net::Link linkState;
@@ -68,6 +73,21 @@ extern net::Link linkState;
 
 class Network {
 public:
+#if defined (CONFIG_NETWORK_USE_TAP)
+	Network(int argc, char **argv) {
+		DEBUG_ENTRY
+		assert(s_pThis == nullptr);
+		s_pThis = this;
+
+		if (argc > 1) {
+			emac_tap_set_ifname(argv[1]);
+		}
+
+		network_init();
+
+		DEBUG_EXIT
+	}
+#else
 	Network() {
 		DEBUG_ENTRY
 		assert(s_pThis == nullptr);
@@ -77,6 +97,7 @@ public:
 
 		DEBUG_EXIT
 	}
+#endif
 	~Network() = default;
 
 	void MacAddressCopyTo(uint8_t *pMacAddress) {
@@ -208,6 +229,13 @@ public:
 		return net::udp_recv2(nHandle, reinterpret_cast<const uint8_t **>(ppBuffer), pFromIp, pFromPort);
 	}
 
+	/*
+	 * Datagrams dropped because the receive ring of the port was full
+	 */
+	uint32_t GetRecvOverruns(int32_t nHandle) {
+		return net::udp_get_overruns(nHandle);
+	}
+
 	void SendTo(int32_t nHandle, const void *pBuffer, uint32_t nLength, uint32_t to_ip, uint16_t remote_port) {
 		if (__builtin_expect((GetIp() != 0), 1)) { //FIXME
 			net::udp_send(nHandle, reinterpret_cast<const uint8_t *>(pBuffer), nLength, to_ip, remote_port);
@@ -218,6 +246,16 @@ public:
 		net::udp_send_timestamp(nHandle, reinterpret_cast<const uint8_t *>(pBuffer), nLength, to_ip, remote_port);
 	}
 
+	/*
+	 * There is no system call to save, the datagram is sent immediately
+	 */
+
+	void SendToQueue(int32_t nHandle, const void *pBuffer, uint32_t nLength, uint32_t to_ip, uint16_t remote_port) {
+		SendTo(nHandle, pBuffer, nLength, to_ip, remote_port);
+	}
+
+	void SendToQueueFlush() {}
+
 	/*
 	 * IGMP
 	 */
@@ -243,6 +281,10 @@ public:
 	}
 
 	void Run() {
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+		// The datagram returned by RecvFrom() is valid until here
+		net::udp_release();
+#endif
 		uint8_t *pEthernetBuffer;
 		const auto nLength = emac_eth_recv(&pEthernetBuffer);
 
@@ -263,6 +305,28 @@ public:
 #endif
 	}
 
+#if defined (CONFIG_NETWORK_USE_TAP)
+	void Print() {
+		printf("Network\n");
+		printf(" Hostname  : %s\n", GetHostName());
+		printf(" Domain    : %s\n", GetDomainName());
+		printf(" If        : %u: %s\n", GetIfIndex(), GetIfName());
+		printf(" Inet      : " IPSTR "/%u\n", IP2STR(GetIp()), GetNetmaskCIDR());
+		printf(" Netmask   : " IPSTR "\n", IP2STR(GetNetmask()));
+		printf(" Gateway   : " IPSTR "\n", IP2STR(GetGatewayIp()));
+		printf(" Broadcast : " IPSTR "\n", IP2STR(GetBroadcastIp()));
+		printf(" Mac       : " MACSTR "\n", MAC2STR(net::netif_hwaddr()));
+		printf(" Mode      : %c\n", GetAddressingMode());
+	}
+
+	/*
+	 * Blocks until a frame is received or nTimeoutMillis has elapsed.
+	 */
+	void Wait(uint32_t nTimeoutMillis) {
+		emac_tap_wait(nTimeoutMillis);
+	}
+#endif
+
 	static Network *Get() {
 		return s_pThis;
 	}
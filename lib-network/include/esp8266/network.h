@@ -98,6 +98,11 @@ public:
 	uint32_t RecvFrom(int32_t nHandle, const void **ppBuffer, uint32_t *pFromIp, uint16_t *pFromPort);
 	void SendTo(int32_t nHandle, const void *pBuffer, uint32_t nLength, uint32_t nToIp, uint16_t nRemotePort) ;
 
+	void SendToQueue(int32_t nHandle, const void *pBuffer, uint32_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+		SendTo(nHandle, pBuffer, nLength, nToIp, nRemotePort);
+	}
+	void SendToQueueFlush() {}
+
 	void Print() {
 	}
 
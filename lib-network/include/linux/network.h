@@ -2,7 +2,7 @@
  * @file network.h
  *
  */
-/* Copyright (C) 2017-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2017-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -62,6 +62,12 @@ public:
 	uint32_t RecvFrom(int32_t nHandle, void *pBuffer, uint32_t nLength, uint32_t *pFromIp, uint16_t *pFromPort);
 	uint32_t RecvFrom(int32_t nHandle, const void **ppBuffer, uint32_t *pFromIp, uint16_t *pFromPort);
 	void SendTo(int32_t nHandle, const void *pBuffer, uint32_t nLength, uint32_t nToIp, uint16_t nRemotePort);
+	/**
+	 * The datagram is copied into the transmit queue, which is sent with
+	 * SendToQueueFlush(), when the queue is full or from Run().
+	 */
+	void SendToQueue(int32_t nHandle, const void *pBuffer, uint32_t nLength, uint32_t nToIp, uint16_t nRemotePort);
+	void SendToQueueFlush();
 
 	void SetIp(uint32_t nIp);
 	void SetNetmask(uint32_t nNetmask);
@@ -188,6 +194,11 @@ public:
 	}
 
 	void Run();
+	void Wait(uint32_t nTimeoutMillis);
+
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	uint32_t GetUdpRxDropped() const;
+#endif
 
 private:
 	uint32_t GetDefaultGateway();
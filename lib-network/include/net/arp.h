@@ -2,7 +2,7 @@
  * @file arp.h
  *
  */
-/* Copyright (C) 2024-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2024-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -44,6 +44,8 @@ void arp_send(struct t_udp *, const uint32_t, const uint32_t);
 #if defined CONFIG_NET_ENABLE_PTP
 void arp_send_timestamp(struct t_udp *, const uint32_t, const uint32_t);
 #endif
+bool arp_lookup(const uint32_t, uint8_t *);
+uint32_t arp_next_hop(const uint32_t);
 void arp_acd_probe(const ip4_addr_t ipaddr);
 void arp_acd_send_announcement(const ip4_addr_t ipaddr);
 }  // namespace net
@@ -0,0 +1,32 @@
+/**
+ * @file hash.h
+ *
+ */
+
+#ifndef NET_HASH_H_
+#define NET_HASH_H_
+
+#include <cstdint>
+
+namespace net {
+/**
+ * The smallest power of 2 not less than nEntries, the size of a hash table.
+ */
+constexpr uint32_t hash_size(const uint32_t nEntries) {
+	uint32_t n = 1;
+	while (n < nEntries) {
+		n <<= 1;
+	}
+	return n;
+}
+
+/**
+ * Fibonacci hashing, the high bits of the product are the best mixed.
+ * nMask is the table size minus 1, the table size is at most 2^16.
+ */
+constexpr uint32_t hash_fibonacci(const uint32_t nKey, const uint32_t nMask) {
+	return ((nKey * 0x9E3779B1U) >> 16) & nMask;
+}
+}  // namespace net
+
+#endif /* NET_HASH_H_ */
@@ -39,8 +39,8 @@ bool igmp_lookup_group(const uint32_t);
 #if defined (CONFIG_EMAC_HASH_MULTICAST_FILTER)
 void emac_multicast_enable_hash_filter();
 void emac_multicast_disable_hash_filter();
-void emac_multicast_set_hash(const uint8_t *);
-void emac_multicast_reset_hash();
+uint32_t emac_multicast_hash_index(const uint8_t *);
+void emac_multicast_set_hash(const uint32_t *);	///< 64 bins, [0] is bin 0-31 and [1] is bin 32-63
 #endif
 
 #endif /* NET_IGMP_H_ */
@@ -2,7 +2,7 @@
  * @file tcp.h
  *
  */
-/* Copyright (C) 2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2025-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -35,7 +35,11 @@ void tcp_shutdown();
 
 int32_t tcp_begin(const uint16_t, TcpCallbackFunctionPtr callback);
 int32_t tcp_end(const int32_t);
-void tcp_write(const int32_t, const uint8_t *, uint32_t, const uint32_t);
+/**
+ * The data is not copied. The buffer must stay valid until the data is sent.
+ * Returns false when the data is not queued, the transmit queue is full.
+ */
+[[nodiscard]] bool tcp_write(const int32_t, const uint8_t *, uint32_t, const uint32_t);
 void tcp_abort(const int32_t, const uint32_t);
 }  // namespace net
 
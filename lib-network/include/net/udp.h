@@ -2,7 +2,7 @@
  * @file udp.h
  *
  */
-/* Copyright (C) 2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2025-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -37,6 +37,10 @@ uint32_t udp_recv1(const int32_t, uint8_t *, uint32_t, uint32_t *, uint16_t *);
 uint32_t udp_recv2(const int32_t, const uint8_t **, uint32_t *, uint16_t *);
 void udp_send(int32_t, const uint8_t *, uint32_t, uint32_t, uint16_t);
 void udp_send_timestamp(int32_t, const uint8_t *, uint32_t, uint32_t, uint16_t);
+uint32_t udp_get_overruns(const int32_t);
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+void udp_release();
+#endif
 }  // namespace net
 
 #endif /* NET_UDP_H_ */
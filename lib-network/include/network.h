@@ -31,6 +31,8 @@
 #if defined(__linux__) || defined (__APPLE__)
 # if defined (CONFIG_NETWORK_USE_MINIMUM)
 #  include "linux/minimum/network.h"
+# elif defined (CONFIG_NETWORK_USE_TAP)
+#  include "emac/network.h"
 # else
 #  include "linux/network.h"
 # endif
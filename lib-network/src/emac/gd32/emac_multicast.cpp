@@ -2,7 +2,7 @@
  * @file emac_multicast.cpp
  *
  */
-/* Copyright (C) 2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2025-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -32,6 +32,7 @@
 
 #include "gd32.h"
 #include "gd32_enet.h"
+#include "enet_hash.h"
 #include "net/ip4_address.h"
 
 #include "debug.h"
@@ -56,22 +57,16 @@ void emac_multicast_disable_hash_filter() {
 	DEBUG_EXIT
 }
 
-void emac_multicast_set_hash(const uint8_t *mac_addr) {
-	DEBUG_ENTRY
-
+uint32_t emac_multicast_hash_index(const uint8_t *mac_addr) {
 	const auto crc = ethcrc(mac_addr, 6);
-	const auto hash = (crc >> 26) & 0x3F;
-
-	gd32_enet_filter_set_hash(hash);
-
-	DEBUG_PRINTF("MAC: " MACSTR " -> CRC32: 0x%08X -> Hash Index: %d", MAC2STR(mac_addr), crc, hash);
-	DEBUG_EXIT
+	return (crc >> 26) & 0x3F;
 }
 
-void emac_multicast_reset_hash() {
+void emac_multicast_set_hash(const uint32_t *pHashTable) {
 	DEBUG_ENTRY
 
-	gd32_enet_reset_hash();
+	gd32_enet_filter_set_hash_table(pHashTable[1], pHashTable[0]);
 
+	DEBUG_PRINTF("HLH: 0x%08X, HLL: 0x%08X", ENET_MAC_HLH, ENET_MAC_HLL);
 	DEBUG_EXIT
 }
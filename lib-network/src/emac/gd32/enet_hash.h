@@ -0,0 +1,25 @@
+/**
+ * enet_hash.h
+ *
+ * The multicast hash list of the GD32 ENET MAC, next to
+ * gd32_enet_filter_set_hash() and gd32_enet_reset_hash() of gd32_enet.h.
+ */
+
+#ifndef ENET_HASH_H_
+#define ENET_HASH_H_
+
+#include <cstdint>
+
+#if !defined (GD32_H_)
+# error gd32.h should be included first
+#endif
+
+/**
+ * Writes the full 64-bit hash list, bit n of the list passes hash index n.
+ */
+inline void gd32_enet_filter_set_hash_table(const uint32_t nHigh, const uint32_t nLow) {
+	ENET_MAC_HLH = nHigh;
+	ENET_MAC_HLL = nLow;
+}
+
+#endif /* ENET_HASH_H_ */
@@ -2,7 +2,7 @@
  * @file emac_multicast.cpp
  *
  */
-/* Copyright (C) 2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2025-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -64,29 +64,17 @@ void emac_multicast_disable_hash_filter() {
 	DEBUG_EXIT
 }
 
-void emac_multicast_set_hash(const uint8_t *mac_addr) {
-	DEBUG_ENTRY
-	DEBUG_PRINTF("RX_FRM_FLT: 0x%08X", H3_EMAC->RX_FRM_FLT);
-
+uint32_t emac_multicast_hash_index(const uint8_t *mac_addr) {
 	const auto crc = ethcrc(mac_addr, 6);
-	const auto hash = (crc >> 26) & 0x3F;
-
-	if (hash > 31) {
-		H3_EMAC->RX_HASH_0 |= (1U << (hash - 32));
-	} else {
-		H3_EMAC->RX_HASH_1 |= (1U << hash);
-	}
-
-	DEBUG_PRINTF("MAC: " MACSTR " -> CRC32: 0x%08X -> Hash Index: %d", MAC2STR(mac_addr), crc, hash);
-	DEBUG_PRINTF("RX_HASH_0: 0x%08X, RX_HASH_1: 0x%08X", H3_EMAC->RX_HASH_0, H3_EMAC->RX_HASH_1);
-	DEBUG_EXIT
+	return (crc >> 26) & 0x3F;
 }
 
-void emac_multicast_reset_hash() {
+void emac_multicast_set_hash(const uint32_t *pHashTable) {
 	DEBUG_ENTRY
 
-	H3_EMAC->RX_HASH_0 = 0;
-	H3_EMAC->RX_HASH_1 = 0;
+	H3_EMAC->RX_HASH_0 = pHashTable[1];
+	H3_EMAC->RX_HASH_1 = pHashTable[0];
 
+	DEBUG_PRINTF("RX_HASH_0: 0x%08X, RX_HASH_1: 0x%08X", H3_EMAC->RX_HASH_0, H3_EMAC->RX_HASH_1);
 	DEBUG_EXIT
 }
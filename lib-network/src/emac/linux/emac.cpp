@@ -0,0 +1,161 @@
+/**
+ * @file emac.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if defined (DEBUG_EMAC)
+# undef NDEBUG
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+#include "emac.h"
+#include "emac/phy.h"
+
+#include "debug.h"
+
+struct tap_region tap_region;
+
+static char s_IfName[IFNAMSIZ] = "tap0";
+
+void emac_tap_set_ifname(const char *pIfName) {
+	strncpy(s_IfName, pIfName, IFNAMSIZ - 1);
+	s_IfName[IFNAMSIZ - 1] = '\0';
+}
+
+void emac_adjust_link(const net::PhyStatus phyStatus) {
+	DEBUG_ENTRY
+
+	printf("Link %s, %d, %s\n",
+			phyStatus.link == net::Link::STATE_UP ? "Up" : "Down",
+			phyStatus.speed == net::Speed::SPEED10 ? 10 : 100,
+			phyStatus.duplex == net::Duplex::DUPLEX_HALF ? "HALF" : "FULL");
+
+	DEBUG_EXIT
+}
+
+/*
+ * The kernel side of the TAP device has its own MAC address.
+ * Use it as a base for a locally administered address of our own.
+ */
+static void mac_address_get(uint8_t paddr[]) {
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(ifr));
+	memcpy(ifr.ifr_name, s_IfName, IFNAMSIZ - 1);
+
+	if (ioctl(tap_region.fd, SIOCGIFHWADDR, &ifr) < 0) {
+		perror("ioctl(SIOCGIFHWADDR)");
+		exit(EXIT_FAILURE);
+	}
+
+	memcpy(paddr, ifr.ifr_hwaddr.sa_data, 6);
+
+	paddr[0] = static_cast<uint8_t>((paddr[0] & 0xFE) | 0x02);
+	paddr[5] ^= 0x01;
+}
+
+void __attribute__((cold)) emac_config() {
+	DEBUG_ENTRY
+
+	if ((tap_region.fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK)) < 0) {
+		perror("open(/dev/net/tun)");
+		exit(EXIT_FAILURE);
+	}
+
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+	memcpy(ifr.ifr_name, s_IfName, IFNAMSIZ - 1);
+
+	if (ioctl(tap_region.fd, TUNSETIFF, &ifr) < 0) {
+		perror("ioctl(TUNSETIFF)");
+		exit(EXIT_FAILURE);
+	}
+
+	memcpy(s_IfName, ifr.ifr_name, IFNAMSIZ);
+
+	/* Bring the kernel side of the link up */
+	const auto nSocket = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (nSocket < 0) {
+		perror("socket");
+		exit(EXIT_FAILURE);
+	}
+
+	if (ioctl(nSocket, SIOCGIFFLAGS, &ifr) == 0) {
+		ifr.ifr_flags |= IFF_UP;
+		if (ioctl(nSocket, SIOCSIFFLAGS, &ifr) < 0) {
+			perror("ioctl(SIOCSIFFLAGS)");
+		}
+	}
+
+	close(nSocket);
+
+	printf("TAP: %s\n", s_IfName);
+
+	net::phy_config(PHY_ADDRESS);
+
+	DEBUG_EXIT
+}
+
+void __attribute__((cold)) emac_start(uint8_t macAddress[], net::Link& link) {
+	DEBUG_ENTRY
+
+	mac_address_get(macAddress);
+
+	net::PhyStatus phyStatus;
+
+	phyStatus.duplex = net::Duplex::DUPLEX_HALF;
+	phyStatus.speed = net::Speed::SPEED10;
+
+	net::phy_start(PHY_ADDRESS, phyStatus);
+
+	link = phyStatus.link;
+
+	emac_adjust_link(phyStatus);
+
+	tap_region.rx_length = 0;
+
+	DEBUG_EXIT
+}
+
+void __attribute__((cold)) emac_shutdown() {
+	DEBUG_ENTRY
+
+	if (tap_region.fd >= 0) {
+		close(tap_region.fd);
+		tap_region.fd = -1;
+	}
+
+	DEBUG_EXIT
+}
@@ -0,0 +1,56 @@
+/**
+ * @file emac.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LINUX_EMAC_H_
+#define LINUX_EMAC_H_
+
+#include <cstdint>
+
+/*
+ * The EMAC is emulated with a Linux TAP device.
+ * Each read() returns one Ethernet frame, each write() sends one.
+ */
+
+#define CONFIG_ETH_BUFSIZE		2048
+#define CONFIG_ETH_RXSIZE		2044
+
+#if !defined(PHY_ADDRESS)
+# define PHY_ADDRESS	1
+#endif
+
+struct tap_region {
+	uint8_t rxbuffer[CONFIG_ETH_BUFSIZE] __attribute__((aligned(8)));
+	uint8_t txbuffer[CONFIG_ETH_BUFSIZE] __attribute__((aligned(8)));
+	uint32_t rx_length;
+	uint32_t hash_table[2];
+	int fd;
+	bool hash_filter;
+};
+
+extern struct tap_region tap_region;
+
+bool emac_multicast_hash_match(const uint8_t *pFrame);
+
+#endif /* LINUX_EMAC_H_ */
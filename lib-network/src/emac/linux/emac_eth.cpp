@@ -0,0 +1,104 @@
+/**
+ * @file emac_eth.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if defined (DEBUG_EMAC)
+# undef NDEBUG
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+
+#include "emac.h"
+
+#include "debug.h"
+
+/*
+ * The frame returned stays valid until emac_free_pkt(), like an RX descriptor.
+ */
+__attribute__((hot)) uint32_t emac_eth_recv(uint8_t **packetp) {
+	if (tap_region.rx_length == 0) {
+		const auto nBytes = read(tap_region.fd, tap_region.rxbuffer, CONFIG_ETH_RXSIZE);
+
+		if (nBytes <= 0) {
+			if (1 && (nBytes < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+				perror("read");
+			}
+			return 0;
+		}
+
+		if (!emac_multicast_hash_match(tap_region.rxbuffer)) {
+			return 0;
+		}
+
+		tap_region.rx_length = static_cast<uint32_t>(nBytes);
+	}
+
+	*packetp = tap_region.rxbuffer;
+#ifdef DEBUG_DUMP
+	debug_dump(reinterpret_cast<void *>(*packetp), static_cast<uint16_t>(tap_region.rx_length));
+#endif
+	return tap_region.rx_length;
+}
+
+void emac_free_pkt() {
+	tap_region.rx_length = 0;
+}
+
+uint8_t *emac_eth_send_get_dma_buffer() {
+	return tap_region.txbuffer;
+}
+
+void emac_eth_send(const uint32_t nLength) {
+	if (write(tap_region.fd, tap_region.txbuffer, nLength) < 0) {
+		perror("write");
+	}
+}
+
+void emac_eth_send(void *pBuffer, const uint32_t nLength) {
+#ifdef DEBUG_DUMP
+	debug_dump(pBuffer, nLength);
+#endif
+	if (write(tap_region.fd, pBuffer, nLength) < 0) {
+		perror("write");
+	}
+}
+
+void emac_tap_wait(uint32_t nTimeoutMillis) {
+	if (tap_region.rx_length != 0) {
+		return;
+	}
+
+	struct pollfd pfd;
+	pfd.fd = tap_region.fd;
+	pfd.events = POLLIN;
+
+	if (1 && (poll(&pfd, 1, static_cast<int>(nTimeoutMillis)) < 0) && (errno != EINTR)) {
+		perror("poll");
+	}
+}
@@ -0,0 +1,69 @@
+/**
+ * @file emac_multicast.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstddef>
+
+#include "emac.h"
+
+uint32_t ethcrc(const uint8_t *data, const size_t length);
+
+/*
+ * A TAP device passes all frames, the multicast hash filter is done here
+ * so that the frames dropped are the same as with the hardware filter.
+ */
+
+void emac_multicast_enable_hash_filter() {
+	tap_region.hash_table[0] = 0;
+	tap_region.hash_table[1] = 0;
+	tap_region.hash_filter = true;
+}
+
+void emac_multicast_disable_hash_filter() {
+	tap_region.hash_filter = false;
+}
+
+uint32_t emac_multicast_hash_index(const uint8_t *mac_addr) {
+	const auto crc = ethcrc(mac_addr, 6);
+	return (crc >> 26) & 0x3F;
+}
+
+void emac_multicast_set_hash(const uint32_t *pHashTable) {
+	tap_region.hash_table[0] = pHashTable[0];
+	tap_region.hash_table[1] = pHashTable[1];
+}
+
+bool emac_multicast_hash_match(const uint8_t *pFrame) {
+	if (!tap_region.hash_filter || ((pFrame[0] & 0x01) == 0)) {
+		return true;
+	}
+
+	if ((pFrame[0] & pFrame[1] & pFrame[2] & pFrame[3] & pFrame[4] & pFrame[5]) == 0xFF) {
+		return true;
+	}
+
+	const auto nIndex = emac_multicast_hash_index(pFrame);
+	return (tap_region.hash_table[nIndex >> 5] & (1U << (nIndex & 0x1F))) != 0;
+}
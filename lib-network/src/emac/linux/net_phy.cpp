@@ -0,0 +1,84 @@
+/**
+ * @file net_phy.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+
+#include "emac/phy.h"
+#include "emac/mmi.h"
+
+#include "debug.h"
+
+/*
+ * Emulated MII registers of a 100 Mbit full duplex PHY with the link up.
+ * The generic PHY code in src/emac/phy runs unchanged on top of it.
+ */
+
+namespace net {
+static uint16_t s_Registers[32] = {
+		mmi::BMCR_AUTONEGOTIATION,
+		mmi::BMSR_LINKED_STATUS | mmi::BMSR_AUTONEGO_COMPLETE,
+		0x0000,
+		0x0000,
+		mmi::ADVERTISE_FULL,
+		mmi::LPA_100FULL | mmi::LPA_10FULL | mmi::ADVERTISE_CSMA
+};
+
+bool phy_read([[maybe_unused]] const uint32_t nAddress, const uint32_t nRegister, uint16_t& nValue) {
+	nValue = s_Registers[nRegister & 0x1F];
+	return true;
+}
+
+bool phy_write([[maybe_unused]] const uint32_t nAddress, const uint32_t nRegister, uint16_t nValue) {
+	switch (nRegister) {
+	case mmi::REG_BMCR:
+		s_Registers[mmi::REG_BMCR] = nValue & static_cast<uint16_t>(~(mmi::BMCR_RESET | mmi::BMCR_RESTART_AUTONEGOTIATION));
+		break;
+	case mmi::REG_ADVERTISE:
+		s_Registers[mmi::REG_ADVERTISE] = nValue;
+		break;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+bool phy_config([[maybe_unused]] const uint32_t nAddress) {
+	return true;
+}
+
+void phy_customized_led() {
+}
+
+void phy_customized_timing() {
+}
+
+void phy_customized_status(PhyStatus& phyStatus) {
+	phyStatus.duplex = Duplex::DUPLEX_FULL;
+	phyStatus.speed = Speed::SPEED100;
+	phyStatus.link = (s_Registers[mmi::REG_BMSR] & mmi::BMSR_LINKED_STATUS) ? Link::STATE_UP : Link::STATE_DOWN;
+	phyStatus.bAutonegotiation = true;
+}
+}  // namespace net
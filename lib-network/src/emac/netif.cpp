@@ -95,6 +95,8 @@ void netif_set_hostname(const char *pHostname) {
 		s_hostname[net::HOSTNAME_SIZE - 1] = '\0';
 	}
 
+	net::globals::netif_default.hostname = s_hostname;
+
 	network_store_save_hostname(s_hostname, static_cast<uint32_t>(strlen(s_hostname)));
 
 #if !defined(CONFIG_NET_APPS_NO_MDNS)
@@ -102,8 +104,6 @@ void netif_set_hostname(const char *pHostname) {
 #endif
 	network_display_hostname();
 
-	net::globals::netif_default.hostname = s_hostname;
-
 	DEBUG_EXIT
 }
 }  // namespace net
@@ -0,0 +1,564 @@
+/**
+ * @file net_io_uring.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if defined (DEBUG_NET_IO_URING)
+# undef NDEBUG
+#endif
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "net_io_uring.h"
+
+#include "../../../config/net_config.h"
+
+#include "debug.h"
+
+static_assert((UDP_IO_URING_BUFFERS & (UDP_IO_URING_BUFFERS - 1)) == 0, "UDP_IO_URING_BUFFERS must be a power of 2");
+static_assert((UDP_TX_QUEUE_SIZE & (UDP_TX_QUEUE_SIZE - 1)) == 0, "UDP_TX_QUEUE_SIZE must be a power of 2");
+
+namespace net::uring {
+static constexpr uint32_t RING_ENTRIES = 256;
+static constexpr uint32_t BUFFER_SIZE = 2048;
+static constexpr uint32_t BUFFERS_MASK = UDP_IO_URING_BUFFERS - 1;
+static constexpr uint32_t SEGMENT_SIZE = 1472;	// Max UDP payload in a 1500 bytes Ethernet frame
+
+namespace userdata {
+static constexpr uint64_t SEND = (1ULL << 32);
+static constexpr uint64_t CANCEL = (1ULL << 33);
+}  // namespace userdata
+
+struct Completion {
+	uint16_t nBufferId;
+	uint16_t nLength;
+};
+
+struct Port {
+	struct io_uring_buf_ring *pBufRing;
+	uint8_t *pBuffers;
+	struct msghdr msg;
+	Completion completions[UDP_IO_URING_BUFFERS];
+	uint32_t nHead;
+	uint32_t nTail;
+	int nSocket;
+	uint16_t nBufRingTail;
+	bool bArmed;
+	bool bHoldsBuffer;
+};
+
+struct TxSlot {
+	uint8_t data[SEGMENT_SIZE];
+	struct sockaddr_in to;
+	struct iovec iov;
+	struct msghdr msg;
+};
+
+struct Ring {
+	int nFd;
+	uint32_t *pSqHead;
+	uint32_t *pSqTail;
+	uint32_t nSqMask;
+	uint32_t *pSqArray;
+	struct io_uring_sqe *pSqes;
+	uint32_t *pCqHead;
+	uint32_t *pCqTail;
+	uint32_t nCqMask;
+	struct io_uring_cqe *pCqes;
+	void *pSqRing;
+	void *pCqRing;
+	size_t nSqRingSize;
+	size_t nCqRingSize;
+	uint32_t nToSubmit;
+};
+
+static Ring s_Ring;
+static Port *s_pPorts[UDP_MAX_PORTS_ALLOWED];
+
+static TxSlot s_TxSlots[UDP_TX_QUEUE_SIZE];
+static uint32_t s_TxFree[UDP_TX_QUEUE_SIZE];
+static uint32_t s_nTxFreeCount;
+
+static int sys_io_uring_setup(uint32_t nEntries, struct io_uring_params *pParams) {
+	return static_cast<int>(syscall(__NR_io_uring_setup, nEntries, pParams));
+}
+
+static int sys_io_uring_enter(int nFd, uint32_t nToSubmit, uint32_t nMinComplete, uint32_t nFlags) {
+	return static_cast<int>(syscall(__NR_io_uring_enter, nFd, nToSubmit, nMinComplete, nFlags, nullptr, 0));
+}
+
+static int sys_io_uring_register(int nFd, uint32_t nOpcode, void *pArg, uint32_t nArgs) {
+	return static_cast<int>(syscall(__NR_io_uring_register, nFd, nOpcode, pArg, nArgs));
+}
+
+static void submit(uint32_t nMinComplete = 0) {
+	const auto nFlags = (nMinComplete != 0) ? IORING_ENTER_GETEVENTS : 0;
+
+	while ((s_Ring.nToSubmit != 0) || (nMinComplete != 0)) {
+		const auto nResult = sys_io_uring_enter(s_Ring.nFd, s_Ring.nToSubmit, nMinComplete, nFlags);
+
+		if (nResult == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("io_uring_enter");
+			return;
+		}
+
+		s_Ring.nToSubmit -= static_cast<uint32_t>(nResult);
+		nMinComplete = 0;
+	}
+}
+
+static struct io_uring_sqe *sqe_get() {
+	auto nTail = *s_Ring.pSqTail;
+
+	if ((nTail - __atomic_load_n(s_Ring.pSqHead, __ATOMIC_ACQUIRE)) == (s_Ring.nSqMask + 1)) {
+		submit();
+	}
+
+	const auto nIndex = nTail & s_Ring.nSqMask;
+	auto *pSqe = &s_Ring.pSqes[nIndex];
+
+	memset(pSqe, 0, sizeof(struct io_uring_sqe));
+	s_Ring.pSqArray[nIndex] = nIndex;
+
+	__atomic_store_n(s_Ring.pSqTail, nTail + 1, __ATOMIC_RELEASE);
+	s_Ring.nToSubmit++;
+
+	return pSqe;
+}
+
+/*
+ * In C++ the __DECLARE_FLEX_ARRAY of io_uring_buf_ring::bufs has a non-zero offset,
+ * the ring is an array of io_uring_buf with the tail overlaid on bufs[0].resv
+ */
+static void buffer_add(Port *pPort, uint16_t nBufferId) {
+	auto *pBuf = &reinterpret_cast<struct io_uring_buf *>(pPort->pBufRing)[pPort->nBufRingTail & BUFFERS_MASK];
+
+	pBuf->addr = reinterpret_cast<uint64_t>(&pPort->pBuffers[nBufferId * BUFFER_SIZE]);
+	pBuf->len = BUFFER_SIZE;
+	pBuf->bid = nBufferId;
+
+	pPort->nBufRingTail++;
+	__atomic_store_n(&pPort->pBufRing->tail, pPort->nBufRingTail, __ATOMIC_RELEASE);
+}
+
+static void recv_arm(uint32_t nPortIndex) {
+	auto *pPort = s_pPorts[nPortIndex];
+	auto *pSqe = sqe_get();
+
+	pSqe->opcode = IORING_OP_RECVMSG;
+	pSqe->fd = pPort->nSocket;
+	pSqe->addr = reinterpret_cast<uint64_t>(&pPort->msg);
+	pSqe->len = 0;
+	pSqe->ioprio = IORING_RECV_MULTISHOT;
+	pSqe->flags = IOSQE_BUFFER_SELECT;
+	pSqe->buf_group = static_cast<uint16_t>(nPortIndex);
+	pSqe->user_data = nPortIndex;
+
+	pPort->bArmed = true;
+
+	submit();
+}
+
+static void reap() {
+	auto nHead = *s_Ring.pCqHead;
+	const auto nTail = __atomic_load_n(s_Ring.pCqTail, __ATOMIC_ACQUIRE);
+
+	while (nHead != nTail) {
+		const auto *pCqe = &s_Ring.pCqes[nHead & s_Ring.nCqMask];
+		const auto nUserData = pCqe->user_data;
+
+		if (nUserData < UDP_MAX_PORTS_ALLOWED) {
+			auto *pPort = s_pPorts[nUserData];
+			assert(pPort != nullptr);
+
+			if (pCqe->flags & IORING_CQE_F_BUFFER) {
+				const auto nBufferId = static_cast<uint16_t>(pCqe->flags >> IORING_CQE_BUFFER_SHIFT);
+
+				if (pCqe->res > 0) {
+					auto& completion = pPort->completions[pPort->nHead++ & BUFFERS_MASK];
+					completion.nBufferId = nBufferId;
+					completion.nLength = static_cast<uint16_t>(pCqe->res);
+				} else {
+					buffer_add(pPort, nBufferId);
+				}
+			}
+
+			if (!(pCqe->flags & IORING_CQE_F_MORE)) {
+				// -ENOBUFS: all buffers are in use, re-armed by recv_release()
+				pPort->bArmed = false;
+				if ((pCqe->res < 0) && (pCqe->res != -ENOBUFS) && (pCqe->res != -ECANCELED)) {
+					fprintf(stderr, "io_uring recvmsg: %s\n", strerror(-pCqe->res));
+				}
+			}
+		} else if (nUserData & userdata::SEND) {
+			if (pCqe->res < 0) {
+				fprintf(stderr, "io_uring sendmsg: %s\n", strerror(-pCqe->res));
+			}
+			s_TxFree[s_nTxFreeCount++] = static_cast<uint32_t>(nUserData & 0xFFFFFFFF);
+		}
+
+		nHead++;
+	}
+
+	__atomic_store_n(s_Ring.pCqHead, nHead, __ATOMIC_RELEASE);
+}
+
+void init() {
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	if ((s_Ring.nFd = sys_io_uring_setup(RING_ENTRIES, &params)) == -1) {
+		perror("io_uring_setup");
+		exit(EXIT_FAILURE);
+	}
+
+	s_Ring.nSqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	s_Ring.nCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (s_Ring.nCqRingSize > s_Ring.nSqRingSize) {
+			s_Ring.nSqRingSize = s_Ring.nCqRingSize;
+		}
+		s_Ring.nCqRingSize = s_Ring.nSqRingSize;
+	}
+
+	s_Ring.pSqRing = mmap(nullptr, s_Ring.nSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, s_Ring.nFd, IORING_OFF_SQ_RING);
+
+	if (s_Ring.pSqRing == MAP_FAILED) {
+		perror("mmap(IORING_OFF_SQ_RING)");
+		exit(EXIT_FAILURE);
+	}
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		s_Ring.pCqRing = s_Ring.pSqRing;
+	} else {
+		s_Ring.pCqRing = mmap(nullptr, s_Ring.nCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, s_Ring.nFd, IORING_OFF_CQ_RING);
+
+		if (s_Ring.pCqRing == MAP_FAILED) {
+			perror("mmap(IORING_OFF_CQ_RING)");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	auto *pSqes = mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, s_Ring.nFd, IORING_OFF_SQES);
+
+	if (pSqes == MAP_FAILED) {
+		perror("mmap(IORING_OFF_SQES)");
+		exit(EXIT_FAILURE);
+	}
+
+	auto *pSq = static_cast<uint8_t *>(s_Ring.pSqRing);
+	auto *pCq = static_cast<uint8_t *>(s_Ring.pCqRing);
+
+	s_Ring.pSqHead = reinterpret_cast<uint32_t *>(pSq + params.sq_off.head);
+	s_Ring.pSqTail = reinterpret_cast<uint32_t *>(pSq + params.sq_off.tail);
+	s_Ring.nSqMask = *reinterpret_cast<uint32_t *>(pSq + params.sq_off.ring_mask);
+	s_Ring.pSqArray = reinterpret_cast<uint32_t *>(pSq + params.sq_off.array);
+	s_Ring.pSqes = static_cast<struct io_uring_sqe *>(pSqes);
+	s_Ring.pCqHead = reinterpret_cast<uint32_t *>(pCq + params.cq_off.head);
+	s_Ring.pCqTail = reinterpret_cast<uint32_t *>(pCq + params.cq_off.tail);
+	s_Ring.nCqMask = *reinterpret_cast<uint32_t *>(pCq + params.cq_off.ring_mask);
+	s_Ring.pCqes = reinterpret_cast<struct io_uring_cqe *>(pCq + params.cq_off.cqes);
+	s_Ring.nToSubmit = 0;
+
+	for (uint32_t i = 0; i < UDP_TX_QUEUE_SIZE; i++) {
+		auto& slot = s_TxSlots[i];
+
+		slot.iov.iov_base = slot.data;
+		memset(&slot.msg, 0, sizeof(slot.msg));
+		slot.msg.msg_name = &slot.to;
+		slot.msg.msg_namelen = sizeof(struct sockaddr_in);
+		slot.msg.msg_iov = &slot.iov;
+		slot.msg.msg_iovlen = 1;
+
+		s_TxFree[i] = i;
+	}
+
+	s_nTxFreeCount = UDP_TX_QUEUE_SIZE;
+
+	DEBUG_PRINTF("nFd=%d, sq_entries=%u, cq_entries=%u", s_Ring.nFd, params.sq_entries, params.cq_entries);
+}
+
+void shutdown() {
+	for (uint32_t i = 0; i < UDP_MAX_PORTS_ALLOWED; i++) {
+		if (s_pPorts[i] != nullptr) {
+			recv_end(i);
+		}
+	}
+
+	send_flush();
+
+	munmap(s_Ring.pSqes, (s_Ring.nSqMask + 1) * sizeof(struct io_uring_sqe));
+	if (s_Ring.pCqRing != s_Ring.pSqRing) {
+		munmap(s_Ring.pCqRing, s_Ring.nCqRingSize);
+	}
+	munmap(s_Ring.pSqRing, s_Ring.nSqRingSize);
+
+	close(s_Ring.nFd);
+	s_Ring.nFd = -1;
+}
+
+int get_fd() {
+	return s_Ring.nFd;
+}
+
+void recv_begin(uint32_t nPortIndex, int nSocket) {
+	DEBUG_ENTRY
+	assert(nPortIndex < UDP_MAX_PORTS_ALLOWED);
+	assert(s_pPorts[nPortIndex] == nullptr);
+
+	auto *pPort = new Port;
+	assert(pPort != nullptr);
+
+	const auto nBufRingSize = UDP_IO_URING_BUFFERS * sizeof(struct io_uring_buf);
+	auto *pBufRing = mmap(nullptr, nBufRingSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+	if (pBufRing == MAP_FAILED) {
+		perror("mmap(io_uring_buf_ring)");
+		exit(EXIT_FAILURE);
+	}
+
+	pPort->pBufRing = static_cast<struct io_uring_buf_ring *>(pBufRing);
+	pPort->pBuffers = new uint8_t[UDP_IO_URING_BUFFERS * BUFFER_SIZE];
+	assert(pPort->pBuffers != nullptr);
+
+	struct io_uring_buf_reg reg;
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = reinterpret_cast<uint64_t>(pBufRing);
+	reg.ring_entries = UDP_IO_URING_BUFFERS;
+	reg.bgid = static_cast<uint16_t>(nPortIndex);
+
+	if (sys_io_uring_register(s_Ring.nFd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+		perror("io_uring_register(IORING_REGISTER_PBUF_RING)");
+		exit(EXIT_FAILURE);
+	}
+
+	pPort->nBufRingTail = 0;
+
+	for (uint32_t i = 0; i < UDP_IO_URING_BUFFERS; i++) {
+		buffer_add(pPort, static_cast<uint16_t>(i));
+	}
+
+	// With buffer select the kernel fills in the io_uring_recvmsg_out header, followed by the name and the payload
+	memset(&pPort->msg, 0, sizeof(pPort->msg));
+	pPort->msg.msg_namelen = sizeof(struct sockaddr_in);
+
+	pPort->nHead = 0;
+	pPort->nTail = 0;
+	pPort->nSocket = nSocket;
+	pPort->bArmed = false;
+	pPort->bHoldsBuffer = false;
+
+	s_pPorts[nPortIndex] = pPort;
+
+	recv_arm(nPortIndex);
+
+	DEBUG_EXIT
+}
+
+void recv_end(uint32_t nPortIndex) {
+	DEBUG_ENTRY
+	assert(nPortIndex < UDP_MAX_PORTS_ALLOWED);
+
+	auto *pPort = s_pPorts[nPortIndex];
+
+	if (pPort == nullptr) {
+		return;
+	}
+
+	if (pPort->bArmed) {
+		auto *pSqe = sqe_get();
+
+		pSqe->opcode = IORING_OP_ASYNC_CANCEL;
+		pSqe->addr = nPortIndex;
+		pSqe->user_data = userdata::CANCEL;
+
+		submit();
+
+		while (pPort->bArmed) {
+			submit(1);
+			reap();
+		}
+	}
+
+	struct io_uring_buf_reg reg;
+	memset(&reg, 0, sizeof(reg));
+	reg.bgid = static_cast<uint16_t>(nPortIndex);
+
+	if (sys_io_uring_register(s_Ring.nFd, IORING_UNREGISTER_PBUF_RING, &reg, 1) == -1) {
+		perror("io_uring_register(IORING_UNREGISTER_PBUF_RING)");
+	}
+
+	munmap(pPort->pBufRing, UDP_IO_URING_BUFFERS * sizeof(struct io_uring_buf));
+	delete[] pPort->pBuffers;
+	delete pPort;
+
+	s_pPorts[nPortIndex] = nullptr;
+
+	DEBUG_EXIT
+}
+
+void recv_release(uint32_t nPortIndex) {
+	auto *pPort = s_pPorts[nPortIndex];
+	assert(pPort != nullptr);
+
+	if (pPort->bHoldsBuffer) {
+		pPort->bHoldsBuffer = false;
+		buffer_add(pPort, pPort->completions[pPort->nTail++ & BUFFERS_MASK].nBufferId);
+
+		if (!pPort->bArmed) {
+			recv_arm(nPortIndex);
+		}
+	}
+}
+
+uint32_t recv(uint32_t nPortIndex, const uint8_t **ppData, uint32_t *pFromIp, uint16_t *pFromPort) {
+	recv_release(nPortIndex);
+
+	auto *pPort = s_pPorts[nPortIndex];
+	const auto nHeaderLength = sizeof(struct io_uring_recvmsg_out) + pPort->msg.msg_namelen + pPort->msg.msg_controllen;
+
+	for (;;) {
+		if (pPort->nTail == pPort->nHead) {
+			reap();
+
+			if (pPort->nTail == pPort->nHead) {
+				return 0;
+			}
+		}
+
+		const auto& completion = pPort->completions[pPort->nTail & BUFFERS_MASK];
+		const auto *pBuffer = &pPort->pBuffers[completion.nBufferId * BUFFER_SIZE];
+		const auto *pOut = reinterpret_cast<const struct io_uring_recvmsg_out *>(pBuffer);
+
+		pPort->bHoldsBuffer = true;
+
+		if (__builtin_expect(((pOut->namelen < sizeof(struct sockaddr_in)) || (completion.nLength < nHeaderLength) || (pOut->flags & MSG_TRUNC)), 0)) {
+			// Not a complete datagram, it is dropped and the next completion is tried
+			fprintf(stderr, "io_uring recvmsg: invalid datagram (namelen=%u, flags=%x)\n", pOut->namelen, pOut->flags);
+			recv_release(nPortIndex);
+			continue;
+		}
+
+		const auto *pFrom = reinterpret_cast<const struct sockaddr_in *>(pBuffer + sizeof(struct io_uring_recvmsg_out));
+
+		*ppData = pBuffer + nHeaderLength;
+		*pFromIp = pFrom->sin_addr.s_addr;
+		*pFromPort = ntohs(pFrom->sin_port);
+
+		return static_cast<uint32_t>(completion.nLength - nHeaderLength);
+	}
+}
+
+bool recv_is_pending() {
+	for (const auto *pPort : s_pPorts) {
+		if (pPort != nullptr) {
+			const auto nTail = pPort->nTail + (pPort->bHoldsBuffer ? 1 : 0);
+			if (nTail != pPort->nHead) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void send_queue(int nSocket, const void *pData, uint32_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+	// Does not fit in a slot, sent synchronously after the queued datagrams
+	if (__builtin_expect((nLength > SEGMENT_SIZE), 0)) {
+		send_drain();
+
+		struct sockaddr_in to;
+		to.sin_family = AF_INET;
+		to.sin_addr.s_addr = nToIp;
+		to.sin_port = htons(nRemotePort);
+
+		if (sendto(nSocket, pData, nLength, 0, reinterpret_cast<struct sockaddr *>(&to), sizeof(to)) == -1) {
+			perror("sendto");
+		}
+
+		return;
+	}
+
+	if (s_nTxFreeCount == 0) {
+		reap();
+
+		while (s_nTxFreeCount == 0) {
+			submit(1);
+			reap();
+		}
+	}
+
+	const auto nSlot = s_TxFree[--s_nTxFreeCount];
+	auto& slot = s_TxSlots[nSlot];
+
+	memcpy(slot.data, pData, nLength);
+	slot.iov.iov_len = nLength;
+	slot.to.sin_family = AF_INET;
+	slot.to.sin_addr.s_addr = nToIp;
+	slot.to.sin_port = htons(nRemotePort);
+
+	auto *pSqe = sqe_get();
+
+	pSqe->opcode = IORING_OP_SENDMSG;
+	pSqe->fd = nSocket;
+	pSqe->addr = reinterpret_cast<uint64_t>(&slot.msg);
+	pSqe->len = 1;
+	pSqe->user_data = userdata::SEND | nSlot;
+}
+
+/**
+ * All queued datagrams are submitted with a single io_uring_enter().
+ */
+void send_flush() {
+	submit();
+}
+
+/**
+ * Submits the queued datagrams and waits until all sends have completed,
+ * so a following synchronous sendto() cannot overtake them.
+ */
+void send_drain() {
+	submit();
+	reap();
+
+	while (s_nTxFreeCount != UDP_TX_QUEUE_SIZE) {
+		submit(1);
+		reap();
+	}
+}
+}  // namespace net::uring
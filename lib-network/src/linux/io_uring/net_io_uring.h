@@ -0,0 +1,55 @@
+/**
+ * @file net_io_uring.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LINUX_IO_URING_NET_IO_URING_H_
+#define LINUX_IO_URING_NET_IO_URING_H_
+
+#include <cstdint>
+
+/*
+ * io_uring backend for the Linux UDP sockets.
+ * Each port has a multishot recvmsg armed, receiving into its own ring of
+ * provided buffers. The datagrams are handed out without copying.
+ */
+namespace net::uring {
+void init();
+void shutdown();
+int get_fd();
+
+void recv_begin(uint32_t nPortIndex, int nSocket);
+void recv_end(uint32_t nPortIndex);
+/**
+ * The buffer stays valid until the next recv() or recv_release() for this port.
+ */
+uint32_t recv(uint32_t nPortIndex, const uint8_t **ppData, uint32_t *pFromIp, uint16_t *pFromPort);
+void recv_release(uint32_t nPortIndex);
+bool recv_is_pending();
+
+void send_queue(int nSocket, const void *pData, uint32_t nLength, uint32_t nToIp, uint16_t nRemotePort);
+void send_flush();
+void send_drain();
+}  // namespace net::uring
+
+#endif /* LINUX_IO_URING_NET_IO_URING_H_ */
@@ -3,7 +3,7 @@
  * @file network.cpp
  *
  */
-/* Copyright (C) 2018-2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2018-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -40,8 +40,19 @@
 #include <ifaddrs.h>
 #include <errno.h>
 #include <cassert>
+#if defined (__linux__)
+# include <sys/epoll.h>
+#endif
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+# include <atomic>
+# include <pthread.h>
+# include <sys/eventfd.h>
+#endif
 
 #include "network.h"
+#if defined (CONFIG_NETWORK_USE_IO_URING)
+# include "io_uring/net_io_uring.h"
+#endif
 #if !defined(CONFIG_NET_APPS_NO_MDNS)
 # include "net/apps/mdns.h"
 #endif
@@ -69,12 +80,329 @@ struct PortInfo {
 	uint16_t nPort;
 };
 
+#if defined (CONFIG_NETWORK_USE_IO_URING)
+# if !defined (__linux__)
+#  error CONFIG_NETWORK_USE_IO_URING is Linux only
+# endif
+# if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+#  error CONFIG_NETWORK_USE_IO_URING and CONFIG_NETWORK_UDP_RX_THREAD are mutually exclusive
+# endif
+#endif
+
+#if defined (__linux__) && (UDP_RX_BATCH_SIZE > 1) && !defined (CONFIG_NETWORK_USE_IO_URING)
+# define NETWORK_USE_RECVMMSG
+/*
+ * Received datagrams are drained with a single recvmmsg() into the slots
+ * and then handed out one by one, until the batch is consumed.
+ */
+struct Batch {
+	uint8_t data[UDP_RX_BATCH_SIZE][MAX_SEGMENT_LENGTH];
+	struct sockaddr_in from[UDP_RX_BATCH_SIZE];
+	struct iovec iov[UDP_RX_BATCH_SIZE];
+	struct mmsghdr msgs[UDP_RX_BATCH_SIZE];
+	uint32_t nHead;
+	uint32_t nCount;
+};
+#endif
+
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+# if !defined (__linux__)
+#  error CONFIG_NETWORK_UDP_RX_THREAD is Linux only
+# endif
+static_assert((UDP_RX_QUEUE_SIZE & (UDP_RX_QUEUE_SIZE - 1)) == 0, "UDP_RX_QUEUE_SIZE must be a power of 2");
+/*
+ * A polled port (no callback) gets its own receive thread. The thread is the
+ * only producer and the main loop the only consumer of the lock-free queue.
+ * The eventfd wakes up Network::Wait() when a datagram is queued while the
+ * main loop is about to sleep (bWaiting). Both sides store, fence and then
+ * load, so either the thread sees bWaiting or Wait() sees the new nHead.
+ */
+namespace rxthread {
+static constexpr uint32_t QUEUE_MASK = UDP_RX_QUEUE_SIZE - 1;
+
+struct Slot {
+	uint8_t data[MAX_SEGMENT_LENGTH];
+	uint32_t nLength;
+	uint32_t nFromIp;
+	uint16_t nFromPort;
+};
+
+struct RxThread {
+	Slot slots[UDP_RX_QUEUE_SIZE];
+	alignas(64) std::atomic<uint32_t> nHead;	// Written by the receive thread only
+	alignas(64) std::atomic<uint32_t> nTail;	// Written by the main loop only
+	std::atomic<uint32_t> nDropped;	// Datagrams discarded because the queue was full
+	std::atomic<bool> bRunning;
+	std::atomic<bool> bWaiting;
+	bool bHoldsSlot;	// The main loop still uses the slot at nTail
+	int nSocket;
+	int nEventFd;
+	pthread_t thread;
+};
+}  // namespace rxthread
+#endif
+
 struct Port {
 	PortInfo info;
 	int nSocket;
+#if defined (NETWORK_USE_RECVMMSG)
+	Batch batch;
+#endif
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	rxthread::RxThread *pRxThread;
+#endif
 };
 
 static Port s_Ports[UDP_MAX_PORTS_ALLOWED];
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+static uint32_t s_nRxDropped;	// Of the receive threads that have stopped
+#endif
+
+#if defined (__linux__) && (UDP_TX_QUEUE_SIZE > 1) && !defined (CONFIG_NETWORK_USE_IO_URING)
+# define NETWORK_USE_SENDMMSG
+struct TxQueue {
+	uint8_t data[UDP_TX_QUEUE_SIZE][MAX_SEGMENT_LENGTH];
+	struct sockaddr_in to[UDP_TX_QUEUE_SIZE];
+	struct iovec iov[UDP_TX_QUEUE_SIZE];
+	struct mmsghdr msgs[UDP_TX_QUEUE_SIZE];
+	uint32_t nCount;
+	int32_t nHandle;
+};
+
+static TxQueue s_TxQueue;
+#endif
+
+#if defined (__linux__)
+static constexpr uint32_t WAIT_MAX_MILLIS = 100;
+static int s_nEpollFd = -1;
+
+namespace net {
+void wait_add_fd(int nFd) {
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = nFd;
+
+	if (epoll_ctl(s_nEpollFd, EPOLL_CTL_ADD, nFd, &event) == -1) {
+		perror("epoll_ctl(EPOLL_CTL_ADD)");
+	}
+}
+
+void wait_remove_fd(int nFd) {
+	if (epoll_ctl(s_nEpollFd, EPOLL_CTL_DEL, nFd, nullptr) == -1) {
+		perror("epoll_ctl(EPOLL_CTL_DEL)");
+	}
+}
+}  // namespace net
+#endif
+
+#if defined (NETWORK_USE_RECVMMSG)
+static void batch_init(Batch& batch) {
+	for (uint32_t i = 0; i < UDP_RX_BATCH_SIZE; i++) {
+		batch.iov[i].iov_base = batch.data[i];
+		batch.iov[i].iov_len = MAX_SEGMENT_LENGTH;
+
+		auto& hdr = batch.msgs[i].msg_hdr;
+		memset(&hdr, 0, sizeof(hdr));
+		hdr.msg_iov = &batch.iov[i];
+		hdr.msg_iovlen = 1;
+		hdr.msg_name = &batch.from[i];
+	}
+
+	batch.nHead = 0;
+	batch.nCount = 0;
+}
+
+/**
+ * Blocks at most SO_RCVTIMEO for the first datagram (MSG_WAITFORONE),
+ * the remaining datagrams are only taken when already queued.
+ */
+static uint32_t batch_fill(Port& port) {
+	auto& batch = port.batch;
+
+	for (uint32_t i = 0; i < UDP_RX_BATCH_SIZE; i++) {
+		batch.msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+	}
+
+	batch.nHead = 0;
+
+	const auto nReceived = recvmmsg(port.nSocket, batch.msgs, UDP_RX_BATCH_SIZE, MSG_WAITFORONE, nullptr);
+
+	if (nReceived == -1) {
+		if (1 && (errno != EAGAIN) && (errno != EWOULDBLOCK)) { // EAGAIN and EWOULDBLOCK can be equal
+			DEBUG_PRINTF("nSocket=%d", port.nSocket);
+			perror("recvmmsg");
+		}
+		batch.nCount = 0;
+		return 0;
+	}
+
+	batch.nCount = static_cast<uint32_t>(nReceived);
+	return batch.nCount;
+}
+
+/**
+ * The returned slot stays valid until the next batch_fill() for this port.
+ */
+static uint32_t batch_get(Port& port, const uint8_t **ppData, uint32_t *pFromIp, uint16_t *pFromPort) {
+	auto& batch = port.batch;
+
+	if (batch.nHead == batch.nCount) {
+		if (batch_fill(port) == 0) {
+			return 0;
+		}
+	}
+
+	const auto nIndex = batch.nHead++;
+
+	*ppData = batch.data[nIndex];
+	*pFromIp = batch.from[nIndex].sin_addr.s_addr;
+	*pFromPort = ntohs(batch.from[nIndex].sin_port);
+
+	return batch.msgs[nIndex].msg_len;
+}
+
+#endif
+
+#if defined (NETWORK_USE_RECVMMSG) || defined (CONFIG_NETWORK_UDP_RX_THREAD) || defined (CONFIG_NETWORK_USE_IO_URING)
+static Port *port_get(int32_t nHandle) {
+	for (auto& port : s_Ports) {
+		if (port.nSocket == nHandle) {
+			return &port;
+		}
+	}
+
+	return nullptr;
+}
+#endif
+
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+namespace rxthread {
+static void *run(void *pArg) {
+	auto *pRxThread = static_cast<RxThread *>(pArg);
+	uint8_t discard[MAX_SEGMENT_LENGTH];
+
+	while (pRxThread->bRunning.load(std::memory_order_relaxed)) {
+		const auto nHead = pRxThread->nHead.load(std::memory_order_relaxed);
+		const auto nTail = pRxThread->nTail.load(std::memory_order_acquire);
+		const auto isFull = ((nHead - nTail) == UDP_RX_QUEUE_SIZE);
+
+		auto& slot = pRxThread->slots[nHead & QUEUE_MASK];
+		auto *pBuffer = isFull ? discard : slot.data;
+
+		struct sockaddr_in si_other;
+		socklen_t slen = sizeof(si_other);
+
+		const auto nLength = recvfrom(pRxThread->nSocket, pBuffer, MAX_SEGMENT_LENGTH, 0, reinterpret_cast<struct sockaddr*>(&si_other), &slen);
+
+		if (nLength <= 0) {
+			continue;
+		}
+
+		if (isFull) {
+			pRxThread->nDropped.store(pRxThread->nDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			continue;
+		}
+
+		slot.nLength = static_cast<uint32_t>(nLength);
+		slot.nFromIp = si_other.sin_addr.s_addr;
+		slot.nFromPort = ntohs(si_other.sin_port);
+
+		pRxThread->nHead.store(nHead + 1, std::memory_order_release);
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (pRxThread->bWaiting.exchange(false, std::memory_order_relaxed)) {
+			const uint64_t nValue = 1;
+			[[maybe_unused]] const auto nWritten = write(pRxThread->nEventFd, &nValue, sizeof(nValue));
+		}
+	}
+
+	return nullptr;
+}
+
+static RxThread *start(int nSocket) {
+	auto *pRxThread = new RxThread;
+	assert(pRxThread != nullptr);
+
+	pRxThread->nHead.store(0);
+	pRxThread->nTail.store(0);
+	pRxThread->nDropped.store(0);
+	pRxThread->bRunning.store(true);
+	pRxThread->bWaiting.store(false);
+	pRxThread->bHoldsSlot = false;
+	pRxThread->nSocket = nSocket;
+
+	if ((pRxThread->nEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) {
+		perror("eventfd");
+		exit(EXIT_FAILURE);
+	}
+
+	// The thread checks bRunning at least every 100ms
+	struct timeval recv_timeout;
+	recv_timeout.tv_sec = 0;
+	recv_timeout.tv_usec = 100000;
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_RCVTIMEO, static_cast<void*>(&recv_timeout), sizeof(recv_timeout)) == -1) {
+		perror("setsockopt(SO_RCVTIMEO)");
+		exit(EXIT_FAILURE);
+	}
+
+	if (pthread_create(&pRxThread->thread, nullptr, run, pRxThread) != 0) {
+		perror("pthread_create");
+		exit(EXIT_FAILURE);
+	}
+
+	return pRxThread;
+}
+
+static void stop(RxThread *pRxThread) {
+	pRxThread->bRunning.store(false);
+	pthread_join(pRxThread->thread, nullptr);
+	close(pRxThread->nEventFd);
+	delete pRxThread;
+}
+
+static void release(RxThread *pRxThread) {
+	if (pRxThread->bHoldsSlot) {
+		pRxThread->bHoldsSlot = false;
+		pRxThread->nTail.store(pRxThread->nTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+}
+
+/**
+ * The slot is given back to the receive thread with the next call.
+ */
+static uint32_t get(RxThread *pRxThread, const uint8_t **ppData, uint32_t *pFromIp, uint16_t *pFromPort) {
+	release(pRxThread);
+
+	const auto nTail = pRxThread->nTail.load(std::memory_order_relaxed);
+
+	if (nTail == pRxThread->nHead.load(std::memory_order_acquire)) {
+		return 0;
+	}
+
+	const auto& slot = pRxThread->slots[nTail & QUEUE_MASK];
+
+	*ppData = slot.data;
+	*pFromIp = slot.nFromIp;
+	*pFromPort = slot.nFromPort;
+
+	pRxThread->bHoldsSlot = true;
+
+	return slot.nLength;
+}
+
+static bool is_empty(const RxThread *pRxThread) {
+	const auto nTail = pRxThread->nTail.load(std::memory_order_relaxed) + (pRxThread->bHoldsSlot ? 1 : 0);
+	return nTail == pRxThread->nHead.load(std::memory_order_acquire);
+}
+
+static void set_waiting(RxThread *pRxThread, const bool bWaiting) {
+	pRxThread->bWaiting.store(bWaiting, std::memory_order_relaxed);
+}
+}  // namespace rxthread
+#endif
 
 /**
  * END
@@ -107,6 +435,17 @@ Network::Network(int argc, char **argv) {
 	NetworkParams params;
 	params.Load();
 
+#if defined (__linux__)
+	if ((s_nEpollFd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+		perror("epoll_create1");
+		exit(EXIT_FAILURE);
+	}
+#endif
+#if defined (CONFIG_NETWORK_USE_IO_URING)
+	net::uring::init();
+	net::wait_add_fd(net::uring::get_fd());
+#endif
+
 /**
  * END
  */
@@ -170,6 +509,14 @@ Network::~Network() {
 			Network::End(s_Ports[i].info.nPort);
 		}
 	}
+
+#if defined (CONFIG_NETWORK_USE_IO_URING)
+	net::uring::shutdown();
+#endif
+#if defined (__linux__)
+	close(s_nEpollFd);
+	s_nEpollFd = -1;
+#endif
 }
 
 int32_t Network::Begin(uint16_t nPort, [[maybe_unused]] net::UdpCallbackFunctionPtr callback) {
@@ -267,6 +614,21 @@ int32_t Network::Begin(uint16_t nPort, [[maybe_unused]] net::UdpCallbackFunction
  */
 
 	s_Ports[i].nSocket = nSocket;
+#if defined (NETWORK_USE_RECVMMSG)
+	batch_init(s_Ports[i].batch);
+#endif
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	if (callback == nullptr) {
+		s_Ports[i].pRxThread = rxthread::start(nSocket);
+		net::wait_add_fd(s_Ports[i].pRxThread->nEventFd);
+	} else {
+		net::wait_add_fd(nSocket);
+	}
+#elif defined (CONFIG_NETWORK_USE_IO_URING)
+	net::uring::recv_begin(static_cast<uint32_t>(i), nSocket);
+#elif defined (__linux__)
+	net::wait_add_fd(nSocket);
+#endif
 
 	DEBUG_PRINTF("nSocket=%d", nSocket);
 	DEBUG_EXIT
@@ -297,7 +659,25 @@ int32_t Network::End(uint16_t nPort) {
 			portInfo.callback = nullptr;
 			portInfo.nPort = 0;
 
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+			if (s_Ports[i].pRxThread != nullptr) {
+				s_nRxDropped += s_Ports[i].pRxThread->nDropped.load(std::memory_order_relaxed);
+				net::wait_remove_fd(s_Ports[i].pRxThread->nEventFd);
+				rxthread::stop(s_Ports[i].pRxThread);
+				s_Ports[i].pRxThread = nullptr;
+			} else {
+				net::wait_remove_fd(s_Ports[i].nSocket);
+			}
+#elif defined (CONFIG_NETWORK_USE_IO_URING)
+			net::uring::recv_end(static_cast<uint32_t>(i));
+#elif defined (__linux__)
+			net::wait_remove_fd(s_Ports[i].nSocket);
+#endif
 			s_Ports[i].nSocket = -1;
+#if defined (NETWORK_USE_RECVMMSG)
+			s_Ports[i].batch.nHead = 0;
+			s_Ports[i].batch.nCount = 0;
+#endif
 			return 0;
 		}
 	}
@@ -400,6 +780,63 @@ uint32_t Network::RecvFrom(int32_t nHandle, void *pPacket, uint32_t nSize, uint3
 	assert(pFromIp != nullptr);
 	assert(pFromPort != nullptr);
 
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	auto *pRxPort = port_get(nHandle);
+
+	if ((pRxPort != nullptr) && (pRxPort->pRxThread != nullptr)) {
+		const uint8_t *pData;
+		const auto nLength = rxthread::get(pRxPort->pRxThread, &pData, pFromIp, pFromPort);
+
+		if (nLength == 0) {
+			return 0;
+		}
+
+		const auto nCopy = nLength < nSize ? nLength : nSize;
+
+		memcpy(pPacket, pData, nCopy);
+		rxthread::release(pRxPort->pRxThread);
+		return nCopy;
+	}
+#endif
+
+#if defined (NETWORK_USE_RECVMMSG)
+	auto *pPort = port_get(nHandle);
+
+	if (pPort != nullptr) {
+		const uint8_t *pData;
+		const auto nLength = batch_get(*pPort, &pData, pFromIp, pFromPort);
+
+		if (nLength == 0) {
+			return 0;
+		}
+
+		const auto nCopy = nLength < nSize ? nLength : nSize;
+
+		memcpy(pPacket, pData, nCopy);
+		return nCopy;
+	}
+#endif
+
+#if defined (CONFIG_NETWORK_USE_IO_URING)
+	auto *pUringPort = port_get(nHandle);
+
+	if (pUringPort != nullptr) {
+		const auto nPortIndex = static_cast<uint32_t>(pUringPort - s_Ports);
+		const uint8_t *pData;
+		const auto nLength = net::uring::recv(nPortIndex, &pData, pFromIp, pFromPort);
+
+		if (nLength == 0) {
+			return 0;
+		}
+
+		const auto nCopy = nLength < nSize ? nLength : nSize;
+
+		memcpy(pPacket, pData, nCopy);
+		net::uring::recv_release(nPortIndex);
+		return nCopy;
+	}
+#endif
+
 	int recv_len;
 	struct sockaddr_in si_other;
 	socklen_t slen = sizeof(si_other);
@@ -420,6 +857,27 @@ uint32_t Network::RecvFrom(int32_t nHandle, void *pPacket, uint32_t nSize, uint3
 }
 
 uint32_t Network::RecvFrom(int32_t nHandle, const void **ppBuffer, uint32_t *pFromIp, uint16_t *pFromPort) {
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	auto *pRxPort = port_get(nHandle);
+
+	if ((pRxPort != nullptr) && (pRxPort->pRxThread != nullptr)) {
+		return rxthread::get(pRxPort->pRxThread, reinterpret_cast<const uint8_t **>(ppBuffer), pFromIp, pFromPort);
+	}
+#endif
+#if defined (NETWORK_USE_RECVMMSG)
+	auto *pPort = port_get(nHandle);
+
+	if (pPort != nullptr) {
+		return batch_get(*pPort, reinterpret_cast<const uint8_t **>(ppBuffer), pFromIp, pFromPort);
+	}
+#endif
+#if defined (CONFIG_NETWORK_USE_IO_URING)
+	auto *pPort = port_get(nHandle);
+
+	if (pPort != nullptr) {
+		return net::uring::recv(static_cast<uint32_t>(pPort - s_Ports), reinterpret_cast<const uint8_t **>(ppBuffer), pFromIp, pFromPort);
+	}
+#endif
 	*ppBuffer = &s_ReadBuffer;
 	return RecvFrom(nHandle, s_ReadBuffer, MAX_SEGMENT_LENGTH, pFromIp, pFromPort);
 }
@@ -428,6 +886,16 @@ void Network::SendTo(int32_t nHandle, const void *pPacket, uint32_t nSize, uint3
 	struct sockaddr_in si_other;
 	socklen_t slen = sizeof(si_other);
 
+#if defined (NETWORK_USE_SENDMMSG)
+	// Keep the order of the datagrams
+	if (__builtin_expect((s_TxQueue.nCount != 0), 0)) {
+		SendToQueueFlush();
+	}
+#elif defined (CONFIG_NETWORK_USE_IO_URING)
+	// A send still in flight in the ring would be overtaken by sendto()
+	net::uring::send_drain();
+#endif
+
 #ifndef NDEBUG
 	struct in_addr in;
 	in.s_addr = nToIp;
@@ -443,6 +911,66 @@ void Network::SendTo(int32_t nHandle, const void *pPacket, uint32_t nSize, uint3
 	}
 }
 
+void Network::SendToQueue(int32_t nHandle, const void *pPacket, uint32_t nSize, uint32_t nToIp, uint16_t nRemotePort) {
+#if defined (NETWORK_USE_SENDMMSG)
+	// Does not fit in a queue slot, SendTo() flushes the queue first
+	if (__builtin_expect((nSize > MAX_SEGMENT_LENGTH), 0)) {
+		SendTo(nHandle, pPacket, nSize, nToIp, nRemotePort);
+		return;
+	}
+
+	if ((s_TxQueue.nCount == UDP_TX_QUEUE_SIZE) || ((s_TxQueue.nCount != 0) && (s_TxQueue.nHandle != nHandle))) {
+		SendToQueueFlush();
+	}
+
+	const auto nIndex = s_TxQueue.nCount++;
+
+	s_TxQueue.nHandle = nHandle;
+
+	memcpy(s_TxQueue.data[nIndex], pPacket, nSize);
+
+	s_TxQueue.iov[nIndex].iov_base = s_TxQueue.data[nIndex];
+	s_TxQueue.iov[nIndex].iov_len = nSize;
+
+	auto& to = s_TxQueue.to[nIndex];
+	to.sin_family = AF_INET;
+	to.sin_addr.s_addr = nToIp;
+	to.sin_port = htons(nRemotePort);
+
+	auto& hdr = s_TxQueue.msgs[nIndex].msg_hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.msg_name = &to;
+	hdr.msg_namelen = sizeof(struct sockaddr_in);
+	hdr.msg_iov = &s_TxQueue.iov[nIndex];
+	hdr.msg_iovlen = 1;
+#elif defined (CONFIG_NETWORK_USE_IO_URING)
+	net::uring::send_queue(nHandle, pPacket, nSize, nToIp, nRemotePort);
+#else
+	SendTo(nHandle, pPacket, nSize, nToIp, nRemotePort);
+#endif
+}
+
+void Network::SendToQueueFlush() {
+#if defined (NETWORK_USE_SENDMMSG)
+	uint32_t nSent = 0;
+
+	while (nSent < s_TxQueue.nCount) {
+		const auto nResult = sendmmsg(s_TxQueue.nHandle, &s_TxQueue.msgs[nSent], s_TxQueue.nCount - nSent, 0);
+
+		if (nResult == -1) {
+			perror("sendmmsg");
+			nSent++;	// Skip the failing datagram
+		} else {
+			nSent += static_cast<uint32_t>(nResult);
+		}
+	}
+
+	s_TxQueue.nCount = 0;
+#elif defined (CONFIG_NETWORK_USE_IO_URING)
+	net::uring::send_flush();
+#endif
+}
+
 #if defined(__linux__)
 bool Network::IsDhclient(const char* if_name) {
 	char cmd[255];
@@ -599,6 +1127,104 @@ void Network::Print() {
 	printf(" Broadcast : " IPSTR "\n", IP2STR(GetBroadcastIp()));
 	printf(" Mac       : " MACSTR "\n", MAC2STR(m_aNetMacaddr));
 	printf(" Mode      : %c\n", GetAddressingMode());
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	printf(" Rx dropped: %u\n", GetUdpRxDropped());
+#endif
+}
+
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+/**
+ * The datagrams the receive threads have discarded because their queue was full,
+ * including the ports that have ended since.
+ */
+uint32_t Network::GetUdpRxDropped() const {
+	auto nDropped = s_nRxDropped;
+
+	for (const auto& port : s_Ports) {
+		if (port.pRxThread != nullptr) {
+			nDropped += port.pRxThread->nDropped.load(std::memory_order_relaxed);
+		}
+	}
+
+	return nDropped;
+}
+#endif
+
+#if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+static void rx_thread_wait_end() {
+	for (auto& port : s_Ports) {
+		if (port.pRxThread != nullptr) {
+			rxthread::set_waiting(port.pRxThread, false);
+			uint64_t nValue;
+			[[maybe_unused]] const auto nRead = read(port.pRxThread->nEventFd, &nValue, sizeof(nValue));
+		}
+	}
+}
+#endif
+
+/**
+ * Blocks until a socket is readable or nTimeoutMillis (at most WAIT_MAX_MILLIS) has elapsed.
+ * It returns immediately when there are still received datagrams to be handled.
+ */
+void Network::Wait(uint32_t nTimeoutMillis) {
+#if defined (__linux__)
+# if defined (NETWORK_USE_RECVMMSG)
+	for (const auto& port : s_Ports) {
+		if (port.batch.nHead < port.batch.nCount) {
+			return;
+		}
+	}
+# endif
+# if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	for (auto& port : s_Ports) {
+		if (port.pRxThread != nullptr) {
+			rxthread::set_waiting(port.pRxThread, true);
+		}
+	}
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	for (const auto& port : s_Ports) {
+		if ((port.pRxThread != nullptr) && !rxthread::is_empty(port.pRxThread)) {
+			rx_thread_wait_end();
+			return;
+		}
+	}
+# endif
+# if defined (NETWORK_USE_SENDMMSG)
+	if (s_TxQueue.nCount != 0) {
+		SendToQueueFlush();
+	}
+# endif
+# if defined (CONFIG_NETWORK_USE_IO_URING)
+	if (net::uring::recv_is_pending()) {
+#  if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+		rx_thread_wait_end();
+#  endif
+		return;
+	}
+
+	net::uring::send_flush();
+# endif
+
+	if (nTimeoutMillis > WAIT_MAX_MILLIS) {
+		nTimeoutMillis = WAIT_MAX_MILLIS;
+	}
+
+	struct epoll_event events[UDP_MAX_PORTS_ALLOWED];
+
+	const auto nEvents = epoll_wait(s_nEpollFd, events, UDP_MAX_PORTS_ALLOWED, static_cast<int>(nTimeoutMillis));
+
+# if defined (CONFIG_NETWORK_UDP_RX_THREAD)
+	rx_thread_wait_end();
+# endif
+
+	if (nEvents == -1) {
+		if (errno != EINTR) {
+			perror("epoll_wait");
+		}
+	}
+#endif
 }
 
 namespace net {
@@ -606,6 +1232,37 @@ void tcp_run();
 }  // namespace net
 
 void Network::Run() {
+#if defined (NETWORK_USE_RECVMMSG)
+	for (auto& port : s_Ports) {
+		const auto& portInfo = port.info;
+
+		if ((portInfo.callback != nullptr) && (batch_fill(port) != 0)) {
+			auto& batch = port.batch;
+
+			while (batch.nHead < batch.nCount) {
+				const auto nIndex = batch.nHead++;
+				portInfo.callback(batch.data[nIndex], batch.msgs[nIndex].msg_len, batch.from[nIndex].sin_addr.s_addr, ntohs(batch.from[nIndex].sin_port));
+			}
+		}
+	}
+#elif defined (CONFIG_NETWORK_USE_IO_URING)
+	for (uint32_t nPortIndex = 0; nPortIndex < UDP_MAX_PORTS_ALLOWED; nPortIndex++) {
+		const auto& portInfo = s_Ports[nPortIndex].info;
+
+		if (portInfo.callback != nullptr) {
+			const uint8_t *pData;
+			uint32_t nFromIp;
+			uint16_t nFromPort;
+			uint32_t nLength;
+
+			while ((nLength = net::uring::recv(nPortIndex, &pData, &nFromIp, &nFromPort)) != 0) {
+				portInfo.callback(pData, nLength, nFromIp, nFromPort);
+			}
+
+			net::uring::recv_release(nPortIndex);
+		}
+	}
+#else
 	for (uint32_t nPortIndex = 0; nPortIndex < UDP_MAX_PORTS_ALLOWED; nPortIndex++) {
 		struct sockaddr_in si_other;
 		socklen_t slen = sizeof(si_other);
@@ -620,6 +1277,15 @@ void Network::Run() {
 			}
 		}
 	}
+#endif
+
+#if defined (NETWORK_USE_SENDMMSG)
+	if (s_TxQueue.nCount != 0) {
+		SendToQueueFlush();
+	}
+#elif defined (CONFIG_NETWORK_USE_IO_URING)
+	net::uring::send_flush();
+#endif
 
 	net::tcp_run();
 }
@@ -3,7 +3,7 @@
  * @file networktcp.cpp
  *
  */
-/* Copyright (C) 2021-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -46,6 +46,10 @@
 namespace net {
 // https://cboard.cprogramming.com/c-programming/158125-sockets-using-poll.html
 
+#if defined (__linux__)
+void wait_add_fd(int nFd);
+#endif
+
 #define MAX_PORTS_ALLOWED		2
 #define MAX_SEGMENT_LENGTH		1400
 
@@ -111,6 +115,9 @@ int32_t tcp_begin(uint16_t nLocalPort, [[maybe_unused]] net::TcpCallbackFunction
 
 	poll_set[i][0].fd = server_sockfd[i];
 	poll_set[i][0].events = POLLIN | POLLPRI;
+#if defined (__linux__)
+	wait_add_fd(server_sockfd[i]);
+#endif
 
 	printf("Network::TcpBegin -> i=%d\n", i);
 	return i;
@@ -171,7 +178,7 @@ uint16_t tcp_read(const int32_t nHandle, const uint8_t **ppBuffer, uint32_t &Han
 	return 0;
 }
 
-void tcp_write(const int32_t nHandle, const uint8_t *pBuffer, uint32_t nLength, const uint32_t HandleConnectionIndex) {
+bool tcp_write(const int32_t nHandle, const uint8_t *pBuffer, uint32_t nLength, const uint32_t HandleConnectionIndex) {
 	assert(nHandle < MAX_PORTS_ALLOWED);
 
 	DEBUG_PRINTF("Write client on fd %d [%u]", poll_set[nHandle][HandleConnectionIndex].fd, HandleConnectionIndex);
@@ -183,7 +190,10 @@ void tcp_write(const int32_t nHandle, const uint8_t *pBuffer, uint32_t nLength,
 
 	if (c < 0) {
 		perror("write");
+		return false;
 	}
+
+	return true;
 }
 
 static void close_with_rst(int socket_fd) {
@@ -238,6 +248,9 @@ void tcp_run() {
 
 					poll_set[nHandle][empty_slot].fd = client_sockfd;
 					poll_set[nHandle][empty_slot].events = POLLIN | POLLPRI;
+#if defined (__linux__)
+					wait_add_fd(client_sockfd);
+#endif
 
 					DEBUG_PRINTF("Adding client on fd %d", client_sockfd);
 				} else {
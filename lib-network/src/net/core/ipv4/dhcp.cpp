@@ -363,6 +363,13 @@ static void dhcp_rebind() {
 	DEBUG_EXIT
 }
 
+bool dhcp_renew() {
+	DEBUG_ENTRY
+
+	DEBUG_EXIT
+	return false;
+}
+
 #if defined (CONFIG_NET_DHCP_USE_ACD)
 static void dhcp_send_decline() {
 	DEBUG_ENTRY
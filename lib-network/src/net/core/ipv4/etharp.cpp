@@ -2,7 +2,7 @@
  * @file etharp.cpp
  *
  */
-/* Copyright (C) 2018-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2018-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -51,6 +51,7 @@
 #include "net/netif.h"
 #include "net/arp.h"
 #include "net/acd.h"
+#include "net/hash.h"
 #include "net/protocol/arp.h"
 #include "net/protocol/udp.h"
 
@@ -64,6 +65,8 @@ static constexpr auto MAX_RECORDS = 16;
 static constexpr auto MAX_RECORDS = ARP_MAX_RECORDS;
 #endif
 
+static constexpr auto MAX_QUEUE = ARP_MAX_QUEUE;
+
 namespace net {
 namespace globals {
 extern uint32_t nOnNetworkMask;
@@ -74,6 +77,18 @@ static constexpr uint32_t TIMER_INTERVAL	= 1000;			///< 1 second
 static constexpr uint32_t MAX_PROBING 		= 2;			///< 2 * 1 second
 static constexpr uint32_t MAX_REACHABLE 	= (10 * 60);	///< (10 * 60) * 1 second = 10 minutes
 static constexpr uint32_t MAX_STALE 		= ( 5 * 60);	///< ( 5 * 60) * 1 second =  5 minutes
+static constexpr uint32_t REFRESH			= MAX_REACHABLE - 10;	///< Entries in use are refreshed during the last 10 seconds
+
+static constexpr uint8_t NONE = 0xFF;
+
+static_assert(MAX_RECORDS < NONE);
+static_assert((MAX_QUEUE > 0) && (MAX_QUEUE < 256));
+
+/*
+ * IP address to record, each bucket is a chain of records.
+ */
+static constexpr uint32_t HASH_SIZE = net::hash_size(MAX_RECORDS);
+static constexpr uint32_t HASH_MASK = HASH_SIZE - 1;
 
 enum class State {
 	STATE_EMPTY, STATE_PROBE, STATE_REACHABLE, STATE_STALE,
@@ -89,14 +104,18 @@ struct Packet {
 
 struct Record {
 	uint32_t nIp;
-	Packet packet;
+	Packet packets[MAX_QUEUE];		///< Waiting for the ARP reply, oldest first
 	uint8_t mac_address[ETH_ADDR_LEN];
 	uint16_t nAge;
 	State state;
+	uint8_t nPackets;
+	uint8_t nHashNext;
+	bool bUsed;						///< Used for sending since the last ARP reply
 };
 }  // namespace arp
 
 static net::arp::Record s_ArpRecords[MAX_RECORDS] SECTION_NETWORK ALIGNED;
+static uint8_t s_ArpHash[arp::HASH_SIZE] SECTION_NETWORK ALIGNED;
 static struct t_arp s_arp_request SECTION_NETWORK ALIGNED ;
 static struct t_arp s_arp_reply SECTION_NETWORK ALIGNED;
 
@@ -104,7 +123,7 @@ static struct t_arp s_arp_reply SECTION_NETWORK ALIGNED;
 static constexpr char STATE[4][12] = { "EMPTY", "PROBE", "REACHABLE", "STALE", };
 
 void static arp_cache_record_dump(net::arp::Record *pRecord) {
-	printf("%p %-4d %c " MACSTR " %-10s " IPSTR  "\n", pRecord, pRecord->nAge, pRecord->packet.p == nullptr ? '-' : 'Q' , MAC2STR(pRecord->mac_address), STATE[static_cast<unsigned>(pRecord->state)], IP2STR(pRecord->nIp));
+	printf("%p %-4d %d " MACSTR " %-10s " IPSTR  "\n", pRecord, pRecord->nAge, pRecord->nPackets, MAC2STR(pRecord->mac_address), STATE[static_cast<unsigned>(pRecord->state)], IP2STR(pRecord->nIp));
 }
 
 void static arp_cache_dump() {
@@ -121,41 +140,87 @@ void static arp_cache_record_dump([[maybe_unused]] net::arp::Record *pRecord) {}
 void static arp_cache_dump() {}
 #endif
 
-static net::arp::Record *arp_find_record(const uint32_t nDestinationIp, [[maybe_unused]] const arp::Flags flag) {
+static uint32_t arp_hash(const uint32_t nIp) {
+	return net::hash_fibonacci(nIp, arp::HASH_MASK);
+}
+
+static void arp_hash_insert(net::arp::Record& record) {
+	auto& nHead = s_ArpHash[arp_hash(record.nIp)];
+	record.nHashNext = nHead;
+	nHead = static_cast<uint8_t>(&record - s_ArpRecords);
+}
+
+static void arp_hash_remove(const net::arp::Record& record) {
+	const auto nIndex = static_cast<uint8_t>(&record - s_ArpRecords);
+	auto *pIndex = &s_ArpHash[arp_hash(record.nIp)];
+
+	while (*pIndex != arp::NONE) {
+		if (*pIndex == nIndex) {
+			*pIndex = record.nHashNext;
+			return;
+		}
+		pIndex = &s_ArpRecords[*pIndex].nHashNext;
+	}
+}
+
+static net::arp::Record *arp_record_lookup(const uint32_t nIp) {
+	for (auto i = s_ArpHash[arp_hash(nIp)]; i != arp::NONE; i = s_ArpRecords[i].nHashNext) {
+		if (s_ArpRecords[i].nIp == nIp) {
+			return &s_ArpRecords[i];
+		}
+	}
+
+	return nullptr;
+}
+
+static void arp_queue_free(net::arp::Record& record) {
+	for (uint32_t i = 0; i < record.nPackets; i++) {
+		delete[] record.packets[i].p;
+		record.packets[i].p = nullptr;
+	}
+
+	record.nPackets = 0;
+}
+
+static void arp_cache_clean_record(net::arp::Record& record) {
+	if (record.state != net::arp::State::STATE_EMPTY) {
+		udp_template_invalidate(record.nIp);
+		arp_hash_remove(record);
+	}
+
+	arp_queue_free(record);
+	std::memset(&record, 0, sizeof(struct net::arp::Record));
+}
+
+/**
+ * A free record, otherwise the oldest STALE, otherwise the oldest REACHABLE record is reused.
+ * Records waiting for an ARP reply are never reused.
+ */
+static net::arp::Record *arp_record_allocate(const uint32_t nIp) {
 	DEBUG_ENTRY
 
+	net::arp::Record *pRecord = nullptr;
 	net::arp::Record *pStale = nullptr;
 	net::arp::Record *pReachable = nullptr;
 	uint32_t nAgeStale = 0;
 	uint32_t nAgeReachable = 0;
 
 	for (auto &record : s_ArpRecords) {
-		if (record.nIp == nDestinationIp) {
-			DEBUG_EXIT
-			return &record;
-		}
-
-		if (flag == arp::Flags::FLAG_UPDATE) {
-			continue;
-		}
-
 		if (record.state == net::arp::State::STATE_EMPTY) {
-			record.nIp = nDestinationIp;
-			DEBUG_EXIT
-			return &record;
+			pRecord = &record;
+			break;
 		}
 
 		if (record.state == net::arp::State::STATE_REACHABLE) {
-			if (record.nAge > nAgeReachable) {
+			if (record.nAge >= nAgeReachable) {
 				nAgeReachable = record.nAge;
 				pReachable = &record;
 			}
 			continue;
 		}
 
-
 		if (record.state == net::arp::State::STATE_STALE) {
-			if (record.nAge > nAgeStale) {
+			if (record.nAge >= nAgeStale) {
 				nAgeStale = record.nAge;
 				pStale = &record;
 			}
@@ -163,57 +228,77 @@ static net::arp::Record *arp_find_record(const uint32_t nDestinationIp, [[maybe_
 		}
 	}
 
-	if (pStale != nullptr) {
-		DEBUG_EXIT
-		return pStale;
-	}
+	if (pRecord == nullptr) {
+		pRecord = (pStale != nullptr) ? pStale : pReachable;
 
-	if (pReachable != nullptr) {
-		DEBUG_EXIT
-		return pReachable;
+		if (pRecord == nullptr) {
+			DEBUG_EXIT
+			return nullptr;
+		}
+
+		arp_cache_clean_record(*pRecord);
 	}
 
+	pRecord->nIp = nIp;
+	arp_hash_insert(*pRecord);
+
 	DEBUG_EXIT
-	return nullptr;
+	return pRecord;
+}
+
+static void arp_queue_send(net::arp::Record& record) {
+	for (uint32_t i = 0; i < record.nPackets; i++) {
+		auto& packet = record.packets[i];
+		auto *udp = reinterpret_cast<struct t_udp *>(packet.p);
+		std::memcpy(udp->ether.dst, record.mac_address, ETH_ADDR_LEN);
+#if defined CONFIG_NET_ENABLE_PTP
+		if (!packet.isTimestamp) {
+#endif
+			emac_eth_send(packet.p, packet.nSize);
+#if defined CONFIG_NET_ENABLE_PTP
+		} else {
+			emac_eth_send_timestamp(packet.p, packet.nSize);
+		}
+#endif
+		delete[] packet.p;
+		packet.p = nullptr;
+	}
+
+	record.nPackets = 0;
 }
 
 static void arp_cache_update(const uint8_t *pMacAddress, const uint32_t nIp, const arp::Flags flag) {
 	DEBUG_ENTRY
 	DEBUG_PRINTF(MACSTR " " IPSTR " flag=%d", MAC2STR(pMacAddress), IP2STR(nIp), flag);
 
-	auto *record = arp_find_record(nIp, flag);
+	auto *record = arp_record_lookup(nIp);
 
 	if (record == nullptr) {
-		assert(flag == arp::Flags::FLAG_UPDATE);
-		DEBUG_EXIT
-		return;
+		if (flag == arp::Flags::FLAG_UPDATE) {
+			DEBUG_EXIT
+			return;
+		}
+
+		record = arp_record_allocate(nIp);
+
+		if (record == nullptr) {
+			DEBUG_EXIT
+			return;
+		}
+	}
+
+	if ((record->state >= net::arp::State::STATE_REACHABLE) && (memcmp(record->mac_address, pMacAddress, ETH_ADDR_LEN) != 0)) {
+		udp_template_invalidate(nIp);
 	}
 
 	record->state = net::arp::State::STATE_REACHABLE;
 	record->nAge = 0;
+	record->bUsed = false;
 	std::memcpy(record->mac_address, pMacAddress, ETH_ADDR_LEN);
 
 	arp_cache_record_dump(record);
 
-	if (record->packet.p != nullptr) {
-		auto *udp = reinterpret_cast<struct t_udp *>(record->packet.p);
-		std::memcpy(udp->ether.dst, record->mac_address, ETH_ADDR_LEN);
-		udp->ip4.chksum = 0;
-#if !defined (CHECKSUM_BY_HARDWARE)
-		udp->ip4.chksum = net_chksum(reinterpret_cast<void *>(&udp->ip4), sizeof(udp->ip4));
-#endif
-#if defined CONFIG_NET_ENABLE_PTP
-		if (!record->packet.isTimestamp) {
-#endif
-			emac_eth_send(record->packet.p, record->packet.nSize);
-#if defined CONFIG_NET_ENABLE_PTP
-		} else {
-			emac_eth_send_timestamp(record->packet.p, record->packet.nSize);
-		}
-#endif
-		delete [] record->packet.p;
-		record->packet.p = nullptr;
-	}
+	arp_queue_send(*record);
 
 	DEBUG_EXIT
 }
@@ -226,42 +311,57 @@ static void arp_send_request(const uint32_t nIp) {
 	emac_eth_send(reinterpret_cast<void *>(&s_arp_request), sizeof(struct t_arp));
 }
 
+/**
+ * The packet is queued until the ARP reply is received.
+ * When the queue is full, the oldest packet is dropped.
+ */
 template<net::arp::EthSend S>
-static void arp_query(const uint32_t nDestinationIp, struct t_udp *pPacket, const uint32_t nSize, [[maybe_unused]] const arp::Flags flag) {
+static void arp_query(const uint32_t nDestinationIp, struct t_udp *pPacket, const uint32_t nSize) {
 	DEBUG_ENTRY
-	DEBUG_PRINTF(IPSTR " %c", IP2STR(nDestinationIp), flag == arp::Flags::FLAG_UPDATE ? 'U' : 'I');
+	DEBUG_PRINTF(IPSTR, IP2STR(nDestinationIp));
 
-	auto *recordFound = arp_find_record(nDestinationIp, flag);
-	assert(recordFound != nullptr);
+	auto *record = arp_record_lookup(nDestinationIp);
 
-	arp_cache_record_dump(recordFound);
+	if (record == nullptr) {
+		record = arp_record_allocate(nDestinationIp);
 
-	if (recordFound->state == net::arp::State::STATE_EMPTY) {
-		if (recordFound->packet.p != nullptr) {
-			delete[] recordFound->packet.p;
+		if (record == nullptr) {
+			DEBUG_PUTS("All records are waiting for a reply");
+			DEBUG_EXIT
+			return;
 		}
 
-		recordFound->packet.p = new uint8_t[nSize];
-		assert(recordFound->packet.p != nullptr);
-
-		net::memcpy(recordFound->packet.p, pPacket, nSize);
-		recordFound->packet.nSize = nSize;
-#if defined CONFIG_NET_ENABLE_PTP
-		recordFound->packet.isTimestamp = (S != net::arp::EthSend::IS_NORMAL);
-#endif
-		recordFound->state = net::arp::State::STATE_PROBE;
-		recordFound->nAge = 0;
+		record->state = net::arp::State::STATE_PROBE;
+		record->nAge = 0;
 		arp_send_request(nDestinationIp);
 	}
 
-	DEBUG_EXIT
-}
+	assert(record->state == net::arp::State::STATE_PROBE);
 
-static void arp_cache_clean_record(net::arp::Record& record) {
-	if (record.packet.p != nullptr) {
-		delete[] record.packet.p;
+	if (record->nPackets == MAX_QUEUE) {
+		delete[] record->packets[0].p;
+
+		for (uint32_t i = 1; i < MAX_QUEUE; i++) {
+			record->packets[i - 1] = record->packets[i];
+		}
+
+		record->nPackets--;
 	}
-	std::memset(&record, 0, sizeof(struct net::arp::Record));
+
+	auto& packet = record->packets[record->nPackets++];
+
+	packet.p = new uint8_t[nSize];
+	assert(packet.p != nullptr);
+
+	net::memcpy(packet.p, pPacket, nSize);
+	packet.nSize = nSize;
+#if defined CONFIG_NET_ENABLE_PTP
+	packet.isTimestamp = (S != net::arp::EthSend::IS_NORMAL);
+#endif
+
+	arp_cache_record_dump(record);
+
+	DEBUG_EXIT
 }
 
 static void arp_send_request_unicast(const uint32_t nIp, const uint8_t *pMacAddress) {
@@ -285,6 +385,8 @@ static void arp_timer([[maybe_unused]] TimerHandle_t nHandle) {
 			case net::arp::State::STATE_PROBE:
 				if (record.nAge > net::arp::MAX_PROBING) {
 					arp_cache_clean_record(record);
+				} else {
+					arp_send_request(record.nIp);
 				}
 				break;
 
@@ -292,12 +394,24 @@ static void arp_timer([[maybe_unused]] TimerHandle_t nHandle) {
 				if (record.nAge > net::arp::MAX_REACHABLE) {
 					record.state = net::arp::State::STATE_STALE;
 					record.nAge = 0;
+				} else if (record.nAge == net::arp::REFRESH) {
+					/*
+					 * Sending with a cached UDP header does not pass the ARP cache.
+					 * Rebuilding the headers marks the record when it is still in use.
+					 */
+					udp_template_invalidate(record.nIp);
+				} else if ((record.nAge > net::arp::REFRESH) && record.bUsed) {
+					arp_send_request_unicast(record.nIp, record.mac_address);
 				}
 				break;
 
 			case net::arp::State::STATE_STALE:
 				if (record.nAge > net::arp::MAX_STALE) {
+					udp_template_invalidate(record.nIp);
 					record.state = net::arp::State::STATE_PROBE;
+					record.nAge = 0;
+					arp_send_request_unicast(record.nIp, record.mac_address);
+				} else if (record.bUsed) {
 					arp_send_request_unicast(record.nIp, record.mac_address);
 				}
 				break;
@@ -336,6 +450,8 @@ void __attribute__((cold)) arp_init() {
 		std::memset(&record, 0, sizeof(struct net::arp::Record));
 	}
 
+	std::memset(s_ArpHash, arp::NONE, sizeof(s_ArpHash));
+
 	// ARP Request template
 	// Ethernet header
 	std::memcpy(s_arp_request.ether.src, net::globals::netif_default.hwaddr, ETH_ADDR_LEN);
@@ -420,6 +536,24 @@ __attribute__((hot)) void etharp_input(const struct t_arp *pArp) {
 	}
 }
 
+/**
+ * The gateway for an off-subnet destination, otherwise the destination itself.
+ */
+uint32_t arp_next_hop(const uint32_t nRemoteIp) {
+	if  (__builtin_expect((net::globals::nOnNetworkMask != (nRemoteIp & net::globals::nOnNetworkMask)), 0)) {
+	      /* According to RFC 3297, chapter 2.6.2 (Forwarding Rules), a packet with
+	         a link-local source address must always be "directly to its destination
+	         on the same physical link. The host MUST NOT send the packet to any
+	         router for forwarding". */
+		if (!net::is_linklocal_ip(nRemoteIp)) {
+			DEBUG_PUTS("");
+			return net::globals::netif_default.gw.addr;
+		}
+	}
+
+	return nRemoteIp;
+}
+
 template<net::arp::EthSend S>
 static void arp_send_implementation(struct t_udp *pPacket, const uint32_t nSize, const uint32_t nRemoteIp) {
 	DEBUG_ENTRY
@@ -439,39 +573,27 @@ static void arp_send_implementation(struct t_udp *pPacket, const uint32_t nSize,
 	pPacket->ip4.chksum = net_chksum(reinterpret_cast<void *>(&pPacket->ip4), sizeof(pPacket->ip4));
 #endif
 
-	auto nDestinationIp = nRemoteIp;
+	const auto nDestinationIp = arp_next_hop(nRemoteIp);
 
-	if  (__builtin_expect((net::globals::nOnNetworkMask != (nRemoteIp & net::globals::nOnNetworkMask)), 0)) {
-	      /* According to RFC 3297, chapter 2.6.2 (Forwarding Rules), a packet with
-	         a link-local source address must always be "directly to its destination
-	         on the same physical link. The host MUST NOT send the packet to any
-	         router for forwarding". */
-		if (!net::is_linklocal_ip(nRemoteIp)) {
-			nDestinationIp = netif.gw.addr;
-			DEBUG_PUTS("");
-		}
-	}
+	auto *record = arp_record_lookup(nDestinationIp);
 
-	for (auto &record : s_ArpRecords) {
-		if (record.state >= net::arp::State::STATE_REACHABLE) {
-			if (record.nIp == nDestinationIp) {
-				std::memcpy(pPacket->ether.dst, record.mac_address, ETH_ADDR_LEN);
+	if ((record != nullptr) && (record->state >= net::arp::State::STATE_REACHABLE)) {
+		record->bUsed = true;
+		std::memcpy(pPacket->ether.dst, record->mac_address, ETH_ADDR_LEN);
 
-				if constexpr (S == net::arp::EthSend::IS_NORMAL) {
-					emac_eth_send(reinterpret_cast<void *>(pPacket), nSize);
-				}
+		if constexpr (S == net::arp::EthSend::IS_NORMAL) {
+			emac_eth_send(reinterpret_cast<void *>(pPacket), nSize);
+		}
 #if defined CONFIG_NET_ENABLE_PTP
-				else if constexpr (S == net::arp::EthSend::IS_TIMESTAMP) {
-					emac_eth_send_timestamp(reinterpret_cast<void *>(pPacket), nSize);
-				}
-#endif
-				DEBUG_EXIT
-				return;
-			}
+		else if constexpr (S == net::arp::EthSend::IS_TIMESTAMP) {
+			emac_eth_send_timestamp(reinterpret_cast<void *>(pPacket), nSize);
 		}
+#endif
+		DEBUG_EXIT
+		return;
 	}
 
-	arp_query<S>(nDestinationIp, pPacket, nSize, arp::Flags::FLAG_INSERT);
+	arp_query<S>(nDestinationIp, pPacket, nSize);
 
 	DEBUG_EXIT
 	return;
@@ -487,6 +609,28 @@ void arp_send_timestamp(struct t_udp *pPacket, const uint32_t nSize, const uint3
 }
 #endif
 
+/**
+ * Copies the MAC address of the next hop for nRemoteIp, when it is in the ARP cache.
+ * Nothing is sent, a miss must be handled with arp_send().
+ */
+bool arp_lookup(const uint32_t nRemoteIp, uint8_t *pMacAddress) {
+	if (__builtin_expect((net::globals::netif_default.ip.addr == 0), 0)) {
+		return false;
+	}
+
+	const auto nDestinationIp = arp_next_hop(nRemoteIp);
+
+	auto *record = arp_record_lookup(nDestinationIp);
+
+	if ((record != nullptr) && (record->state >= net::arp::State::STATE_REACHABLE)) {
+		record->bUsed = true;
+		std::memcpy(pMacAddress, record->mac_address, ETH_ADDR_LEN);
+		return true;
+	}
+
+	return false;
+}
+
 /*
  *  The Sender IP is set to all zeros,
  *  which means it cannot map to the Sender MAC address.
@@ -2,7 +2,7 @@
  * @file igmp.cpp
  *
  */
-/* Copyright (C) 2018-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2018-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -45,6 +45,7 @@
 #include "net_private.h"
 #include "net/netif.h"
 #include "net/igmp.h"
+#include "net/hash.h"
 #include "net/protocol/igmp.h"
 
 #include "softwaretimers.h"
@@ -68,6 +69,7 @@ enum State {
 struct t_group_info {
 	uint32_t nGroupAddress;
 	uint16_t nTimer;		// 1/10 seconds
+	uint16_t nHashNext;
 	State state;
 };
 
@@ -76,13 +78,101 @@ typedef union pcast32 {
 	uint8_t u8[4];
 } _pcast32;
 
+namespace igmp {
+static constexpr uint16_t NONE = 0xFFFF;
+
+static_assert(IGMP_MAX_JOINS_ALLOWED < NONE);
+
+/*
+ * Group address to group, each bucket is a chain of groups.
+ */
+static constexpr uint32_t HASH_SIZE = net::hash_size(IGMP_MAX_JOINS_ALLOWED);
+static constexpr uint32_t HASH_MASK = HASH_SIZE - 1;
+static constexpr uint32_t ALL_SYSTEMS = 0x010000e0;	///< 224.0.0.1
+}  // namespace igmp
+
 static struct t_igmp s_report SECTION_NETWORK ALIGNED;
 static struct t_igmp s_leave SECTION_NETWORK ALIGNED;
 static uint8_t s_multicast_mac[ETH_ADDR_LEN] SECTION_NETWORK ALIGNED;
 static struct t_group_info s_groups[IGMP_MAX_JOINS_ALLOWED] SECTION_NETWORK ALIGNED;
+static uint16_t s_GroupHash[igmp::HASH_SIZE] SECTION_NETWORK ALIGNED;
 static uint16_t s_id SECTION_NETWORK ALIGNED;
 static TimerHandle_t nTimerId;
 
+#if defined (CONFIG_EMAC_HASH_MULTICAST_FILTER)
+/*
+ * The 64-bin EMAC hash filter, with the number of groups per bin.
+ */
+static uint32_t s_HashTable[2] SECTION_NETWORK ALIGNED;
+static uint16_t s_HashBinCount[64] SECTION_NETWORK ALIGNED;
+
+static uint32_t igmp_hash_filter_index(const uint32_t nGroupAddress) {
+	_pcast32 multicast_ip;
+	multicast_ip.u32 = nGroupAddress;
+	const uint8_t mac_addr[6] = {0x01, 0x00, 0x5E,
+			static_cast<uint8_t>(multicast_ip.u8[1] & 0x7F),
+			multicast_ip.u8[2],
+			multicast_ip.u8[3]};
+
+	const auto nIndex = emac_multicast_hash_index(mac_addr) & 0x3F;
+	DEBUG_PRINTF(MACSTR " -> %u", MAC2STR(mac_addr), nIndex);
+	return nIndex;
+}
+
+static void igmp_hash_filter_add(const uint32_t nGroupAddress) {
+	const auto nIndex = igmp_hash_filter_index(nGroupAddress);
+
+	if (s_HashBinCount[nIndex]++ == 0) {
+		s_HashTable[nIndex >> 5] |= (1U << (nIndex & 0x1F));
+		emac_multicast_set_hash(s_HashTable);
+	}
+}
+
+static void igmp_hash_filter_remove(const uint32_t nGroupAddress) {
+	const auto nIndex = igmp_hash_filter_index(nGroupAddress);
+
+	assert(s_HashBinCount[nIndex] != 0);
+
+	if (--s_HashBinCount[nIndex] == 0) {
+		s_HashTable[nIndex >> 5] &= ~(1U << (nIndex & 0x1F));
+		emac_multicast_set_hash(s_HashTable);
+	}
+}
+#endif
+
+static uint32_t igmp_hash(const uint32_t nGroupAddress) {
+	return net::hash_fibonacci(nGroupAddress, igmp::HASH_MASK);
+}
+
+static void igmp_hash_insert(struct t_group_info& group) {
+	auto& nHead = s_GroupHash[igmp_hash(group.nGroupAddress)];
+	group.nHashNext = nHead;
+	nHead = static_cast<uint16_t>(&group - s_groups);
+}
+
+static void igmp_hash_remove(const struct t_group_info& group) {
+	const auto nIndex = static_cast<uint16_t>(&group - s_groups);
+	auto *pIndex = &s_GroupHash[igmp_hash(group.nGroupAddress)];
+
+	while (*pIndex != igmp::NONE) {
+		if (*pIndex == nIndex) {
+			*pIndex = group.nHashNext;
+			return;
+		}
+		pIndex = &s_groups[*pIndex].nHashNext;
+	}
+}
+
+static struct t_group_info *igmp_group_lookup(const uint32_t nGroupAddress) {
+	for (auto i = s_GroupHash[igmp_hash(nGroupAddress)]; i != igmp::NONE; i = s_groups[i].nHashNext) {
+		if (s_groups[i].nGroupAddress == nGroupAddress) {
+			return &s_groups[i];
+		}
+	}
+
+	return nullptr;
+}
+
 static void igmp_send_report(const uint32_t nGroupAddress) {
 	DEBUG_ENTRY
 	_pcast32 multicast_ip;
@@ -124,7 +214,7 @@ static void igmp_start_timer(struct t_group_info &group, const uint32_t max_time
 }
 
 static void igmp_timeout(struct t_group_info &group) {
-	if ((group.state == DELAYING_MEMBER) &&  (group.nGroupAddress != 0x010000e0)) { //FIXME all-systems
+	if ((group.state == DELAYING_MEMBER) &&  (group.nGroupAddress != igmp::ALL_SYSTEMS)) { //FIXME all-systems
 		group.state = IDLE_MEMBER;
 		igmp_send_report(group.nGroupAddress);
 	}
@@ -192,11 +282,18 @@ void __attribute__((cold)) igmp_init() {
 	s_leave.igmp.report.igmp.type = IGMP_TYPE_LEAVE;
 	s_leave.igmp.report.igmp.max_resp_time = 0;
 
+	std::memset(s_GroupHash, 0xFF, sizeof(s_GroupHash));
+
 	nTimerId = SoftwareTimerAdd(IGMP_TMR_INTERVAL, igmp_timer);
 	assert(nTimerId >= 0);
 
 #if defined (CONFIG_EMAC_HASH_MULTICAST_FILTER)
+	std::memset(s_HashTable, 0, sizeof(s_HashTable));
+	std::memset(s_HashBinCount, 0, sizeof(s_HashBinCount));
+	/* The queries are sent to all-systems, which is never joined */
+	igmp_hash_filter_add(igmp::ALL_SYSTEMS);
 	emac_multicast_enable_hash_filter();
+	emac_multicast_set_hash(s_HashTable);
 #endif
 }
 
@@ -243,38 +340,36 @@ static void igmp_send_leave(const uint32_t nGroupAddress) {
 	DEBUG_EXIT
 }
 
+static void igmp_query(struct t_group_info &group, const uint8_t nMaxRespTime) {
+	if (group.state == DELAYING_MEMBER) {
+		if (nMaxRespTime < group.nTimer) {
+			group.nTimer = static_cast<uint16_t>(1 + nMaxRespTime / 2);
+		}
+	} else { // group.state == IDLE_MEMBER
+		group.state = DELAYING_MEMBER;
+		group.nTimer = static_cast<uint16_t>(1 + nMaxRespTime / 2);
+	}
+}
+
 __attribute__((hot)) void igmp_input(const struct t_igmp *p_igmp) {
 	DEBUG_ENTRY
 
 	if ((p_igmp->ip4.ver_ihl == 0x45) && (p_igmp->igmp.igmp.type == IGMP_TYPE_QUERY)) {
 		DEBUG_PRINTF(IPSTR, p_igmp->ip4.dst[0], p_igmp->ip4.dst[1], p_igmp->ip4.dst[2], p_igmp->ip4.dst[3]);
 
-		auto isGeneralRequest = false;
-
-		_pcast32 igmp_generic_address;
-		igmp_generic_address.u32 = 0x010000e0;
+		const auto nGroupAddress = net::memcpy_ip(p_igmp->ip4.dst);
 
-		if (memcmp(p_igmp->ip4.dst, igmp_generic_address.u8, 4) == 0) {
-			isGeneralRequest = true;
-		}
-
-		for (auto& group : s_groups) {
-			if (group.nGroupAddress == 0) {
-				continue;
+		if (nGroupAddress == igmp::ALL_SYSTEMS) {
+			for (auto& group : s_groups) {
+				if (group.nGroupAddress != 0) {
+					igmp_query(group, p_igmp->igmp.igmp.max_resp_time);
+				}
 			}
+		} else {
+			auto *pGroup = igmp_group_lookup(nGroupAddress);
 
-			_pcast32 group_address;
-			group_address.u32 = group.nGroupAddress;
-
-			if (isGeneralRequest || ( memcmp(p_igmp->ip4.dst, group_address.u8, IPv4_ADDR_LEN) == 0)) {
-				if (group.state == DELAYING_MEMBER) {
-					if (p_igmp->igmp.igmp.max_resp_time  < group.nTimer) {
-						group.nTimer = (1 + p_igmp->igmp.igmp.max_resp_time / 2);
-					}
-				} else { // s_groups[s_joins_allowed_index].state == IDLE_MEMBER
-					group.state = DELAYING_MEMBER;
-					group.nTimer = (1 + p_igmp->igmp.igmp.max_resp_time / 2);
-				}
+			if (pGroup != nullptr) {
+				igmp_query(*pGroup, p_igmp->igmp.igmp.max_resp_time);
 			}
 		}
 	}
@@ -301,26 +396,20 @@ void igmp_join(const uint32_t nGroupAddress) {
 		return;
 	}
 
-	for (int i = 0; i < IGMP_MAX_JOINS_ALLOWED; i++) {
-		if (s_groups[i].nGroupAddress == nGroupAddress) {
-			DEBUG_EXIT
-			return;
-		}
+	if (igmp_group_lookup(nGroupAddress) != nullptr) {
+		DEBUG_EXIT
+		return;
+	}
 
-		if (s_groups[i].nGroupAddress == 0) {
-			s_groups[i].nGroupAddress = nGroupAddress;
-			s_groups[i].state = DELAYING_MEMBER;
-			s_groups[i].nTimer = 2; // TODO
+	for (auto& group : s_groups) {
+		if (group.nGroupAddress == 0) {
+			group.nGroupAddress = nGroupAddress;
+			group.state = DELAYING_MEMBER;
+			group.nTimer = 2; // TODO
 
+			igmp_hash_insert(group);
 #if defined (CONFIG_EMAC_HASH_MULTICAST_FILTER)
-			_pcast32 multicast_ip;
-			multicast_ip.u32 = nGroupAddress;
-			const uint8_t mac_addr[6] = {0x01, 0x00, 0x5E,
-					static_cast<uint8_t>(multicast_ip.u8[1] & 0x7F),
-					multicast_ip.u8[2],
-					multicast_ip.u8[3]};
-            DEBUG_PRINTF(MACSTR, MAC2STR(mac_addr));
-            emac_multicast_set_hash(mac_addr);
+			igmp_hash_filter_add(nGroupAddress);
 #endif
 			igmp_send_report(nGroupAddress);
 
@@ -335,43 +424,25 @@ void igmp_join(const uint32_t nGroupAddress) {
 	DEBUG_ENTRY
 }
 
-#if defined (CONFIG_EMAC_HASH_MULTICAST_FILTER)
-static void reset_hash() {
-	emac_multicast_reset_hash();
-
-	for (auto &group : s_groups) {
-		if (group.nGroupAddress != 0) {
-			_pcast32 multicast_ip;
-			multicast_ip.u32 = group.nGroupAddress;
-			const uint8_t mac_addr[6] = {0x01, 0x00, 0x5E,
-					static_cast<uint8_t>(multicast_ip.u8[1] & 0x7F),
-					multicast_ip.u8[2],
-					multicast_ip.u8[3]};
-
-            emac_multicast_set_hash(mac_addr);
-		}
-	}
-}
-#endif
-
 void igmp_leave(const uint32_t nGroupAddress) {
 	DEBUG_ENTRY
 	DEBUG_PRINTF(IPSTR, IP2STR(nGroupAddress));
 
-	for (auto& group : s_groups) {
-		if (group.nGroupAddress == nGroupAddress) {
-			igmp_send_leave(group.nGroupAddress);
+	auto *pGroup = igmp_group_lookup(nGroupAddress);
 
-			group.nGroupAddress = 0;
-			group.state = NON_MEMBER;
-			group.nTimer = 0;
+	if (pGroup != nullptr) {
+		igmp_send_leave(nGroupAddress);
 
+		igmp_hash_remove(*pGroup);
 #if defined (CONFIG_EMAC_HASH_MULTICAST_FILTER)
-			reset_hash();
+		igmp_hash_filter_remove(nGroupAddress);
 #endif
-			DEBUG_EXIT
-			return;
-		}
+		pGroup->nGroupAddress = 0;
+		pGroup->state = NON_MEMBER;
+		pGroup->nTimer = 0;
+
+		DEBUG_EXIT
+		return;
 	}
 
 #ifndef NDEBUG
@@ -381,19 +452,14 @@ void igmp_leave(const uint32_t nGroupAddress) {
 	DEBUG_EXIT
 }
 
-bool igmp_lookup_group(const uint32_t nGroupAddress) {
-	DEBUG_ENTRY
+__attribute__((hot)) bool igmp_lookup_group(const uint32_t nGroupAddress) {
 	DEBUG_PRINTF(IPSTR, IP2STR(nGroupAddress));
 
-	for (auto& group : s_groups) {
-		if (group.nGroupAddress == nGroupAddress) {
-			DEBUG_EXIT
-			return true;
-		}
+	if (igmp_group_lookup(nGroupAddress) != nullptr) {
+		return true;
 	}
 
-	DEBUG_EXIT
-	return (nGroupAddress == net::convert_to_uint(224,0,0,1));
+	return (nGroupAddress == igmp::ALL_SYSTEMS);
 }
 
 void igmp_report_groups() {
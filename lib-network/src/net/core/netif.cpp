@@ -34,6 +34,7 @@
 #include "net/autoip.h"
 #include "net/dhcp.h"
 #include "net/igmp.h"
+#include "net_private.h"
 
 #include "debug.h"
 
@@ -75,6 +76,8 @@ static void netif_do_update_globals() {
 
 	globals::nBroadcastMask = ~(netif.netmask.addr);
 	globals::nOnNetworkMask =netif.ip.addr & netif.netmask.addr;
+
+	udp_template_invalidate();
 }
 
 static void netif_do_ip_addr_changed([[maybe_unused]] const ip4_addr_t old_addr,[[maybe_unused]] const ip4_addr_t new_addr) {
@@ -146,6 +149,8 @@ static bool netif_do_set_gw(const ip4_addr_t gw, ip4_addr_t &old_gw) {
 		old_gw.addr = netif.gw.addr;
 		netif.gw.addr = gw.addr;
 
+		udp_template_invalidate();
+
 		DEBUG_EXIT
 		return true;	// gateway changed
 	}
@@ -2,7 +2,7 @@
  * @file tcp.cpp
  *
  */
-/* Copyright (C) 2021-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -51,19 +51,22 @@
 #include "net_config.h"
 #include "net/tcp.h"
 #include "net/protocol/tcp.h"
+#include "net/hash.h"
 #include "net_memcpy.h"
 #include "net_private.h"
 #include "datasegmentqueue.h"
 
 #include "hardware.h"
+#include "softwaretimers.h"
 #include "debug.h"
 
 namespace net {
 #define TCP_RX_MSS						(TCP_DATA_SIZE)
-#define TCP_RX_MAX_ENTRIES				(1U << 1) // Must always be a power of 2
-#define TCP_RX_MAX_ENTRIES_MASK			(TCP_RX_MAX_ENTRIES - 1)
-#define TCP_MAX_RX_WND 					(TCP_RX_MAX_ENTRIES * TCP_RX_MSS);
+#define TCP_MAX_RX_WND 					(TCP_RX_MAX_ENTRIES * TCP_RX_MSS)
 #define TCP_TX_MSS						(TCP_DATA_SIZE)
+#define TCP_ACK_DELAY_MILLIS			100
+
+static_assert(TCP_MAX_RX_WND <= 0xFFFF, "There is no window scaling");
 
 /**
  * Transmission control block (TCB)
@@ -100,6 +103,8 @@ struct tcb {
 		uint32_t size;
 	} TX;
 
+	DataSegmentQueue TXQ;	/* written data waiting for the send window */
+
 	/* Receive Sequence Variables */
 	struct {
 		uint32_t NXT; 	/* receive next */
@@ -110,6 +115,8 @@ struct tcb {
 	uint32_t IRS;		/* initial receive sequence number */
 
 	uint8_t state;
+	uint8_t nAckPending;	/* received segments not acknowledged yet */
+	int8_t nHashNext;	/* next TCB in the same hash bucket, -1 is end */
 };
 
 struct SendInfo {
@@ -118,16 +125,16 @@ struct SendInfo {
 	uint8_t CTL;
 };
 
-struct TransmissionQueue {
-	tcb *pTcb;
-	DataSegmentQueue dataSegmentQueue;
-};
+/*
+ * The local address and port are the same for all TCB's of a port,
+ * so the remote address and port select the bucket.
+ */
+static constexpr uint32_t TCB_HASH_SIZE = net::hash_size(TCP_MAX_TCBS_ALLOWED);
+static constexpr uint32_t TCB_HASH_MASK = TCB_HASH_SIZE - 1;
 
 struct PortInfo {
 	tcb TCB[TCP_MAX_TCBS_ALLOWED];
-#if defined(TCP_TX_QUEUE_SIZE)
-	TransmissionQueue transmissionQueue;
-#endif
+	int8_t tcbHash[TCB_HASH_SIZE];	/* first active TCB in the bucket, -1 is empty */
 	TcpCallbackFunctionPtr callback;
 	uint16_t nLocalPort;
 };
@@ -299,9 +306,51 @@ static void tcp_bswap32_acknum_seqnum(struct t_tcp *p_tcp) {
 	memcpy(&p_tcp->tcp.seqnum, src.u8, 4);
 }
 
+static uint32_t tcb_hash(const uint8_t *pRemoteIp, const uint16_t nRemotePort) {
+	const auto nKey = static_cast<uint32_t>(pRemoteIp[2] ^ nRemotePort) | (static_cast<uint32_t>(pRemoteIp[3]) << 8);
+	return net::hash_fibonacci(nKey, TCB_HASH_MASK);
+}
+
+static void tcb_hash_insert(const uint32_t nIndexPort, const uint32_t nIndexTCB) {
+	auto& port = s_Ports[nIndexPort];
+	auto *pTcb = &port.TCB[nIndexTCB];
+	const auto nBucket = tcb_hash(pTcb->remoteIp, pTcb->nRemotePort);
+
+	pTcb->nHashNext = port.tcbHash[nBucket];
+	port.tcbHash[nBucket] = static_cast<int8_t>(nIndexTCB);
+}
+
+static void tcb_hash_remove(const struct tcb *pTcb) {
+	for (auto& port : s_Ports) {
+		if ((pTcb < &port.TCB[0]) || (pTcb >= &port.TCB[TCP_MAX_TCBS_ALLOWED])) {
+			continue;
+		}
+
+		const auto nIndexTCB = static_cast<int8_t>(pTcb - &port.TCB[0]);
+		auto *pLink = &port.tcbHash[tcb_hash(pTcb->remoteIp, pTcb->nRemotePort)];
+
+		while (*pLink >= 0) {
+			if (*pLink == nIndexTCB) {
+				*pLink = pTcb->nHashNext;
+				return;
+			}
+			pLink = &port.TCB[*pLink].nHashNext;
+		}
+
+		return;
+	}
+}
+
 static void tcp_init_tcb(struct tcb *pTcb, const uint16_t nLocalPort) {
+	// Only TCB's which left the LISTEN state are in the hash table
+	if ((pTcb->state != STATE_CLOSED) && (pTcb->state != STATE_LISTEN)) {
+		tcb_hash_remove(pTcb);
+	}
+
 	std::memset(pTcb, 0, sizeof(struct tcb));
 
+	pTcb->nHashNext = -1;
+
 	pTcb->nLocalPort = nLocalPort;
 
 	pTcb->ISS = Hardware::Get()->Millis();
@@ -315,6 +364,8 @@ static void tcp_init_tcb(struct tcb *pTcb, const uint16_t nLocalPort) {
 	NEW_STATE(pTcb, STATE_LISTEN);
 }
 
+static void tcp_timer(TimerHandle_t nHandle);
+
 __attribute__((cold)) void tcp_init() {
 	DEBUG_ENTRY
 
@@ -328,6 +379,9 @@ __attribute__((cold)) void tcp_init() {
 	s_tcp.ip4.ttl = 64;
 	s_tcp.ip4.proto = IPv4_PROTO_TCP;
 
+	[[maybe_unused]] const auto nTimerId = SoftwareTimerAdd(TCP_ACK_DELAY_MILLIS, tcp_timer);
+	assert(nTimerId >= 0);
+
 	DEBUG_EXIT
 }
 
@@ -348,28 +402,25 @@ struct tcpPseudo {
 
 static constexpr uint32_t TCP_PSEUDO_LEN = 12;
 
-static uint16_t tcp_checksum_pseudo_header(struct t_tcp *pTcp, const struct tcb *pTcb, uint16_t nLength) {
-	uint8_t buf[TCP_PSEUDO_LEN];
-	// Store current data before TCP header in temporary buffer
-	auto *pseu = reinterpret_cast<struct tcpPseudo *>(reinterpret_cast<uint8_t *>(&pTcp->tcp) - TCP_PSEUDO_LEN);
-	memcpy(buf, pseu, TCP_PSEUDO_LEN);
-
-	// Generate TCP psuedo header
-	std::memcpy(pseu->srcIp, pTcb->localIp, IPv4_ADDR_LEN);
-	std::memcpy(pseu->dstIp, pTcb->remoteIp, IPv4_ADDR_LEN);
-	pseu->zero = 0;
-	pseu->proto = IPv4_PROTO_TCP;
-	pseu->length = __builtin_bswap16(nLength);
+/*
+ * The TCP data is already summed after it was copied into the segment
+ */
+static uint16_t tcp_checksum_pseudo_header(const struct t_tcp *pTcp, const struct tcb *pTcb, uint16_t nLength, uint32_t nHeaderLength, uint32_t nDataSum) {
+	struct tcpPseudo pseu __attribute__((aligned(4)));
 
-	const auto nSum = net_chksum(pseu, nLength + TCP_PSEUDO_LEN);
+	std::memcpy(pseu.srcIp, pTcb->localIp, IPv4_ADDR_LEN);
+	std::memcpy(pseu.dstIp, pTcb->remoteIp, IPv4_ADDR_LEN);
+	pseu.zero = 0;
+	pseu.proto = IPv4_PROTO_TCP;
+	pseu.length = __builtin_bswap16(nLength);
 
-	// Restore data before TCP header from temporary buffer
-	memcpy(pseu, buf, TCP_PSEUDO_LEN);
+	auto nSum = net_chksum_add(&pseu, TCP_PSEUDO_LEN, nDataSum);
+	nSum = net_chksum_add(&pTcp->tcp, nHeaderLength, nSum);
 
-	return nSum;
+	return net_chksum_finish(nSum);
 }
 
-static void tcp_send_segment(const struct tcb *pTcb, const struct SendInfo &sendInfo) {
+static void tcp_send_segment(struct tcb *pTcb, const struct SendInfo &sendInfo) {
 	uint32_t nDataOffset = 5; /*  Data Offset:  4 bits
 	The number of 32 bit words in the TCP Header.  This indicates where
     the data begins.  The TCP header (even one including options) is an
@@ -429,10 +480,12 @@ static void tcp_send_segment(const struct tcb *pTcb, const struct SendInfo &send
 
 	DEBUG_PRINTF("SEQ=%u, ACK=%u, tcplen=%u, data_offset=%u, p_tcb->TX.size=%u", s_tcp.tcp.seqnum, s_tcp.tcp.acknum, tcplen, nDataOffset, pTcb->TX.size);
 
+	uint32_t nDataSum = 0;
+
 	if (pTcb->TX.data != nullptr) {
-		for (uint32_t i = 0; i < pTcb->TX.size; i++) {
-			*pData++ = pTcb->TX.data[i];
-		}
+		// Separate passes, net_chksum_copy_add() is slower than memcpy() and net_chksum_add() on the host
+		memcpy(pData, pTcb->TX.data, pTcb->TX.size);
+		nDataSum = net_chksum_add(pData, pTcb->TX.size, 0);
 	}
 
 	s_tcp.tcp.srcpt = __builtin_bswap16(s_tcp.tcp.srcpt);
@@ -441,12 +494,16 @@ static void tcp_send_segment(const struct tcb *pTcb, const struct SendInfo &send
 	s_tcp.tcp.window = __builtin_bswap16(s_tcp.tcp.window);
 	s_tcp.tcp.urgent = __builtin_bswap16(s_tcp.tcp.urgent);
 
-	s_tcp.tcp.checksum = tcp_checksum_pseudo_header(&s_tcp, pTcb, static_cast<uint16_t>(tcplen));
+	s_tcp.tcp.checksum = tcp_checksum_pseudo_header(&s_tcp, pTcb, static_cast<uint16_t>(tcplen), nHeaderLength, nDataSum);
 
 	emac_eth_send(reinterpret_cast<void *>(&s_tcp), tcplen + sizeof(struct ip4_header) + sizeof(struct ether_header));
+
+	if (sendInfo.CTL & Control::ACK) {
+		pTcb->nAckPending = 0;
+	}
 }
 
-static void send_reset(struct t_tcp *pTcp, const struct tcb *pTcb) {
+static void send_reset(struct t_tcp *pTcp, struct tcb *pTcb) {
 	DEBUG_ENTRY
 
 	if (pTcp->tcp.control & Control::RST) {
@@ -480,10 +537,27 @@ static void send_reset(struct t_tcp *pTcp, const struct tcb *pTcb) {
 	DEBUG_EXIT
 }
 
+static void send_ack(struct tcb *pTCB) {
+	SendInfo sendInfo;
+	sendInfo.SEQ = pTCB->SND.NXT;
+	sendInfo.ACK = pTCB->RCV.NXT;
+	sendInfo.CTL = Control::ACK;
+
+	tcp_send_segment(pTCB, sendInfo);
+}
+
+/*
+ * The part of the send window which is not in flight
+ */
+static uint32_t tcp_usable_window(const struct tcb *pTCB) {
+	const auto nInFlight = pTCB->SND.NXT - pTCB->SND.UNA;
+	return (pTCB->SND.WND > nInFlight) ? pTCB->SND.WND - nInFlight : 0;
+}
+
 static bool tcp_send_data(struct tcb *pTCB, const uint8_t *pBuffer, const uint32_t nLength, const bool isLastSegment) {
 	assert(nLength != 0);
 	assert(nLength <= static_cast<uint32_t>(TCP_DATA_SIZE));
-	assert(nLength <= pTCB->SND.WND);
+	assert(nLength <= tcp_usable_window(pTCB));
 
 	DEBUG_PRINTF("nLength=%u, pTCB->SND.WND=%u", nLength, pTCB->SND.WND);
 
@@ -504,11 +578,52 @@ static bool tcp_send_data(struct tcb *pTCB, const uint8_t *pBuffer, const uint32
 	pTCB->TX.size = 0;
 
 	pTCB->SND.NXT += nLength;
-	pTCB->SND.WND -= nLength;
 
 	return false;
 }
 
+/*
+ * Sends the queued data as long as the peer has room for it.
+ * A segment is only sent in full, so no small segments are sent
+ * while the window is opening.
+ */
+static void tcp_send_queued(struct tcb *pTCB) {
+	auto& queue = pTCB->TXQ;
+
+	while (!queue.IsEmpty()) {
+		const auto& segment = queue.GetFront();
+		const auto nLength = std::min(segment.nLength, static_cast<uint32_t>(TCP_TX_MSS));
+
+		if (nLength > tcp_usable_window(pTCB)) {
+			return;
+		}
+
+		tcp_send_data(pTCB, segment.pData, nLength, nLength == segment.nLength);
+		queue.Consume(nLength);
+	}
+}
+
+/*
+ * Segment text is only accepted in these states, see the seventh step in tcp_input()
+ */
+static bool tcb_is_receiving(const struct tcb& tcb) {
+	return (tcb.state == STATE_ESTABLISHED) || (tcb.state == STATE_FIN_WAIT_1) || (tcb.state == STATE_FIN_WAIT_2);
+}
+
+static void tcp_timer([[maybe_unused]] TimerHandle_t nHandle) {
+	for (auto& port : s_Ports) {
+		for (auto& tcb : port.TCB) {
+			if (tcb.nAckPending != 0) {
+				if (tcb_is_receiving(tcb)) {
+					send_ack(&tcb);
+				} else {
+					tcb.nAckPending = 0;
+				}
+			}
+		}
+	}
+}
+
 struct Options {
 	uint8_t nKind;
 	uint8_t nLength;
@@ -571,7 +686,14 @@ static void tcp_scan_options(struct t_tcp *pTcp, struct tcb *pTcb, const int32_t
 __attribute__((hot)) void tcp_run() {
 	for (auto& port : s_Ports) {
 		for (auto& tcb : port.TCB) {
-			if (tcb.state == STATE_CLOSE_WAIT) {
+			if ((tcb.state != STATE_ESTABLISHED) && (tcb.state != STATE_CLOSE_WAIT)) {
+				continue;
+			}
+
+			tcp_send_queued(&tcb);
+
+			// The FIN is sent when all data is sent
+			if ((tcb.state == STATE_CLOSE_WAIT) && tcb.TXQ.IsEmpty()) {
 				SendInfo info;
 				info.SEQ = tcb.SND.NXT;
 				info.ACK = tcb.RCV.NXT;
@@ -584,28 +706,17 @@ __attribute__((hot)) void tcp_run() {
 				tcb.SND.NXT++;
 			}
 		}
-#if defined(TCP_TX_QUEUE_SIZE)
-		auto& transmissionQueue = port.transmissionQueue;
-		auto& dataSegmentQueue = transmissionQueue.dataSegmentQueue;
-
-		while (!dataSegmentQueue.IsEmpty() && dataSegmentQueue.GetFront().nLength <= transmissionQueue.pTcb->SND.WND) {
-			const auto &segment = dataSegmentQueue.GetFront();
-			tcp_send_data(transmissionQueue.pTcb, segment.buffer, segment.nLength, segment.isLastSegment);
-			dataSegmentQueue.Pop();
-		}
-#endif
 	}
 }
 
 static bool find_active_tcb(const t_tcp *pTcp, const uint32_t nIndexPort, uint32_t& nIndexTCB) {
-	for (nIndexTCB = 0; nIndexTCB < TCP_MAX_TCBS_ALLOWED; nIndexTCB++) {
-		const auto *pTCB = &s_Ports[nIndexPort].TCB[nIndexTCB];
+	const auto& port = s_Ports[nIndexPort];
 
-		if (pTCB->state == STATE_LISTEN) {
-			continue;
-		}
+	for (auto nIndex = port.tcbHash[tcb_hash(pTcp->ip4.src, pTcp->tcp.srcpt)]; nIndex >= 0; nIndex = port.TCB[nIndex].nHashNext) {
+		const auto *pTCB = &port.TCB[nIndex];
 
 		if (pTCB->nRemotePort == pTcp->tcp.srcpt && memcmp(pTCB->remoteIp, pTcp->ip4.src, IPv4_ADDR_LEN) == 0) {
+			nIndexTCB = static_cast<uint32_t>(nIndex);
 			return true;
 		}
 	}
@@ -626,25 +737,21 @@ static bool find_listening_tcb(const uint32_t nIndexPort, uint32_t& nIndexTCB) {
 	return false;
 }
 
-static void find_tcb(const t_tcp *pTcp, uint32_t& nIndexPort, uint32_t& nIndexTCB) {
-	// Search each port for a match with the destination port
-	for (nIndexPort = 0; nIndexPort < TCP_MAX_PORTS_ALLOWED; nIndexPort++) {
-		// Search for an existing active TCB matching the source IP and port
-		if (find_active_tcb(pTcp, nIndexPort, nIndexTCB)) {
-			DEBUG_EXIT
-			return;
-		}
-
-		// If no matching TCB, find an available TCB in listening state
-		if (find_listening_tcb(nIndexPort, nIndexTCB)) {
-			DEBUG_EXIT
-			return;
-		}
+static void find_tcb(const t_tcp *pTcp, const uint32_t nIndexPort, uint32_t& nIndexTCB) {
+	// Search for an existing active TCB matching the source IP and port
+	if (find_active_tcb(pTcp, nIndexPort, nIndexTCB)) {
+		DEBUG_EXIT
+		return;
+	}
 
-		DEBUG_PUTS("If no available TCB, trigger retransmission");
+	// If no matching TCB, find an available TCB in listening state
+	if (find_listening_tcb(nIndexPort, nIndexTCB)) {
 		DEBUG_EXIT
 		return;
 	}
+
+	DEBUG_PUTS("If no available TCB, trigger retransmission");
+	DEBUG_EXIT
 }
 
 /**
@@ -771,6 +878,7 @@ __attribute__((hot)) void tcp_input(struct t_tcp *pTcp) {
 			pTCB->SND.UNA = pTCB->ISS;
 
 			NEW_STATE(pTCB, STATE_SYN_RECEIVED);
+			tcb_hash_insert(nIndexPort, nIndexTCB);
 			DEBUG_EXIT
 			return;
 		}
@@ -1049,18 +1157,17 @@ __attribute__((hot)) void tcp_input(struct t_tcp *pTcp) {
 			if (nDataLength > 0) {
 				if (SEG_SEQ == pTCB->RCV.NXT) {
 					assert(s_Ports[nIndexPort].callback != nullptr);
-					// Update sequence and window
+					// The data is consumed by the callback, so the receive window stays open
 					pTCB->RCV.NXT += nDataLength;
-					pTCB->RCV.WND -= nDataLength;
+					pTCB->nAckPending++;
 
 					s_Ports[nIndexPort].callback(nIndexTCB, reinterpret_cast<uint8_t *>(&pTcp->tcp) + nDataOffset, nDataLength);
 
-					// Send acknowledgment
-					SendInfo sendInfo;
-					sendInfo.SEQ = pTCB->SND.NXT;
-					sendInfo.ACK = pTCB->RCV.NXT;
-					sendInfo.CTL = Control::ACK;
-					tcp_send_segment(pTCB, sendInfo);
+					// Delayed acknowledgment, RFC 1122 section 4.2.3.2
+					// Not needed when the callback has sent data
+					if (pTCB->nAckPending >= 2) {
+						send_ack(pTCB);
+					}
 				} else {
 					SendInfo sendInfo;
 					sendInfo.SEQ = pTCB->SND.NXT;
@@ -1172,14 +1279,15 @@ int32_t tcp_begin(const uint16_t nLocalPort, TcpCallbackFunctionPtr callback) {
 			s_Ports[i].callback = callback;
 			s_Ports[i].nLocalPort = nLocalPort;
 
+			for (auto& nEntry : s_Ports[i].tcbHash) {
+				nEntry = -1;
+			}
+
 			for (uint32_t nIndexTCB = 0; nIndexTCB < TCP_MAX_TCBS_ALLOWED; nIndexTCB++) {
 				// create transmission control block's (TCB)
 				tcp_init_tcb(&s_Ports[i].TCB[nIndexTCB], nLocalPort);
 			}
 
-#if defined(TCP_TX_QUEUE_SIZE)
-			s_Ports[i].transmissionQueue.pTcb = nullptr;
-#endif
 			DEBUG_PRINTF("i=%d, nLocalPort=%d[%x]", i, nLocalPort, nLocalPort);
 			return i;
 		}
@@ -1197,7 +1305,7 @@ int32_t tcp_end([[maybe_unused]] const int32_t nHandle) {
 	return 0;
 }
 
-void tcp_write(const int32_t nHandleListen, const uint8_t *pBuffer, uint32_t nLength, uint32_t nHandleConnection) {
+bool tcp_write(const int32_t nHandleListen, const uint8_t *pBuffer, uint32_t nLength, uint32_t nHandleConnection) {
 	assert(nHandleListen >= 0);
 	assert(nHandleListen < TCP_MAX_PORTS_ALLOWED);
 	assert(pBuffer != nullptr);
@@ -1206,38 +1314,19 @@ void tcp_write(const int32_t nHandleListen, const uint8_t *pBuffer, uint32_t nLe
 	auto *pTCB = &s_Ports[nHandleListen].TCB[nHandleConnection];
 	assert(pTCB != nullptr);
 
-	const auto *p = pBuffer;
-
-	while ((nLength > 0) && (nLength <= pTCB->SND.WND)) {
-		const auto nWriteLength = (nLength > TCP_DATA_SIZE) ? TCP_DATA_SIZE : nLength;
-		const bool isLastSegment = (nLength < TCP_DATA_SIZE);
-
-		tcp_send_data(pTCB, p, nWriteLength, isLastSegment);
-
-		p += nWriteLength;
-		nLength -= nWriteLength;
+	if (nLength == 0) {
+		return true;
 	}
 
-	if (nLength > 0) {
-#if defined(TCP_TX_QUEUE_SIZE)
-		auto& transmissionQueue = s_Ports[nHandleListen].transmissionQueue;
-		auto& dataSegmentQueue = transmissionQueue.dataSegmentQueue;
-		assert(dataSegmentQueue.IsEmpty());
-
-		transmissionQueue.pTcb = pTCB;
-
-		while (nLength > 0) {
-			assert(!dataSegmentQueue.IsFull());
-			const auto nWriteLength = (nLength > TCP_DATA_SIZE) ? TCP_DATA_SIZE : nLength;
-			const bool isLastSegment = (nLength < TCP_DATA_SIZE);
-			dataSegmentQueue.Push(p, nWriteLength, isLastSegment);
-			p += nWriteLength;
-			nLength -= nWriteLength;
-		}
-#else
-		assert(0);
+	if (!pTCB->TXQ.Push(pBuffer, nLength)) {
+#ifndef NDEBUG
+		console_error("tcp_write\n");
 #endif
+		return false;
 	}
+
+	tcp_send_queued(pTCB);
+	return true;
 }
 
 void tcp_abort(const int32_t nHandleListen, const uint32_t nHandleConnection) {
@@ -1254,6 +1343,10 @@ void tcp_abort(const int32_t nHandleListen, const uint32_t nHandleConnection) {
 	info.ACK = pTCB->RCV.NXT;
 
 	tcp_send_segment(pTCB, info);
+
+	// No delayed acknowledgment and no queued data after a reset
+	pTCB->nAckPending = 0;
+	pTCB->TXQ.Clear();
 }
 
 }  // namespace net
@@ -2,7 +2,7 @@
  * @file udp.cpp
  *
  */
-/* Copyright (C) 2018-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2018-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -41,12 +41,50 @@
 #include "net_config.h"
 #include "net/protocol/udp.h"
 #include "net/udp.h"
+#include "net/hash.h"
 #include "net_private.h"
 #include "net_memcpy.h"
 
 #include "debug.h"
 
 namespace net {
+namespace udp {
+#if !defined UDP_MAX_TEMPLATES
+static constexpr auto MAX_TEMPLATES = 16;
+#else
+static constexpr auto MAX_TEMPLATES = UDP_MAX_TEMPLATES;
+#endif
+static_assert((MAX_TEMPLATES & (MAX_TEMPLATES - 1)) == 0, "MAX_TEMPLATES must be a power of 2");
+
+/**
+ * Ready to send Ethernet, IPv4 and UDP header for a port and destination.
+ */
+struct Template {
+	uint8_t header[UDP_PACKET_HEADERS_SIZE];
+	uint32_t nRemoteIp;
+	uint32_t nNextHopIp;	///< The ARP cache entry the destination MAC address is from, 0 when none
+	uint32_t nChksum;	///< Unfolded IPv4 header sum, without the length and the id
+	uint16_t nRemotePort;
+	int16_t nIndex;		///< -1 is not valid
+};
+
+/**
+ * Local port to port index, open addressing with linear probing.
+ * At most half of the entries are used, so a lookup always ends on an empty entry.
+ */
+static constexpr uint32_t PORT_HASH_SIZE = net::hash_size(2 * UDP_MAX_PORTS_ALLOWED);
+static constexpr uint32_t PORT_HASH_MASK = PORT_HASH_SIZE - 1;
+
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+static constexpr uint32_t RX_RING_SIZE = 1;	///< The datagram is in the EMAC receive buffer
+#else
+static constexpr uint32_t RX_RING_SIZE = UDP_RX_RING_SIZE;
+#endif
+static constexpr uint32_t RX_RING_MASK = RX_RING_SIZE - 1;
+static_assert((RX_RING_SIZE & RX_RING_MASK) == 0, "UDP_RX_RING_SIZE must be a power of 2");
+static_assert(RX_RING_SIZE < 256);
+}  // namespace udp
+
 namespace globals {
 extern uint32_t nBroadcastMask;
 }  // namespace globals
@@ -59,24 +97,86 @@ struct PortInfo {
 struct Data {
 	uint32_t nFromIp;
 	uint32_t nSize;
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+	const uint8_t *pData;	///< Borrowed from the EMAC receive buffer
+#else
 	uint8_t data[UDP_DATA_SIZE];
+#endif
 	uint16_t nFromPort;
 };
 
+/**
+ * The datagrams for a polled port, oldest at nTail.
+ * The datagram returned by udp_recv2() is kept (bHeld) until the next receive for the port,
+ * or until its slot is needed for a new datagram.
+ */
 struct Port {
 	PortInfo info;
-	Data data ALIGNED;
+	uint32_t nOverruns;		///< Datagrams dropped because the ring was full
+	uint8_t nHead;
+	uint8_t nTail;
+	bool bHeld;
+	Data data[udp::RX_RING_SIZE] ALIGNED;
 } ALIGNED;
 
 static Port s_Ports[UDP_MAX_PORTS_ALLOWED] SECTION_NETWORK ALIGNED;
 static uint16_t s_id SECTION_NETWORK ALIGNED;
 static uint8_t s_multicast_mac[ETH_ADDR_LEN] SECTION_NETWORK ALIGNED;
+static udp::Template s_Templates[udp::MAX_TEMPLATES] SECTION_NETWORK ALIGNED;
+static int8_t s_PortHash[udp::PORT_HASH_SIZE] SECTION_NETWORK ALIGNED;
+
+static uint32_t port_hash(const uint16_t nPort) {
+	return net::hash_fibonacci(nPort, udp::PORT_HASH_MASK);
+}
+
+static void port_hash_build() {
+	for (auto& nEntry : s_PortHash) {
+		nEntry = -1;
+	}
+
+	for (int32_t nPortIndex = 0; nPortIndex < UDP_MAX_PORTS_ALLOWED; nPortIndex++) {
+		const auto nPort = s_Ports[nPortIndex].info.nPort;
+
+		if (nPort != 0) {
+			auto i = port_hash(nPort);
+
+			while (s_PortHash[i] >= 0) {
+				i = (i + 1) & udp::PORT_HASH_MASK;
+			}
+
+			s_PortHash[i] = static_cast<int8_t>(nPortIndex);
+		}
+	}
+}
+
+static int32_t port_lookup(const uint16_t nPort) {
+	for (auto i = port_hash(nPort); s_PortHash[i] >= 0; i = (i + 1) & udp::PORT_HASH_MASK) {
+		const auto nPortIndex = s_PortHash[i];
+
+		if (s_Ports[nPortIndex].info.nPort == nPort) {
+			return nPortIndex;
+		}
+	}
+
+	return -1;
+}
+
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+static int32_t s_nBorrowedIndex SECTION_NETWORK;	///< Set in udp_init(), the section is not initialized
+#endif
 
 void __attribute__((cold)) udp_init() {
 	// Multicast fixed part
 	s_multicast_mac[0] = 0x01;
 	s_multicast_mac[1] = 0x00;
 	s_multicast_mac[2] = 0x5E;
+
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+	s_nBorrowedIndex = -1;
+#endif
+
+	port_hash_build();
+	udp_template_invalidate();
 }
 
 void __attribute__((cold)) udp_shutdown() {
@@ -85,41 +185,192 @@ void __attribute__((cold)) udp_shutdown() {
 	DEBUG_EXIT
 }
 
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+/**
+ * A polled port gets a view of the EMAC receive buffer, the packet is freed with the next udp_release().
+ * A callback gets the same view, the packet is freed when the callback returns.
+ * Data needed after that must be copied by the consumer.
+ */
 __attribute__((hot)) void udp_input(const struct t_udp *pUdp) {
 	const auto nDestinationPort = __builtin_bswap16(pUdp->udp.destination_port);
+	const auto nPortIndex = port_lookup(nDestinationPort);
 
-	for (uint32_t nPortIndex = 0; nPortIndex < UDP_MAX_PORTS_ALLOWED; nPortIndex++) {
+	if (__builtin_expect((nPortIndex >= 0), 1)) {
 		const auto& portInfo = s_Ports[nPortIndex].info;
-		auto& data = s_Ports[nPortIndex].data;
+		auto& data = s_Ports[nPortIndex].data[0];
 
-		if (portInfo.nPort == nDestinationPort) {
-			if (__builtin_expect ((data.nSize != 0), 0)) {
-				DEBUG_PRINTF("%d[%x]", nDestinationPort, nDestinationPort);
-			}
+		const auto nDataLength = static_cast<uint32_t>(__builtin_bswap16(pUdp->udp.len) - UDP_HEADER_SIZE);
+		const auto nFromIp = net::memcpy_ip(pUdp->ip4.src);
+		const auto nFromPort = __builtin_bswap16(pUdp->udp.source_port);
 
-			const auto nDataLength = static_cast<uint32_t>(__builtin_bswap16(pUdp->udp.len) - UDP_HEADER_SIZE);
-			const auto i = std::min(static_cast<uint32_t>(UDP_DATA_SIZE), nDataLength);
+		if (portInfo.callback != nullptr) {
+			portInfo.callback(pUdp->udp.data, nDataLength, nFromIp, nFromPort);
+			emac_free_pkt();
+			return;
+		}
 
-			net::memcpy(data.data, pUdp->udp.data, i);
+		assert(s_nBorrowedIndex == -1);
 
-			data.nFromIp = net::memcpy_ip(pUdp->ip4.src);
-			data.nFromPort = __builtin_bswap16(pUdp->udp.source_port);
-			data.nSize = i;
+		data.pData = pUdp->udp.data;
+		data.nFromIp = nFromIp;
+		data.nFromPort = nFromPort;
+		data.nSize = std::min(static_cast<uint32_t>(UDP_DATA_SIZE), nDataLength);
 
-			emac_free_pkt();
+		s_nBorrowedIndex = nPortIndex;
+		return;
+	}
 
-			if (portInfo.callback != nullptr) {
-				portInfo.callback(data.data, nDataLength, data.nFromIp, data.nFromPort);
-			}
+	emac_free_pkt();
+
+	DEBUG_PRINTF(IPSTR ":%d[%x] " MACSTR, pUdp->ip4.src[0],pUdp->ip4.src[1],pUdp->ip4.src[2],pUdp->ip4.src[3], nDestinationPort, nDestinationPort, MAC2STR(pUdp->ether.dst));
+}
+
+/**
+ * Gives the borrowed receive buffer back to the EMAC, a datagram not read by then is dropped.
+ * Must be called before the next emac_eth_recv().
+ */
+void udp_release() {
+	if (s_nBorrowedIndex >= 0) {
+		auto& port = s_Ports[s_nBorrowedIndex];
+
+		if (port.data[0].nSize != 0) {
+			port.nOverruns++;
+			port.data[0].nSize = 0;
+		}
+
+		s_nBorrowedIndex = -1;
+		emac_free_pkt();
+	}
+}
+#else
+__attribute__((hot)) void udp_input(const struct t_udp *pUdp) {
+	const auto nDestinationPort = __builtin_bswap16(pUdp->udp.destination_port);
+	const auto nPortIndex = port_lookup(nDestinationPort);
+
+	if (__builtin_expect((nPortIndex >= 0), 1)) {
+		auto& port = s_Ports[nPortIndex];
+		const auto& portInfo = port.info;
+		const auto nDataLength = static_cast<uint32_t>(__builtin_bswap16(pUdp->udp.len) - UDP_HEADER_SIZE);
+		const auto i = std::min(static_cast<uint32_t>(UDP_DATA_SIZE), nDataLength);
 
+		if (portInfo.callback != nullptr) {
+			auto& data = port.data[port.nHead & udp::RX_RING_MASK];
+
+			net::memcpy(data.data, pUdp->udp.data, i);
+			emac_free_pkt();
+
+			portInfo.callback(data.data, nDataLength, net::memcpy_ip(pUdp->ip4.src), __builtin_bswap16(pUdp->udp.source_port));
 			return;
 		}
+
+		if (__builtin_expect((static_cast<uint8_t>(port.nHead - port.nTail) == udp::RX_RING_SIZE), 0)) {
+			if (!port.bHeld) {
+				port.nOverruns++;
+				emac_free_pkt();
+				DEBUG_PRINTF("%d[%x] overrun", nDestinationPort, nDestinationPort);
+				return;
+			}
+			// The datagram returned by udp_recv2() is reused
+			port.bHeld = false;
+			port.nTail++;
+		}
+
+		auto& data = port.data[port.nHead & udp::RX_RING_MASK];
+
+		net::memcpy(data.data, pUdp->udp.data, i);
+
+		data.nFromIp = net::memcpy_ip(pUdp->ip4.src);
+		data.nFromPort = __builtin_bswap16(pUdp->udp.source_port);
+		data.nSize = i;
+
+		port.nHead++;
+
+		emac_free_pkt();
+
+		return;
 	}
 
 	emac_free_pkt();
 
 	DEBUG_PRINTF(IPSTR ":%d[%x] " MACSTR, pUdp->ip4.src[0],pUdp->ip4.src[1],pUdp->ip4.src[2],pUdp->ip4.src[3], nDestinationPort, nDestinationPort, MAC2STR(pUdp->ether.dst));
 }
+#endif
+
+static uint32_t template_index(const int32_t nIndex, const uint32_t nRemoteIp, const uint16_t nRemotePort) {
+	auto nHash = nRemoteIp ^ (nRemoteIp >> 16) ^ nRemotePort ^ static_cast<uint32_t>(nIndex);
+	nHash ^= (nHash >> 8);
+	return nHash & (udp::MAX_TEMPLATES - 1);
+}
+
+/**
+ * Builds the Ethernet, IPv4 and UDP header for the destination in the transmit buffer.
+ * The header is stored in the template only when it is complete, so an unresolved
+ * destination does not evict the template cached in the slot.
+ * Returns false when the MAC address of a unicast destination is not in the ARP cache.
+ */
+static bool template_build(udp::Template& tmpl, t_udp *pHeader, const int32_t nIndex, const uint32_t nRemoteIp, const uint16_t nRemotePort) {
+	// Ethernet
+	std::memcpy(pHeader->ether.src, net::globals::netif_default.hwaddr, ETH_ADDR_LEN);
+	pHeader->ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
+
+	//IPv4
+	pHeader->ip4.ver_ihl = 0x45;
+	pHeader->ip4.tos = 0;
+	pHeader->ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
+	pHeader->ip4.ttl = 64;
+	pHeader->ip4.proto = IPv4_PROTO_UDP;
+	pHeader->ip4.id = 0;
+	pHeader->ip4.len = 0;
+	pHeader->ip4.chksum = 0;
+	net::memcpy_ip(pHeader->ip4.src, net::globals::netif_default.ip.addr);
+	net::memcpy_ip(pHeader->ip4.dst, nRemoteIp);
+
+	//UDP
+	pHeader->udp.source_port = __builtin_bswap16(s_Ports[nIndex].info.nPort);
+	pHeader->udp.destination_port = __builtin_bswap16(nRemotePort);
+	pHeader->udp.len = 0;
+	pHeader->udp.checksum = 0;
+
+	uint32_t nNextHopIp = 0;
+
+	if ((nRemoteIp == net::IPADDR_BROADCAST) || ((nRemoteIp & net::globals::nBroadcastMask) == net::globals::nBroadcastMask)) {
+		net::memset<0xFF, ETH_ADDR_LEN>(pHeader->ether.dst);
+	} else if ((nRemoteIp & 0xF0) == 0xE0) { // Multicast, we know the MAC Address
+		typedef union pcast32 {
+			uint32_t u32;
+			uint8_t u8[4];
+		} _pcast32;
+		_pcast32 multicast_ip;
+
+		multicast_ip.u32 = nRemoteIp;
+		s_multicast_mac[3] = multicast_ip.u8[1] & 0x7F;
+		s_multicast_mac[4] = multicast_ip.u8[2];
+		s_multicast_mac[5] = multicast_ip.u8[3];
+
+		std::memcpy(pHeader->ether.dst, s_multicast_mac, ETH_ADDR_LEN);
+	} else if (net::arp_lookup(nRemoteIp, pHeader->ether.dst)) {
+		nNextHopIp = net::arp_next_hop(nRemoteIp);
+	} else {
+		return false;
+	}
+
+	// One's complement sum without the length and the id, these are added for each datagram (RFC 1624)
+	const auto *pWords = reinterpret_cast<const uint16_t *>(reinterpret_cast<const uint8_t *>(pHeader) + sizeof(struct ether_header));
+	uint32_t nSum = 0;
+
+	for (uint32_t i = 0; i < (sizeof(struct ip4_header) / 2); i++) {
+		nSum += pWords[i];
+	}
+
+	net::memcpy(tmpl.header, pHeader, UDP_PACKET_HEADERS_SIZE);
+	tmpl.nChksum = nSum;
+	tmpl.nRemoteIp = nRemoteIp;
+	tmpl.nNextHopIp = nNextHopIp;
+	tmpl.nRemotePort = nRemotePort;
+	tmpl.nIndex = static_cast<int16_t>(nIndex);
+
+	return true;
+}
 
 template<net::arp::EthSend S>
 static void udp_send_implementation(int nIndex, const uint8_t *pData, uint32_t nSize, uint32_t nRemoteIp, uint16_t nRemotePort) {
@@ -128,68 +379,40 @@ static void udp_send_implementation(int nIndex, const uint8_t *pData, uint32_t n
 	assert(s_Ports[nIndex].info.nPort != 0);
 
 	auto *pOutBuffer = reinterpret_cast<t_udp *>(emac_eth_send_get_dma_buffer());
+	auto& tmpl = s_Templates[template_index(nIndex, nRemoteIp, nRemotePort)];
+	auto isResolved = true;
 
-	// Ethernet
-	std::memcpy(pOutBuffer->ether.src, net::globals::netif_default.hwaddr, ETH_ADDR_LEN);
-	pOutBuffer->ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
+	if ((tmpl.nIndex == nIndex) && (tmpl.nRemoteIp == nRemoteIp) && (tmpl.nRemotePort == nRemotePort)) {
+		net::memcpy(pOutBuffer, tmpl.header, UDP_PACKET_HEADERS_SIZE);
+	} else {
+		isResolved = template_build(tmpl, pOutBuffer, nIndex, nRemoteIp, nRemotePort);
+	}
 
-	//IPv4
-	pOutBuffer->ip4.ver_ihl = 0x45;
-	pOutBuffer->ip4.tos = 0;
-	pOutBuffer->ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
-	pOutBuffer->ip4.ttl = 64;
-	pOutBuffer->ip4.proto = IPv4_PROTO_UDP;
 	pOutBuffer->ip4.id = ++s_id;
 	pOutBuffer->ip4.len = __builtin_bswap16(static_cast<uint16_t>(nSize + IPv4_UDP_HEADERS_SIZE));
-	pOutBuffer->ip4.chksum = 0;
-	net::memcpy_ip(pOutBuffer->ip4.src, net::globals::netif_default.ip.addr);
-
-	//UDP
-	pOutBuffer->udp.source_port = __builtin_bswap16(s_Ports[nIndex].info.nPort);
-	pOutBuffer->udp.destination_port = __builtin_bswap16(nRemotePort);
 	pOutBuffer->udp.len = __builtin_bswap16(static_cast<uint16_t>(nSize + UDP_HEADER_SIZE));
-	pOutBuffer->udp.checksum = 0;
 
 	nSize = std::min(static_cast<uint32_t>(UDP_DATA_SIZE), nSize);
 
 	net::memcpy(pOutBuffer->udp.data, pData, nSize);
 
-	if (nRemoteIp == net::IPADDR_BROADCAST) {
-		net::memset<0xFF, ETH_ADDR_LEN>(pOutBuffer->ether.dst);
-		net::memset<0xFF, IPv4_ADDR_LEN>(pOutBuffer->ip4.dst);
-	} else if ((nRemoteIp & net::globals::nBroadcastMask) == net::globals::nBroadcastMask) {
-		net::memset<0xFF, ETH_ADDR_LEN>(pOutBuffer->ether.dst);
-		net::memcpy_ip(pOutBuffer->ip4.dst, nRemoteIp);
-	} else {
-		if ((nRemoteIp & 0xF0) == 0xE0) { // Multicast, we know the MAC Address
-			typedef union pcast32 {
-				uint32_t u32;
-				uint8_t u8[4];
-			} _pcast32;
-			_pcast32 multicast_ip;
-
-			multicast_ip.u32 = nRemoteIp;
-			s_multicast_mac[3] = multicast_ip.u8[1] & 0x7F;
-			s_multicast_mac[4] = multicast_ip.u8[2];
-			s_multicast_mac[5] = multicast_ip.u8[3];
-
-			std::memcpy(pOutBuffer->ether.dst, s_multicast_mac, ETH_ADDR_LEN);
-			net::memcpy_ip(pOutBuffer->ip4.dst, nRemoteIp);
-		} else {
-			if constexpr (S == net::arp::EthSend::IS_NORMAL) {
-				net::arp_send(pOutBuffer, nSize + UDP_PACKET_HEADERS_SIZE, nRemoteIp);
-			}
+	if (__builtin_expect(!isResolved, 0)) {
+		if constexpr (S == net::arp::EthSend::IS_NORMAL) {
+			net::arp_send(pOutBuffer, nSize + UDP_PACKET_HEADERS_SIZE, nRemoteIp);
+		}
 #if defined CONFIG_NET_ENABLE_PTP
-			else if constexpr (S == net::arp::EthSend::IS_TIMESTAMP) {
-				net::arp_send_timestamp(pOutBuffer, nSize + UDP_PACKET_HEADERS_SIZE, nRemoteIp);
-			}
-#endif
-			return;
+		else if constexpr (S == net::arp::EthSend::IS_TIMESTAMP) {
+			net::arp_send_timestamp(pOutBuffer, nSize + UDP_PACKET_HEADERS_SIZE, nRemoteIp);
 		}
+#endif
+		return;
 	}
 
 #if !defined (CHECKSUM_BY_HARDWARE)
-	pOutBuffer->ip4.chksum = net_chksum(reinterpret_cast<void *>(&pOutBuffer->ip4), sizeof(pOutBuffer->ip4));
+	auto nSum = tmpl.nChksum + pOutBuffer->ip4.id + pOutBuffer->ip4.len;
+	nSum = (nSum >> 16) + (nSum & 0xFFFF);
+	nSum += (nSum >> 16);
+	pOutBuffer->ip4.chksum = static_cast<uint16_t>(~nSum);
 #endif
 
 	if constexpr (S == net::arp::EthSend::IS_NORMAL) {
@@ -203,6 +426,27 @@ static void udp_send_implementation(int nIndex, const uint8_t *pData, uint32_t n
 	return;
 }
 
+/**
+ * Called when the interface addresses or the UDP ports change.
+ */
+void udp_template_invalidate() {
+	for (auto& tmpl : s_Templates) {
+		tmpl.nIndex = -1;
+	}
+}
+
+/**
+ * Called when the ARP cache entry of a next hop changes.
+ * For an off-subnet destination this is the gateway, not the destination.
+ */
+void udp_template_invalidate(const uint32_t nNextHopIp) {
+	for (auto& tmpl : s_Templates) {
+		if (tmpl.nNextHopIp == nNextHopIp) {
+			tmpl.nIndex = -1;
+		}
+	}
+}
+
 // -->
 
 int32_t udp_begin(uint16_t nLocalPort, UdpCallbackFunctionPtr callback) {
@@ -219,6 +463,9 @@ int32_t udp_begin(uint16_t nLocalPort, UdpCallbackFunctionPtr callback) {
 			portInfo.callback = callback;
 			portInfo.nPort = nLocalPort;
 
+			port_hash_build();
+			udp_template_invalidate();
+
 			DEBUG_PRINTF("i=%d, local_port=%d[%x], callback=%p", i, nLocalPort, nLocalPort, callback);
 			return i;
 		}
@@ -240,8 +487,19 @@ int32_t udp_end(uint16_t nLocalPort) {
 			portInfo.callback = nullptr;
 			portInfo.nPort = 0;
 
-			auto& data = s_Ports[i].data;
-			data.nSize = 0;
+			port_hash_build();
+
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
+			if (s_nBorrowedIndex == i) {
+				udp_release();
+			}
+#endif
+			auto& port = s_Ports[i];
+			port.nHead = 0;
+			port.nTail = 0;
+			port.bHeld = false;
+			port.nOverruns = 0;
+			port.data[0].nSize = 0;
 			return 0;
 		}
 	}
@@ -250,11 +508,12 @@ int32_t udp_end(uint16_t nLocalPort) {
 	return -1;
 }
 
+#if defined (CONFIG_NET_UDP_ZERO_COPY)
 uint32_t udp_recv1(const int32_t nIndex, uint8_t *pData, uint32_t nSize, uint32_t *pFromIp, uint16_t *FromPort) {
 	assert(nIndex >= 0);
 	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
 
-	auto& data = s_Ports[nIndex].data;
+	auto& data = s_Ports[nIndex].data[0];
 
 	if (__builtin_expect((data.nSize == 0), 1)) {
 		return 0;
@@ -262,7 +521,7 @@ uint32_t udp_recv1(const int32_t nIndex, uint8_t *pData, uint32_t nSize, uint32_
 
 	const auto i = std::min(nSize, data.nSize);
 
-	net::memcpy(pData, data.data, i);
+	net::memcpy(pData, data.pData, i);
 
 	*pFromIp = data.nFromIp;
 	*FromPort = data.nFromPort;
@@ -282,13 +541,13 @@ uint32_t udp_recv2(const int32_t nIndex, const uint8_t **pData, uint32_t *pFromI
 		return 0;
 	}
 
-	auto& data = s_Ports[nIndex].data;
+	auto& data = s_Ports[nIndex].data[0];
 
 	if (__builtin_expect((data.nSize == 0), 1)) {
 		return 0;
 	}
 
-	*pData = data.data;
+	*pData = data.pData;
 	*pFromIp = data.nFromIp;
 	*pFromPort = data.nFromPort;
 
@@ -298,6 +557,75 @@ uint32_t udp_recv2(const int32_t nIndex, const uint8_t **pData, uint32_t *pFromI
 
 	return nSize;
 }
+#else
+static Data *udp_ring_get(Port& port) {
+	if (port.bHeld) {
+		port.bHeld = false;
+		port.nTail++;
+	}
+
+	if (__builtin_expect((port.nHead == port.nTail), 1)) {
+		return nullptr;
+	}
+
+	return &port.data[port.nTail & udp::RX_RING_MASK];
+}
+
+uint32_t udp_recv1(const int32_t nIndex, uint8_t *pData, uint32_t nSize, uint32_t *pFromIp, uint16_t *FromPort) {
+	assert(nIndex >= 0);
+	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
+
+	auto& port = s_Ports[nIndex];
+	const auto *pRingData = udp_ring_get(port);
+
+	if (pRingData == nullptr) {
+		return 0;
+	}
+
+	const auto i = std::min(nSize, pRingData->nSize);
+
+	net::memcpy(pData, pRingData->data, i);
+
+	*pFromIp = pRingData->nFromIp;
+	*FromPort = pRingData->nFromPort;
+
+	port.nTail++;
+
+	return i;
+}
+
+uint32_t udp_recv2(const int32_t nIndex, const uint8_t **pData, uint32_t *pFromIp, uint16_t *pFromPort) {
+	assert(nIndex >= 0);
+	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
+
+	auto& port = s_Ports[nIndex];
+
+	if (__builtin_expect(port.info.callback != nullptr, 0)) {
+		return 0;
+	}
+
+	const auto *pRingData = udp_ring_get(port);
+
+	if (pRingData == nullptr) {
+		return 0;
+	}
+
+	*pData = pRingData->data;
+	*pFromIp = pRingData->nFromIp;
+	*pFromPort = pRingData->nFromPort;
+
+	port.bHeld = true;
+
+	return pRingData->nSize;
+}
+#endif
+
+uint32_t udp_get_overruns(const int32_t nIndex) {
+	assert(nIndex >= 0);
+	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
+
+	return s_Ports[nIndex].nOverruns;
+}
 
 void udp_send(const int32_t nIndex, const uint8_t *pData, uint32_t nSize, uint32_t nRemoteIp, uint16_t nRemotePort) {
 	udp_send_implementation<net::arp::EthSend::IS_NORMAL>(nIndex, pData, nSize, nRemoteIp, nRemotePort);
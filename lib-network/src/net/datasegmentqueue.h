@@ -2,7 +2,7 @@
  * @file datasegmentqueue.h
  *
  */
-/* Copyright (C) 2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2024-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,72 +27,81 @@
 #define DATASEGMENTQUEUE_H_
 
 #include <cstdint>
-#include <cstring>
 #include <cassert>
 
-#include "net/protocol/tcp.h"
+#include "net_config.h"
 
-#if !defined(TCP_TX_QUEUE_SIZE)
-# define TCP_TX_QUEUE_SIZE 	2
-#endif
+static_assert((TCP_TX_QUEUE_SIZE & (TCP_TX_QUEUE_SIZE - 1)) == 0, "TCP_TX_QUEUE_SIZE must be a power of 2");
+static_assert(TCP_TX_QUEUE_SIZE < 256);
+
+/*
+ * The data written that did not fit in the send window.
+ * The queue references the buffers of the caller, nothing is copied.
+ * A zero filled DataSegmentQueue is empty.
+ */
 
 struct DataSegment {
-	uint8_t buffer[TCP_DATA_SIZE];
+	const uint8_t *pData;
 	uint32_t nLength;
-	bool isLastSegment;
 };
 
 class DataSegmentQueue {
 public:
 	bool IsEmpty() const {
-		return !m_isFull && (m_nHead == m_nTail);
+		return m_nHead == m_nTail;
 	}
 
 	bool IsFull() const {
-		return m_isFull;
+		return static_cast<uint8_t>(m_nHead - m_nTail) == TCP_TX_QUEUE_SIZE;
+	}
+
+	void Clear() {
+		m_nTail = m_nHead;
 	}
 
-	bool Push(const uint8_t *pData, const uint32_t nLength, const bool isLastSegment) {
+	bool Push(const uint8_t *pData, const uint32_t nLength) {
 		assert(pData != nullptr);
 		assert(nLength > 0);
-		assert(nLength <= TCP_DATA_SIZE);
 
-		if (IsFull() || (nLength > TCP_DATA_SIZE)) {
+		if (IsFull()) {
 			return false;
 		}
 
-		auto& dataSegment = m_dataSegment[m_nHead];
+		auto& dataSegment = m_dataSegment[m_nHead % TCP_TX_QUEUE_SIZE];
 
-		memcpy(dataSegment.buffer, pData, nLength);
+		dataSegment.pData = pData;
 		dataSegment.nLength = nLength;
-		dataSegment.isLastSegment = isLastSegment;
 
-		m_nHead = (m_nHead + 1) % TCP_TX_QUEUE_SIZE;
-		m_isFull = (m_nHead == m_nTail);
+		m_nHead++;
 
 		return true;
 	}
 
-	void Pop() {
+	/*
+	 * nLength bytes of the front are sent, the front is removed when all bytes are sent.
+	 */
+	void Consume(const uint32_t nLength) {
 		assert(!IsEmpty());
 
-		if (IsEmpty()) {
-			return;
-		}
+		auto& dataSegment = m_dataSegment[m_nTail % TCP_TX_QUEUE_SIZE];
+		assert(nLength <= dataSegment.nLength);
+
+		dataSegment.pData += nLength;
+		dataSegment.nLength -= nLength;
 
-		m_nTail = (m_nTail + 1) % TCP_TX_QUEUE_SIZE;
-		m_isFull = false;
+		if (dataSegment.nLength == 0) {
+			m_nTail++;
+		}
 	}
 
 	const DataSegment& GetFront() const {
-		return m_dataSegment[m_nTail];
+		return m_dataSegment[m_nTail % TCP_TX_QUEUE_SIZE];
 	}
 
 private:
 	DataSegment m_dataSegment[TCP_TX_QUEUE_SIZE];
-	uint32_t m_nHead { 0 };
-	uint32_t m_nTail { 0 };
-	bool m_isFull { false };
+	uint8_t m_nHead;
+	uint8_t m_nTail;
 };
 
 #endif /* DATASEGMENTQUEUE_H_ */
@@ -2,7 +2,7 @@
  * @file net_chksum.cpp
  *
  */
-/* Copyright (C) 2018-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2018-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -31,28 +31,188 @@
 #endif
 
 #include <cstdint>
+#include <cstring>
+#if defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+/*
+ * One's complement sum of 16-bit words [RFC 1071].
+ * The words are added as 32-bit quantities into a 64-bit accumulator, and
+ * folded at the end. The byte order of the sum does not need to be swapped
+ * as long as all blocks start at an even offset in the checksummed data.
+ */
 
 namespace net {
-uint16_t net_chksum(const void *data, uint32_t len) {
-	auto *ptr = reinterpret_cast<const uint16_t *>(data);
-	uint32_t sum = 0;
+/*
+ * The data can start at any address, the loads and stores go through
+ * memcpy() so that the compiler does not assume a word aligned pointer.
+ */
+static inline uint32_t load32(const uint8_t *p) {
+	uint32_t n;
+	__builtin_memcpy(&n, p, sizeof(n));
+	return n;
+}
+
+static inline uint16_t load16(const uint8_t *p) {
+	uint16_t n;
+	__builtin_memcpy(&n, p, sizeof(n));
+	return n;
+}
+
+static inline void store32(uint8_t *p, const uint32_t n) {
+	__builtin_memcpy(p, &n, sizeof(n));
+}
+
+static inline void store16(uint8_t *p, const uint16_t n) {
+	__builtin_memcpy(p, &n, sizeof(n));
+}
+
+static inline uint32_t fold64(uint64_t nSum) {
+	nSum = (nSum >> 32) + (nSum & 0xFFFFFFFF);
+	nSum = (nSum >> 32) + (nSum & 0xFFFFFFFF);
+	return static_cast<uint32_t>(nSum);
+}
+
+uint32_t net_chksum_add(const void *pData, uint32_t nLength, uint32_t nSum) {
+	auto *p = reinterpret_cast<const uint8_t *>(pData);
+	uint64_t nSum64 = nSum;
+
+	if ((reinterpret_cast<uintptr_t>(p) & 0x2) && (nLength >= 2)) {
+		nSum64 += load16(p);
+		p += 2;
+		nLength -= 2;
+	}
+
+#if defined (__ARM_NEON)
+	while (nLength >= 64) {
+		/* 16-bit lanes are accumulated pairwise into 32-bit lanes, which cannot overflow within a block */
+		auto nBlocks = nLength / 64;
+		if (nBlocks > 1024) {
+			nBlocks = 1024;
+		}
+		nLength -= nBlocks * 64;
+
+		auto vSum = vdupq_n_u32(0);
+
+		while (nBlocks-- != 0) {
+			/* Byte loads have no alignment requirement */
+			vSum = vpadalq_u16(vSum, vreinterpretq_u16_u8(vld1q_u8(p)));
+			vSum = vpadalq_u16(vSum, vreinterpretq_u16_u8(vld1q_u8(p + 16)));
+			vSum = vpadalq_u16(vSum, vreinterpretq_u16_u8(vld1q_u8(p + 32)));
+			vSum = vpadalq_u16(vSum, vreinterpretq_u16_u8(vld1q_u8(p + 48)));
+			p += 64;
+		}
+
+		const auto vSum64 = vpaddlq_u32(vSum);
+		nSum64 += vgetq_lane_u64(vSum64, 0) + vgetq_lane_u64(vSum64, 1);
+	}
+#endif
+
+	while (nLength >= 16) {
+		nSum64 += load32(p);
+		nSum64 += load32(p + 4);
+		nSum64 += load32(p + 8);
+		nSum64 += load32(p + 12);
+		p += 16;
+		nLength -= 16;
+	}
+
+	while (nLength >= 4) {
+		nSum64 += load32(p);
+		p += 4;
+		nLength -= 4;
+	}
 
-	while (len > 1) {
-		sum += *ptr;
-		ptr++;
-		len -= 2;
+	if (nLength >= 2) {
+		nSum64 += load16(p);
+		p += 2;
+		nLength -= 2;
 	}
 
 	/* Add left-over byte, if any */
-	if (len > 0) {
-		sum += __builtin_bswap16(static_cast<uint16_t>(*(reinterpret_cast<const uint8_t *>(ptr)) << 8));
+	if (nLength > 0) {
+		nSum64 += __builtin_bswap16(static_cast<uint16_t>(*p << 8));
+	}
+
+	return fold64(nSum64);
+}
+
+uint32_t net_chksum_copy_add(void *pDestination, const void *pSource, uint32_t nLength, uint32_t nSum) {
+	auto *pDst = reinterpret_cast<uint8_t *>(pDestination);
+	auto *pSrc = reinterpret_cast<const uint8_t *>(pSource);
+
+	if (((reinterpret_cast<uintptr_t>(pDst) ^ reinterpret_cast<uintptr_t>(pSrc)) & 0x3) != 0) {
+		/* Different alignment, use two passes */
+		memcpy(pDst, pSrc, nLength);
+		return net_chksum_add(pDst, nLength, nSum);
+	}
+
+	uint64_t nSum64 = nSum;
+
+	if ((reinterpret_cast<uintptr_t>(pSrc) & 0x2) && (nLength >= 2)) {
+		const auto n = load16(pSrc);
+		store16(pDst, n);
+		nSum64 += n;
+		pSrc += 2;
+		pDst += 2;
+		nLength -= 2;
+	}
+
+	while (nLength >= 16) {
+		const auto n0 = load32(pSrc);
+		const auto n1 = load32(pSrc + 4);
+		const auto n2 = load32(pSrc + 8);
+		const auto n3 = load32(pSrc + 12);
+		store32(pDst, n0);
+		store32(pDst + 4, n1);
+		store32(pDst + 8, n2);
+		store32(pDst + 12, n3);
+		nSum64 += n0;
+		nSum64 += n1;
+		nSum64 += n2;
+		nSum64 += n3;
+		pSrc += 16;
+		pDst += 16;
+		nLength -= 16;
+	}
+
+	while (nLength >= 4) {
+		const auto n = load32(pSrc);
+		store32(pDst, n);
+		nSum64 += n;
+		pSrc += 4;
+		pDst += 4;
+		nLength -= 4;
+	}
+
+	if (nLength >= 2) {
+		const auto n = load16(pSrc);
+		store16(pDst, n);
+		nSum64 += n;
+		pSrc += 2;
+		pDst += 2;
+		nLength -= 2;
+	}
+
+	if (nLength > 0) {
+		*pDst = *pSrc;
+		nSum64 += __builtin_bswap16(static_cast<uint16_t>(*pSrc << 8));
 	}
 
+	return fold64(nSum64);
+}
+
+uint16_t net_chksum_finish(uint32_t nSum) {
 	/* Fold 32-bit sum into 16 bits */
-	while (sum >> 16) {
-		sum = (sum >> 16) + (sum & 0xFFFF);
+	while (nSum >> 16) {
+		nSum = (nSum >> 16) + (nSum & 0xFFFF);
 	}
 
-	return static_cast<uint16_t>(~sum);
+	return static_cast<uint16_t>(~nSum);
+}
+
+uint16_t net_chksum(const void *data, uint32_t len) {
+	return net_chksum_finish(net_chksum_add(data, len, 0));
 }
 }  // namespace net
@@ -36,6 +36,8 @@
 # else
 #  define SECTION_NETWORK
 # endif
+#elif defined (CONFIG_NETWORK_USE_TAP)
+# define SECTION_NETWORK
 #else
 # include "h3.h"
 # define SECTION_NETWORK
@@ -2,7 +2,7 @@
  * @file net_private.h
  *
  */
-/* Copyright (C) 2023-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2023-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -65,6 +65,9 @@ namespace net {
 void net_handle();
 
 uint16_t net_chksum(const void *, uint32_t);
+uint32_t net_chksum_add(const void *, uint32_t, uint32_t);
+uint32_t net_chksum_copy_add(void *, const void *, uint32_t, uint32_t);
+uint16_t net_chksum_finish(uint32_t);
 void net_timers_run();
 
 void ip_init();
@@ -73,6 +76,8 @@ void ip_handle(struct t_ip4 *);
 
 void udp_init();
 void udp_input(const struct t_udp *);
+void udp_template_invalidate();
+void udp_template_invalidate(const uint32_t);
 void udp_shutdown();
 
 void igmp_init();
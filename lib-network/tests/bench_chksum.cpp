@@ -0,0 +1,109 @@
+/**
+ * @file bench_chksum.cpp
+ *
+ * Throughput of net_chksum_add() and net_chksum_copy_add() compared with a
+ * byte-wise RFC 1071 sum and with memcpy() followed by net_chksum_add().
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+
+#include "net_private.h"
+
+static constexpr uint32_t SIZES[] = { 64, 530, 1472 };
+static constexpr uint32_t BYTES_PER_RUN = 64 * 1024 * 1024;
+static constexpr uint32_t RUNS = 5;	///< The fastest run is reported
+
+alignas(8) static uint8_t s_Source[2048];
+alignas(8) static uint8_t s_Destination[2048];
+
+static volatile uint32_t s_nSink;
+
+static uint64_t nanos_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000U + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static uint32_t __attribute__((noinline)) bytewise(const uint8_t *pData, const uint32_t nLength) {
+	uint32_t nSum = 0;
+
+	for (uint32_t i = 0; i + 1 < nLength; i += 2) {
+		nSum += static_cast<uint32_t>((pData[i] << 8) | pData[i + 1]);
+	}
+
+	if (nLength & 1) {
+		nSum += static_cast<uint32_t>(pData[nLength - 1] << 8);
+	}
+
+	return nSum;
+}
+
+static uint32_t __attribute__((noinline)) copy_then_add(uint8_t *pDst, const uint8_t *pSrc, const uint32_t nLength) {
+	memcpy(pDst, pSrc, nLength);
+	return net::net_chksum_add(pDst, nLength, 0);
+}
+
+template<typename F>
+static void measure(const char *pName, const uint32_t nSize, F function) {
+	const auto nCalls = BYTES_PER_RUN / nSize;
+	auto nBest = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+		uint32_t nSum = 0;
+
+		for (uint32_t i = 0; i < nCalls; i++) {
+			// The data may have changed, so that no call is hoisted out of the loop
+			__asm__ volatile("" ::: "memory");
+			nSum += function();
+		}
+
+		nBest = std::min(nBest, nanos_now() - nStart);
+		s_nSink = nSum;
+	}
+
+	printf("  %-24s %4u bytes: %7.1f ns per call, %6.0f MB/s\n", pName, nSize,
+			static_cast<double>(nBest) / nCalls,
+			static_cast<double>(nCalls) * nSize * 1e3 / static_cast<double>(nBest));
+}
+
+int main() {
+	for (auto& n : s_Source) {
+		n = static_cast<uint8_t>(random());
+	}
+
+	for (const auto nSize : SIZES) {
+		measure("byte-wise", nSize, [&] { return bytewise(s_Source, nSize); });
+		measure("net_chksum_add", nSize, [&] { return net::net_chksum_add(s_Source, nSize, 0); });
+		measure("net_chksum_add unaligned", nSize, [&] { return net::net_chksum_add(&s_Source[1], nSize, 0); });
+		measure("memcpy + net_chksum_add", nSize, [&] { return copy_then_add(s_Destination, s_Source, nSize); });
+		measure("net_chksum_copy_add", nSize, [&] { return net::net_chksum_copy_add(s_Destination, s_Source, nSize, 0); });
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,321 @@
+/**
+ * @file bench_demux.cpp
+ *
+ * Cost per received packet of the UDP port and TCP connection demultiplexing.
+ * The frames are handed to udp_input() and tcp_input() of the TAP build,
+ * the replies of the stack go to a socket pair instead of the TAP device.
+ * As baseline, the linear scan of the ports and connections that the stack
+ * did before the hash tables is timed for the same sets (the lookup only).
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include "hardware.h"
+
+#include "net/udp.h"
+#include "net/tcp.h"
+#include "net/protocol/udp.h"
+#include "net/protocol/tcp.h"
+#include "net_config.h"
+#include "net_private.h"
+
+#include "emac.h"
+
+#include "net_frames.h"
+
+static constexpr uint32_t ITERATIONS = 1000000;
+static constexpr uint32_t RUNS = 7;	///< The fastest run is reported
+
+/// Ports bound by a node with all protocols enabled, in udp_begin() order
+static constexpr uint16_t UDP_PORTS[] = { 6454, 5568, 5569, 8000, 5353, 123, 69, 0x2905, 4048, 9000 };
+static constexpr auto UDP_PORTS_COUNT = sizeof(UDP_PORTS) / sizeof(UDP_PORTS[0]);
+static constexpr uint16_t TCP_PORT = 80;
+
+static int s_nReplyFd;
+static uint32_t s_nUdpCount;
+static uint32_t s_nTcpCount;
+
+static uint64_t nanos_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000U + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void udp_callback([[maybe_unused]] const uint8_t *pBuffer, [[maybe_unused]] uint32_t nSize, [[maybe_unused]] uint32_t nFromIp, [[maybe_unused]] uint16_t nFromPort) {
+	s_nUdpCount++;
+}
+
+static void tcp_callback([[maybe_unused]] const int32_t nHandle, [[maybe_unused]] const uint8_t *pBuffer, [[maybe_unused]] const uint32_t nSize) {
+	s_nTcpCount++;
+}
+
+/*
+ * The linear scans as done before the hash tables
+ */
+namespace linear {
+static uint16_t s_Ports[UDP_MAX_PORTS_ALLOWED];
+
+struct Tcb {
+	uint8_t remoteIp[4];
+	uint16_t nRemotePort;
+};
+
+static Tcb s_Tcb[TCP_MAX_TCBS_ALLOWED];
+
+static int32_t udp_port_lookup(const struct t_udp *pUdp) {
+	const auto nDestinationPort = __builtin_bswap16(pUdp->udp.destination_port);
+
+	for (uint32_t nPortIndex = 0; nPortIndex < UDP_MAX_PORTS_ALLOWED; nPortIndex++) {
+		if (s_Ports[nPortIndex] == nDestinationPort) {
+			return static_cast<int32_t>(nPortIndex);
+		}
+	}
+
+	return -1;
+}
+
+static int32_t tcb_lookup(const struct t_tcp *pTcp) {
+	const auto nSourcePort = __builtin_bswap16(pTcp->tcp.srcpt);
+
+	for (uint32_t nIndexTCB = 0; nIndexTCB < TCP_MAX_TCBS_ALLOWED; nIndexTCB++) {
+		const auto& tcb = s_Tcb[nIndexTCB];
+
+		if ((memcmp(tcb.remoteIp, pTcp->ip4.src, 4) == 0) && (tcb.nRemotePort == nSourcePort)) {
+			return static_cast<int32_t>(nIndexTCB);
+		}
+	}
+
+	return -1;
+}
+
+static void init() {
+	for (uint32_t i = 0; i < UDP_PORTS_COUNT; i++) {
+		s_Ports[i] = UDP_PORTS[i];
+	}
+
+	// The peers of frames::tcp_connect()
+	for (uint32_t i = 0; i < TCP_MAX_TCBS_ALLOWED; i++) {
+		auto& tcb = s_Tcb[i];
+		tcb.remoteIp[0] = 192;
+		tcb.remoteIp[1] = 168;
+		tcb.remoteIp[2] = 77;
+		tcb.remoteIp[3] = static_cast<uint8_t>(100 + i);
+		tcb.nRemotePort = static_cast<uint16_t>(50000 + i);
+	}
+}
+
+static double bench_udp(const uint16_t nPort, const int32_t nExpected) {
+	alignas(8) struct t_udp udp;
+	memset(&udp, 0, sizeof(udp));
+
+	frames::udp_datagram(udp, 0, nPort, 18);
+
+	auto nBest = UINT64_MAX;
+	auto isValid = true;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+
+		for (uint32_t i = 0; i < ITERATIONS; i++) {
+			// The table and the frame are read again for each lookup
+			asm volatile("" : : "r"(&udp) : "memory");
+			isValid &= (udp_port_lookup(&udp) == nExpected);
+		}
+
+		nBest = std::min(nBest, nanos_now() - nStart);
+	}
+
+	if (!isValid) {
+		fprintf(stderr, "Linear scan of port %u failed\n", nPort);
+		exit(EXIT_FAILURE);
+	}
+
+	return static_cast<double>(nBest) / ITERATIONS;
+}
+
+static double bench_tcp(const uint8_t nPeer) {
+	alignas(8) static struct t_tcp tcp;
+
+	frames::tcp_segment(tcp, nPeer, TCP_PORT, 0, 0, frames::tcp::ACK);
+
+	auto nBest = UINT64_MAX;
+	auto isValid = true;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+
+		for (uint32_t i = 0; i < ITERATIONS; i++) {
+			asm volatile("" : : "r"(&tcp) : "memory");
+			isValid &= (tcb_lookup(&tcp) == nPeer);
+		}
+
+		nBest = std::min(nBest, nanos_now() - nStart);
+	}
+
+	if (!isValid) {
+		fprintf(stderr, "Linear scan of peer %u failed\n", nPeer);
+		exit(EXIT_FAILURE);
+	}
+
+	return static_cast<double>(nBest) / ITERATIONS;
+}
+}  // namespace linear
+
+static double bench_udp(const uint16_t nPort) {
+	alignas(8) struct t_udp udp;
+	memset(&udp, 0, sizeof(udp));
+
+	frames::udp_datagram(udp, 0, nPort, 18);
+
+	auto nBest = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+
+		for (uint32_t i = 0; i < ITERATIONS; i++) {
+			net::udp_input(&udp);
+		}
+
+		nBest = std::min(nBest, nanos_now() - nStart);
+	}
+
+	return static_cast<double>(nBest) / ITERATIONS;
+}
+
+static double bench_tcp(const uint8_t nPeer, const uint32_t nSeq, const uint32_t nAck) {
+	alignas(8) static struct t_tcp segment;
+	alignas(8) static struct t_tcp tcp;
+
+	frames::tcp_segment(segment, nPeer, TCP_PORT, nSeq, nAck, frames::tcp::ACK);
+
+	constexpr auto nLength = sizeof(struct ether_header) + sizeof(struct ip4_header) + TCP_HEADER_SIZE;
+	auto nBest = UINT64_MAX;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		const auto nStart = nanos_now();
+
+		for (uint32_t i = 0; i < ITERATIONS; i++) {
+			// tcp_input() converts the header in place
+			memcpy(&tcp, &segment, nLength);
+			net::tcp_input(&tcp);
+		}
+
+		nBest = std::min(nBest, nanos_now() - nStart);
+	}
+
+	return static_cast<double>(nBest) / ITERATIONS;
+}
+
+int main() {
+	Hardware hw;
+
+	int fds[2];
+
+	if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds) != 0) {
+		perror("socketpair");
+		return EXIT_FAILURE;
+	}
+
+	tap_region.fd = fds[0];
+	s_nReplyFd = fds[1];
+
+	net::udp_init();
+	net::tcp_init();
+
+	for (const auto nPort : UDP_PORTS) {
+		net::udp_begin(nPort, udp_callback);
+	}
+
+	linear::init();
+
+	printf("UDP, %u ports bound, best of %u runs of %u datagrams\n", static_cast<uint32_t>(UDP_PORTS_COUNT), RUNS, ITERATIONS);
+	printf("                          udp_input()   linear scan lookup\n");
+
+	double fTotal = 0;
+	double fTotalLinear = 0;
+
+	for (uint32_t i = 0; i < UDP_PORTS_COUNT; i++) {
+		const auto f = bench_udp(UDP_PORTS[i]);
+		const auto fLinear = linear::bench_udp(UDP_PORTS[i], static_cast<int32_t>(i));
+		fTotal += f;
+		fTotalLinear += fLinear;
+		printf("  port %5u (bound #%-2u): %6.2f ns      %6.2f ns\n", UDP_PORTS[i], i + 1, f, fLinear);
+	}
+
+	const auto fUnbound = bench_udp(7777);
+	const auto fUnboundLinear = linear::bench_udp(7777, -1);
+	printf("  port  7777 (not bound): %6.2f ns      %6.2f ns\n", fUnbound, fUnboundLinear);
+	printf("  average bound         : %6.2f ns      %6.2f ns\n", fTotal / UDP_PORTS_COUNT, fTotalLinear / UDP_PORTS_COUNT);
+
+	if (s_nUdpCount != UDP_PORTS_COUNT * RUNS * ITERATIONS) {
+		fprintf(stderr, "UDP callback count %u, expected %u\n", s_nUdpCount, static_cast<uint32_t>(UDP_PORTS_COUNT * RUNS * ITERATIONS));
+		return EXIT_FAILURE;
+	}
+
+	net::tcp_begin(TCP_PORT, tcp_callback);
+
+	uint32_t nAck[TCP_MAX_TCBS_ALLOWED];
+
+	for (uint32_t i = 0; i < TCP_MAX_TCBS_ALLOWED; i++) {
+		nAck[i] = frames::tcp_connect(s_nReplyFd, static_cast<uint8_t>(i), TCP_PORT, 1000 * i);
+	}
+
+	// Only the replies of the measured segments are left in the socket pair
+	uint8_t discard[CONFIG_ETH_BUFSIZE];
+	while (read(s_nReplyFd, discard, sizeof(discard)) > 0) {
+	}
+
+	printf("TCP, %u connections established, best of %u runs of %u segments\n", TCP_MAX_TCBS_ALLOWED, RUNS, ITERATIONS);
+	printf("                   tcp_input()   linear scan lookup\n");
+
+	fTotal = 0;
+	fTotalLinear = 0;
+
+	for (uint32_t i = 0; i < TCP_MAX_TCBS_ALLOWED; i++) {
+		const auto f = bench_tcp(static_cast<uint8_t>(i), 1000 * i + 1, nAck[i]);
+		const auto fLinear = linear::bench_tcp(static_cast<uint8_t>(i));
+		fTotal += f;
+		fTotalLinear += fLinear;
+
+		if ((i == 0) || (i == TCP_MAX_TCBS_ALLOWED - 1)) {
+			printf("  connection #%-2u : %6.2f ns      %6.2f ns\n", i + 1, f, fLinear);
+		}
+	}
+
+	printf("  average        : %6.2f ns      %6.2f ns\n", fTotal / TCP_MAX_TCBS_ALLOWED, fTotalLinear / TCP_MAX_TCBS_ALLOWED);
+
+	if (read(s_nReplyFd, discard, sizeof(discard)) > 0) {
+		fprintf(stderr, "Unexpected reply to a duplicate ACK\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
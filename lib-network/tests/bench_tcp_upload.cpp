@@ -0,0 +1,159 @@
+/**
+ * @file bench_tcp_upload.cpp
+ *
+ * Sustained upload throughput of the TCP receive path, as used by the
+ * HTTP server and the TFTP/firmware upload. Full sized in-sequence segments
+ * are handed to tcp_input() of the TAP build, the acknowledgments of the
+ * stack go to a socket pair instead of the TAP device.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "hardware.h"
+
+#include "net/tcp.h"
+#include "net/protocol/tcp.h"
+#include "net_config.h"
+#include "net_private.h"
+
+#include "emac.h"
+
+#include "net_frames.h"
+
+static constexpr uint16_t TCP_PORT = 80;
+static constexpr uint32_t SEGMENT_SIZE = TCP_DATA_SIZE;	///< The MSS advertised by the node
+static constexpr uint32_t SEGMENTS = 200000;
+static constexpr uint32_t BURST = 16;	///< Segments between draining the acknowledgments
+static constexpr uint32_t RUNS = 7;		///< The fastest run is reported
+
+static int s_nReplyFd;
+static uint64_t s_nBytesReceived;
+
+static uint64_t nanos_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000U + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void tcp_callback([[maybe_unused]] const int32_t nHandle, [[maybe_unused]] const uint8_t *pBuffer, const uint32_t nSize) {
+	s_nBytesReceived += nSize;
+}
+
+/**
+ * Returns the number of acknowledgments read
+ */
+static uint32_t acks_drain() {
+	alignas(8) static struct t_tcp reply;
+	uint32_t nAcks = 0;
+
+	while (read(s_nReplyFd, &reply, sizeof(reply)) > 0) {
+		if ((reply.tcp.control & frames::tcp::ACK) != 0) {
+			nAcks++;
+		}
+	}
+
+	return nAcks;
+}
+
+int main() {
+	Hardware hw;
+
+	int fds[2];
+
+	if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds) != 0) {
+		perror("socketpair");
+		return EXIT_FAILURE;
+	}
+
+	tap_region.fd = fds[0];
+	s_nReplyFd = fds[1];
+
+	net::tcp_init();
+	net::tcp_begin(TCP_PORT, tcp_callback);
+
+	constexpr uint32_t ISS = 1000;
+	const auto nAck = frames::tcp_connect(s_nReplyFd, 0, TCP_PORT, ISS);
+	acks_drain();
+
+	alignas(8) static struct t_tcp segment;
+	alignas(8) static struct t_tcp tcp;
+
+	for (uint32_t i = 0; i < SEGMENT_SIZE; i++) {
+		segment.tcp.data[i] = static_cast<uint8_t>(i);
+	}
+
+	constexpr auto nLength = sizeof(struct ether_header) + sizeof(struct ip4_header) + TCP_HEADER_SIZE + SEGMENT_SIZE;
+
+	auto nSeq = ISS + 1;
+	auto nBest = UINT64_MAX;
+	uint32_t nAcks = 0;
+
+	for (uint32_t nRun = 0; nRun < RUNS; nRun++) {
+		uint64_t nElapsed = 0;
+
+		for (uint32_t nSegment = 0; nSegment < SEGMENTS; nSegment += BURST) {
+			const auto nStart = nanos_now();
+
+			for (uint32_t i = 0; i < BURST; i++) {
+				frames::tcp_segment(segment, 0, TCP_PORT, nSeq, nAck, frames::tcp::PSH | frames::tcp::ACK, SEGMENT_SIZE);
+				// tcp_input() converts the header in place
+				memcpy(&tcp, &segment, nLength);
+				net::tcp_input(&tcp);
+				nSeq += SEGMENT_SIZE;
+			}
+
+			nElapsed += nanos_now() - nStart;
+			nAcks += acks_drain();
+		}
+
+		nBest = std::min(nBest, nElapsed);
+	}
+
+	const auto nTotal = static_cast<uint64_t>(RUNS) * SEGMENTS * SEGMENT_SIZE;
+
+	if (s_nBytesReceived != nTotal) {
+		fprintf(stderr, "Received %llu bytes, expected %llu\n", static_cast<unsigned long long>(s_nBytesReceived), static_cast<unsigned long long>(nTotal));
+		return EXIT_FAILURE;
+	}
+
+	// Delayed acknowledgment: one for every second segment
+	if (nAcks != (RUNS * SEGMENTS) / 2) {
+		fprintf(stderr, "%u acknowledgments, expected %u\n", nAcks, (RUNS * SEGMENTS) / 2);
+		return EXIT_FAILURE;
+	}
+
+	const auto fSeconds = static_cast<double>(nBest) / 1e9;
+
+	printf("TCP upload, %u byte segments, best of %u runs of %u segments\n", SEGMENT_SIZE, RUNS, SEGMENTS);
+	printf("  %8.2f ns per segment\n", static_cast<double>(nBest) / SEGMENTS);
+	printf("  %8.2f MB/s\n", (static_cast<double>(SEGMENTS) * SEGMENT_SIZE) / fSeconds / 1e6);
+
+	return EXIT_SUCCESS;
+}
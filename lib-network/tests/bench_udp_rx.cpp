@@ -0,0 +1,170 @@
+/**
+ * @file bench_udp_rx.cpp
+ *
+ * Receive path benchmark of the Linux network backends.
+ * A child process sends ArtDmx sized datagrams to the loopback,
+ * the parent drains them with Network::Wait() and the zero-copy RecvFrom().
+ * Build as bench_udp_rx (recvmmsg) and as bench_udp_rx_io_uring.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "network.h"
+
+#if defined (CONFIG_NETWORK_USE_IO_URING)
+static constexpr char BACKEND[] = "io_uring";
+#else
+static constexpr char BACKEND[] = "default";
+#endif
+
+static constexpr uint16_t PORT = 6454;
+static constexpr uint32_t DATAGRAM_SIZE = 530;	///< ArtDmx with 512 slots
+static constexpr uint32_t BATCH = 32;
+static constexpr uint32_t IDLE_MILLIS = 500;
+
+static uint64_t micros_now(const clockid_t clockId) {
+	struct timespec ts;
+	clock_gettime(clockId, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000U + static_cast<uint64_t>(ts.tv_nsec) / 1000U;
+}
+
+static uint64_t cpu_micros() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000U
+			+ static_cast<uint64_t>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+[[noreturn]] static void sender(const uint32_t nCount) {
+	const auto nSocket = socket(AF_INET, SOCK_DGRAM, 0);
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if ((nSocket < 0) || (connect(nSocket, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0)) {
+		perror("sender");
+		_exit(EXIT_FAILURE);
+	}
+
+	uint8_t buffer[DATAGRAM_SIZE];
+	memset(buffer, 0, sizeof(buffer));
+	memcpy(buffer, "Art-Net", 8);
+
+	// Let the receiver enter Wait() first
+	usleep(100000);
+
+	for (uint32_t i = 0; i < nCount; i++) {
+		memcpy(&buffer[12], &i, sizeof(i));
+		send(nSocket, buffer, sizeof(buffer), 0);
+		// Pace the sender so that the socket buffer does not overflow
+		if ((i % BATCH) == (BATCH - 1)) {
+			usleep(20);
+		}
+	}
+
+	close(nSocket);
+	_exit(EXIT_SUCCESS);
+}
+
+int main(int argc, char **argv) {
+	const char *pInterface = (argc > 1) ? argv[1] : "lo";
+	const uint32_t nCount = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 200000;
+
+	char *pArgv[] = { argv[0], const_cast<char *>(pInterface), nullptr };
+	Network nw(2, pArgv);
+
+	const auto nHandle = nw.Begin(PORT);
+
+	if (nHandle < 0) {
+		fprintf(stderr, "Begin(%u) failed\n", PORT);
+		return EXIT_FAILURE;
+	}
+
+	const auto pid = fork();
+
+	if (pid == 0) {
+		sender(nCount);
+	}
+
+	uint32_t nReceived = 0;
+	uint32_t nWakeups = 0;
+	uint64_t nFirstMicros = 0;
+	uint64_t nLastMicros = 0;
+	uint64_t nCpuStart = 0;
+	uint64_t nCpuLast = 0;
+
+	while (nReceived < nCount) {
+		nw.Wait(IDLE_MILLIS);
+		nWakeups++;
+
+		const void *pBuffer;
+		uint32_t nFromIp;
+		uint16_t nFromPort;
+		uint32_t nBytes;
+		bool bReceived = false;
+
+		while ((nBytes = nw.RecvFrom(nHandle, &pBuffer, &nFromIp, &nFromPort)) != 0) {
+			if (nReceived == 0) {
+				nFirstMicros = micros_now(CLOCK_MONOTONIC);
+				nCpuStart = cpu_micros();
+			}
+			if (nBytes == DATAGRAM_SIZE) {
+				nReceived++;
+			}
+			bReceived = true;
+		}
+
+		if (bReceived) {
+			nLastMicros = micros_now(CLOCK_MONOTONIC);
+			nCpuLast = cpu_micros();
+		} else if (nReceived != 0) {
+			break;	// Idle: the remaining datagrams were dropped
+		}
+	}
+
+	waitpid(pid, nullptr, 0);
+
+	const auto nWallMicros = nLastMicros - nFirstMicros;
+	const auto nCpuMicros = nCpuLast - nCpuStart;
+
+	printf("%-8s: %u/%u datagrams, %u wakeups, %.0f datagrams/s, %.0f ns CPU per datagram\n",
+			BACKEND, nReceived, nCount, nWakeups,
+			nWallMicros == 0 ? 0.0 : static_cast<double>(nReceived) * 1e6 / static_cast<double>(nWallMicros),
+			nReceived == 0 ? 0.0 : static_cast<double>(nCpuMicros) * 1e3 / static_cast<double>(nReceived));
+
+	return nReceived == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file arm_neon.h
+ *
+ * Plain C++ versions of the NEON intrinsics used by net_chksum.cpp,
+ * so that its NEON path is tested on the build host (test_chksum_neon).
+ * The lanes are in little endian order, as on Cortex-A7.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ARM_NEON_H_
+#define ARM_NEON_H_
+
+#include <cstdint>
+#include <cstring>
+
+struct uint8x16_t {
+	uint8_t val[16];
+};
+
+struct uint16x8_t {
+	uint16_t val[8];
+};
+
+struct uint32x4_t {
+	uint32_t val[4];
+};
+
+struct uint64x2_t {
+	uint64_t val[2];
+};
+
+inline uint32x4_t vdupq_n_u32(const uint32_t n) {
+	return uint32x4_t { { n, n, n, n } };
+}
+
+inline uint8x16_t vld1q_u8(const uint8_t *p) {
+	uint8x16_t v;
+	memcpy(v.val, p, sizeof(v.val));
+	return v;
+}
+
+inline uint16x8_t vreinterpretq_u16_u8(const uint8x16_t v) {
+	uint16x8_t r;
+	memcpy(r.val, v.val, sizeof(r.val));
+	return r;
+}
+
+/// Pairwise add of the 16-bit lanes, accumulated into the 32-bit lanes
+inline uint32x4_t vpadalq_u16(uint32x4_t a, const uint16x8_t b) {
+	for (uint32_t i = 0; i < 4; i++) {
+		a.val[i] += static_cast<uint32_t>(b.val[2 * i]) + b.val[2 * i + 1];
+	}
+	return a;
+}
+
+/// Pairwise add of the 32-bit lanes into 64-bit lanes
+inline uint64x2_t vpaddlq_u32(const uint32x4_t a) {
+	return uint64x2_t { { static_cast<uint64_t>(a.val[0]) + a.val[1], static_cast<uint64_t>(a.val[2]) + a.val[3] } };
+}
+
+#define vgetq_lane_u64(v, lane)	((v).val[(lane)])
+
+#endif /* ARM_NEON_H_ */
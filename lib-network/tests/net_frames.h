@@ -0,0 +1,110 @@
+/**
+ * @file net_frames.h
+ *
+ * Frames from the peers 192.168.77.100 + n to the node 192.168.77.2,
+ * which the benchmarks hand to the input functions of the embedded stack.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NET_FRAMES_H_
+#define NET_FRAMES_H_
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "net/protocol/udp.h"
+#include "net/protocol/tcp.h"
+#include "net_private.h"
+
+namespace frames {
+namespace tcp {
+static constexpr uint8_t SYN = 0x02;
+static constexpr uint8_t RST = 0x04;
+static constexpr uint8_t PSH = 0x08;
+static constexpr uint8_t ACK = 0x10;
+}  // namespace tcp
+
+inline void ip4_header_set(struct ip4_header& ip4, const uint8_t nProto, const uint32_t nLength, const uint8_t nPeer) {
+	ip4.ver_ihl = 0x45;
+	ip4.len = __builtin_bswap16(static_cast<uint16_t>(nLength));
+	ip4.ttl = 64;
+	ip4.proto = nProto;
+	const uint8_t src[] = { 192, 168, 77, static_cast<uint8_t>(100 + nPeer) };
+	const uint8_t dst[] = { 192, 168, 77, 2 };
+	memcpy(ip4.src, src, sizeof(src));
+	memcpy(ip4.dst, dst, sizeof(dst));
+}
+
+inline void udp_datagram(struct t_udp& udp, const uint8_t nPeer, const uint16_t nPort, const uint32_t nDataLength) {
+	memset(&udp, 0, sizeof(struct ether_header) + IPv4_UDP_HEADERS_SIZE);
+	ip4_header_set(udp.ip4, IPv4_PROTO_UDP, IPv4_UDP_HEADERS_SIZE + nDataLength, nPeer);
+	udp.udp.source_port = __builtin_bswap16(static_cast<uint16_t>(50000 + nPeer));
+	udp.udp.destination_port = __builtin_bswap16(nPort);
+	udp.udp.len = __builtin_bswap16(static_cast<uint16_t>(UDP_HEADER_SIZE + nDataLength));
+}
+
+/**
+ * The header of a segment without options, the data is left as it is.
+ */
+inline void tcp_segment(struct t_tcp& tcp, const uint8_t nPeer, const uint16_t nPort, const uint32_t nSeq, const uint32_t nAck, const uint8_t nControl, const uint32_t nDataLength = 0) {
+	memset(&tcp, 0, sizeof(struct ether_header) + sizeof(struct ip4_header) + TCP_HEADER_SIZE);
+	ip4_header_set(tcp.ip4, IPv4_PROTO_TCP, sizeof(struct ip4_header) + TCP_HEADER_SIZE + nDataLength, nPeer);
+	tcp.tcp.srcpt = __builtin_bswap16(static_cast<uint16_t>(50000 + nPeer));
+	tcp.tcp.dstpt = __builtin_bswap16(nPort);
+	tcp.tcp.seqnum = __builtin_bswap32(nSeq);
+	tcp.tcp.acknum = __builtin_bswap32(nAck);
+	tcp.tcp.offset = (TCP_HEADER_SIZE / 4) << 4;
+	tcp.tcp.control = nControl;
+	tcp.tcp.window = __builtin_bswap16(65535);
+}
+
+/**
+ * SYN, SYN-ACK, ACK: the peer's connection is in ESTABLISHED.
+ * The SYN-ACK is read from nReplyFd, the socket pair end of the TAP device.
+ * Returns the sequence number expected next by the peer.
+ */
+inline uint32_t tcp_connect(const int nReplyFd, const uint8_t nPeer, const uint16_t nPort, const uint32_t nIss) {
+	alignas(8) static struct t_tcp tcp;
+
+	tcp_segment(tcp, nPeer, nPort, nIss, 0, tcp::SYN);
+	net::tcp_input(&tcp);
+
+	alignas(8) static struct t_tcp reply;
+
+	if (read(nReplyFd, &reply, sizeof(reply)) <= 0) {
+		fprintf(stderr, "No SYN-ACK for peer %u\n", nPeer);
+		exit(EXIT_FAILURE);
+	}
+
+	const auto nSeqSynAck = __builtin_bswap32(reply.tcp.seqnum);
+
+	tcp_segment(tcp, nPeer, nPort, nIss + 1, nSeqSynAck + 1, tcp::ACK);
+	net::tcp_input(&tcp);
+
+	return nSeqSynAck + 1;
+}
+}  // namespace frames
+
+#endif /* NET_FRAMES_H_ */
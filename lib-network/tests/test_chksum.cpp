@@ -0,0 +1,178 @@
+/**
+ * @file test_chksum.cpp
+ *
+ * net_chksum_add() and net_chksum_copy_add() against a byte-wise RFC 1071 reference,
+ * for all start addresses modulo 8 and the lengths around the unrolled loops.
+ * Built as test_chksum and, with an emulation of the NEON intrinsics, as test_chksum_neon.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+#include "net_private.h"
+
+static constexpr uint32_t BUFFER_SIZE = 70000;	///< More than 1024 NEON blocks of 64 bytes
+static constexpr uint32_t LENGTHS[] = { 1472, 1500, 4096, 9000, 65535, 65600, 69990 };
+
+static uint8_t s_Source[BUFFER_SIZE + 16];
+static uint8_t s_Destination[BUFFER_SIZE + 32];
+static uint32_t s_nErrors;
+
+/**
+ * Sum of the big endian 16-bit words, the odd byte is padded with zero.
+ * The checksum is stored in network byte order.
+ */
+static void reference(const uint8_t *pData, const uint32_t nLength, const uint32_t nInitial, uint8_t chksum[2]) {
+	uint64_t nSum = nInitial;
+
+	for (uint32_t i = 0; i + 1 < nLength; i += 2) {
+		nSum += static_cast<uint32_t>((pData[i] << 8) | pData[i + 1]);
+	}
+
+	if (nLength & 1) {
+		nSum += static_cast<uint32_t>(pData[nLength - 1] << 8);
+	}
+
+	while (nSum >> 16) {
+		nSum = (nSum >> 16) + (nSum & 0xFFFF);
+	}
+
+	chksum[0] = static_cast<uint8_t>(~nSum >> 8);
+	chksum[1] = static_cast<uint8_t>(~nSum);
+}
+
+static uint32_t initial_sum(const uint32_t nInitial) {
+	// The initial sum is a host order partial sum, like the pseudo header of UDP and TCP
+	const uint8_t be[2] = { static_cast<uint8_t>(nInitial >> 8), static_cast<uint8_t>(nInitial) };
+	uint16_t n;
+	memcpy(&n, be, sizeof(n));
+	return n;
+}
+
+static void check(const char *pName, const uint32_t nOffset, const uint32_t nLength, const uint32_t nInitial, const uint16_t nChksum) {
+	uint8_t expected[2];
+	reference(&s_Source[nOffset], nLength, nInitial, expected);
+
+	uint8_t result[2];
+	memcpy(result, &nChksum, sizeof(result));
+
+	if (memcmp(result, expected, sizeof(result)) != 0) {
+		if (s_nErrors++ < 16) {
+			printf("%s: offset=%u, length=%u, initial=%04x: %02x%02x, expected %02x%02x\n", pName, nOffset, nLength, nInitial, result[0], result[1], expected[0], expected[1]);
+		}
+	}
+}
+
+static void test_add(const uint32_t nOffset, const uint32_t nLength) {
+	static constexpr uint32_t INITIAL[] = { 0x0000, 0x1234, 0xFFFF };
+
+	for (const auto nInitial : INITIAL) {
+		const auto nSum = net::net_chksum_add(&s_Source[nOffset], nLength, initial_sum(nInitial));
+		check("net_chksum_add", nOffset, nLength, nInitial, net::net_chksum_finish(nSum));
+	}
+
+	// Split at an even offset, as done for a header and its payload
+	const auto nSplit = (nLength / 3) & ~1U;
+	auto nSum = net::net_chksum_add(&s_Source[nOffset], nSplit, 0);
+	nSum = net::net_chksum_add(&s_Source[nOffset + nSplit], nLength - nSplit, nSum);
+	check("net_chksum_add split", nOffset, nLength, 0, net::net_chksum_finish(nSum));
+}
+
+static void test_copy_add(const uint32_t nSourceOffset, const uint32_t nDestinationOffset, const uint32_t nLength) {
+	memset(s_Destination, 0xA5, sizeof(s_Destination));
+
+	const auto nSum = net::net_chksum_copy_add(&s_Destination[nDestinationOffset], &s_Source[nSourceOffset], nLength, initial_sum(0x1234));
+	check("net_chksum_copy_add", nSourceOffset, nLength, 0x1234, net::net_chksum_finish(nSum));
+
+	auto isValid = memcmp(&s_Destination[nDestinationOffset], &s_Source[nSourceOffset], nLength) == 0;
+
+	for (uint32_t i = 0; i < nDestinationOffset; i++) {
+		isValid = isValid && (s_Destination[i] == 0xA5);
+	}
+
+	for (uint32_t i = nDestinationOffset + nLength; i < nDestinationOffset + nLength + 8; i++) {
+		isValid = isValid && (s_Destination[i] == 0xA5);
+	}
+
+	if (!isValid) {
+		if (s_nErrors++ < 16) {
+			printf("net_chksum_copy_add: source offset=%u, destination offset=%u, length=%u: copy differs\n", nSourceOffset, nDestinationOffset, nLength);
+		}
+	}
+}
+
+static uint32_t run() {
+	uint32_t nTests = 0;
+
+	for (uint32_t nOffset = 0; nOffset < 8; nOffset++) {
+		for (uint32_t nLength = 0; nLength <= 300; nLength++) {
+			test_add(nOffset, nLength);
+			nTests++;
+		}
+
+		for (const auto nLength : LENGTHS) {
+			test_add(nOffset, nLength);
+			nTests++;
+		}
+
+		for (uint32_t nDestinationOffset = 0; nDestinationOffset < 8; nDestinationOffset++) {
+			for (uint32_t nLength = 0; nLength <= 80; nLength++) {
+				test_copy_add(nOffset, nDestinationOffset, nLength);
+				nTests++;
+			}
+
+			test_copy_add(nOffset, nDestinationOffset, 1500);
+			nTests++;
+		}
+	}
+
+	return nTests;
+}
+
+int main() {
+	srandom(1071);
+
+	for (auto& n : s_Source) {
+		n = static_cast<uint8_t>(random());
+	}
+
+	auto nTests = run();
+
+	// All ones gives the most carries
+	memset(s_Source, 0xFF, sizeof(s_Source));
+	nTests += run();
+
+	if (s_nErrors != 0) {
+		printf("test_chksum: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+#if defined (__ARM_NEON)
+	printf("test_chksum (NEON): %u tests passed\n", nTests);
+#else
+	printf("test_chksum: %u tests passed\n", nTests);
+#endif
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file test_tcp_write.cpp
+ *
+ * tcp_write() of the TAP build with a zero send window: the writes are
+ * queued until the transmit queue is full, a write that does not fit is
+ * refused. tcp_abort() drops the queued data.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "hardware.h"
+
+#include "net/tcp.h"
+#include "net/protocol/tcp.h"
+#include "net_config.h"
+#include "net_private.h"
+
+#include "emac.h"
+
+#include "net_frames.h"
+
+static constexpr uint16_t TCP_PORT = 80;
+static constexpr uint32_t CONNECTION = 0;	///< The first connection gets the first TCB
+
+static int s_nReplyFd;
+static uint32_t s_nErrors;
+static uint32_t s_nTests;
+
+static void check(const char *pName, const bool isValid) {
+	s_nTests++;
+
+	if (!isValid) {
+		s_nErrors++;
+		printf("%s: failed\n", pName);
+	}
+}
+
+/**
+ * Returns the number of segments read, the control bits are or-ed in nControl
+ */
+static uint32_t segments_drain(uint8_t& nControl) {
+	alignas(8) static struct t_tcp reply;
+	uint32_t nSegments = 0;
+
+	nControl = 0;
+
+	while (read(s_nReplyFd, &reply, sizeof(reply)) > 0) {
+		nControl |= reply.tcp.control;
+		nSegments++;
+	}
+
+	return nSegments;
+}
+
+static void tcp_callback([[maybe_unused]] const int32_t nHandle, [[maybe_unused]] const uint8_t *pBuffer, [[maybe_unused]] const uint32_t nSize) {
+}
+
+int main() {
+	Hardware hw;
+
+	int fds[2];
+
+	if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds) != 0) {
+		perror("socketpair");
+		return EXIT_FAILURE;
+	}
+
+	tap_region.fd = fds[0];
+	s_nReplyFd = fds[1];
+
+	net::tcp_init();
+	const auto nHandle = net::tcp_begin(TCP_PORT, tcp_callback);
+
+	// The handshake, the peer announces a zero window in the ACK
+	constexpr uint32_t ISS = 1000;
+	alignas(8) static struct t_tcp tcp;
+
+	frames::tcp_segment(tcp, 0, TCP_PORT, ISS, 0, frames::tcp::SYN);
+	net::tcp_input(&tcp);
+
+	alignas(8) static struct t_tcp reply;
+
+	if (read(s_nReplyFd, &reply, sizeof(reply)) <= 0) {
+		fprintf(stderr, "No SYN-ACK\n");
+		return EXIT_FAILURE;
+	}
+
+	frames::tcp_segment(tcp, 0, TCP_PORT, ISS + 1, __builtin_bswap32(reply.tcp.seqnum) + 1, frames::tcp::ACK);
+	tcp.tcp.window = 0;
+	net::tcp_input(&tcp);
+
+	static uint8_t data[TCP_TX_QUEUE_SIZE][100];
+	uint8_t nControl;
+
+	auto isQueued = true;
+
+	for (uint32_t i = 0; i < TCP_TX_QUEUE_SIZE; i++) {
+		isQueued = net::tcp_write(nHandle, data[i], sizeof(data[i]), CONNECTION) && isQueued;
+	}
+
+	check("writes queued", isQueued);
+	check("nothing sent in a zero window", segments_drain(nControl) == 0);
+	check("write refused, queue full", !net::tcp_write(nHandle, data[0], sizeof(data[0]), CONNECTION));
+	check("empty write accepted, queue full", net::tcp_write(nHandle, data[0], 0, CONNECTION));
+
+	net::tcp_abort(nHandle, CONNECTION);
+
+	check("reset sent", (segments_drain(nControl) == 1) && ((nControl & frames::tcp::RST) != 0));
+
+	// The queued data is dropped by the abort
+	isQueued = true;
+
+	for (uint32_t i = 0; i < TCP_TX_QUEUE_SIZE; i++) {
+		isQueued = net::tcp_write(nHandle, data[i], sizeof(data[i]), CONNECTION) && isQueued;
+	}
+
+	check("queue empty after the abort", isQueued);
+
+	if (s_nErrors != 0) {
+		printf("test_tcp_write: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+	printf("test_tcp_write: %u tests passed\n", s_nTests);
+	return EXIT_SUCCESS;
+}
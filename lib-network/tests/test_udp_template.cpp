@@ -0,0 +1,177 @@
+/**
+ * @file test_udp_template.cpp
+ *
+ * The UDP header templates of the TAP build. For an off-subnet destination the
+ * template holds the MAC address of the gateway, a change of that MAC address
+ * must rebuild the template.
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "hardware.h"
+
+#include "net/udp.h"
+#include "net/arp.h"
+#include "net/netif.h"
+#include "net/protocol/arp.h"
+#include "net/protocol/udp.h"
+#include "net_config.h"
+#include "net_private.h"
+
+#include "emac.h"
+
+static constexpr uint16_t UDP_PORT = 6454;
+static constexpr uint8_t GATEWAY_MAC_1[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static constexpr uint8_t GATEWAY_MAC_2[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+static constexpr uint8_t PEER_MAC[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x03 };
+
+static int s_nReplyFd;
+static uint32_t s_nErrors;
+
+static uint32_t ip(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d) {
+	return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+static const uint32_t s_nNodeIp = ip(192, 168, 77, 2);
+static const uint32_t s_nGatewayIp = ip(192, 168, 77, 1);
+static const uint32_t s_nPeerIp = ip(192, 168, 77, 100);
+static const uint32_t s_nRemoteIp = ip(10, 0, 0, 5);	///< Off-subnet, sent to the gateway
+
+static void arp_reply(const uint32_t nSenderIp, const uint8_t *pSenderMac) {
+	alignas(8) static struct t_arp arp;
+
+	memset(&arp, 0, sizeof(arp));
+	memcpy(arp.ether.src, pSenderMac, ETH_ADDR_LEN);
+	memcpy(arp.ether.dst, net::globals::netif_default.hwaddr, ETH_ADDR_LEN);
+	arp.ether.type = __builtin_bswap16(ETHER_TYPE_ARP);
+	arp.arp.hardware_type = __builtin_bswap16(ARP_HWTYPE_ETHERNET);
+	arp.arp.protocol_type = __builtin_bswap16(ARP_PRTYPE_IPv4);
+	arp.arp.hardware_size = ARP_HARDWARE_SIZE;
+	arp.arp.protocol_size = ARP_PROTOCOL_SIZE;
+	arp.arp.opcode = __builtin_bswap16(ARP_OPCODE_REPLY);
+	memcpy(arp.arp.sender_mac, pSenderMac, ETH_ADDR_LEN);
+	memcpy(arp.arp.sender_ip, &nSenderIp, IPv4_ADDR_LEN);
+	memcpy(arp.arp.target_mac, net::globals::netif_default.hwaddr, ETH_ADDR_LEN);
+	memcpy(arp.arp.target_ip, &s_nNodeIp, IPv4_ADDR_LEN);
+
+	net::etharp_input(&arp);
+}
+
+/**
+ * Returns the number of frames read, the destination MAC address of the last one is in pMac
+ */
+static uint32_t frames_drain(uint8_t *pMac) {
+	alignas(8) static struct t_udp frame;
+	uint32_t nFrames = 0;
+
+	while (read(s_nReplyFd, &frame, sizeof(frame)) > 0) {
+		memcpy(pMac, frame.ether.dst, ETH_ADDR_LEN);
+		nFrames++;
+	}
+
+	return nFrames;
+}
+
+static void check_send(const char *pName, const int32_t nHandle, const uint32_t nRemoteIp, const uint8_t *pExpectedMac) {
+	static constexpr uint8_t DATA[] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+
+	net::udp_send(nHandle, DATA, sizeof(DATA), nRemoteIp, UDP_PORT);
+
+	uint8_t mac[ETH_ADDR_LEN];
+	const auto nFrames = frames_drain(mac);
+
+	if ((nFrames != 1) || (memcmp(mac, pExpectedMac, ETH_ADDR_LEN) != 0)) {
+		s_nErrors++;
+		printf("%s: %u frames, " MACSTR ", expected " MACSTR "\n", pName, nFrames, MAC2STR(mac), MAC2STR(pExpectedMac));
+	}
+}
+
+int main() {
+	Hardware hw;
+
+	int fds[2];
+
+	if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds) != 0) {
+		perror("socketpair");
+		return EXIT_FAILURE;
+	}
+
+	tap_region.fd = fds[0];
+	s_nReplyFd = fds[1];
+
+	static constexpr uint8_t NODE_MAC[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x77 };
+	memcpy(net::globals::netif_default.hwaddr, NODE_MAC, ETH_ADDR_LEN);
+
+	net::netif_init();
+	net::arp_init();
+	net::udp_init();
+
+	net::ip4_addr_t ipaddr, netmask, gw;
+	ipaddr.addr = s_nNodeIp;
+	netmask.addr = ip(255, 255, 255, 0);
+	gw.addr = s_nGatewayIp;
+	net::netif_set_addr(ipaddr, netmask, gw);
+
+	const auto nHandle = net::udp_begin(UDP_PORT);
+
+	uint8_t mac[ETH_ADDR_LEN];
+
+	// Unresolved, the datagram is queued and an ARP request for the gateway is sent
+	net::udp_send(nHandle, reinterpret_cast<const uint8_t *>("?"), 1, s_nRemoteIp, UDP_PORT);
+	frames_drain(mac);
+	arp_reply(s_nGatewayIp, GATEWAY_MAC_1);
+	frames_drain(mac);
+
+	check_send("template build", nHandle, s_nRemoteIp, GATEWAY_MAC_1);
+	check_send("template hit", nHandle, s_nRemoteIp, GATEWAY_MAC_1);
+
+	// On-subnet destination resolved directly, it does not share the gateway entry
+	net::udp_send(nHandle, reinterpret_cast<const uint8_t *>("?"), 1, s_nPeerIp, UDP_PORT);
+	frames_drain(mac);
+	arp_reply(s_nPeerIp, PEER_MAC);
+	frames_drain(mac);
+	check_send("peer", nHandle, s_nPeerIp, PEER_MAC);
+
+	// The gateway is replaced, the template of the off-subnet destination must follow
+	arp_reply(s_nGatewayIp, GATEWAY_MAC_2);
+	frames_drain(mac);
+
+	check_send("gateway MAC changed", nHandle, s_nRemoteIp, GATEWAY_MAC_2);
+	check_send("gateway MAC changed, template hit", nHandle, s_nRemoteIp, GATEWAY_MAC_2);
+	check_send("peer unchanged", nHandle, s_nPeerIp, PEER_MAC);
+
+	constexpr uint32_t nTests = 6;
+
+	if (s_nErrors != 0) {
+		printf("test_udp_template: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+	printf("test_udp_template: %u tests passed\n", nTests);
+	return EXIT_SUCCESS;
+}
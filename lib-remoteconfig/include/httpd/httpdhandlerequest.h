@@ -2,7 +2,7 @@
  * @file httpdhandlerequest.h
  *
  */
-/* Copyright (C) 2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2024-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -39,6 +39,7 @@ namespace httpd {
 # define HTTPD_CONTENT_SIZE	TCP_DATA_SIZE
 #endif
 static constexpr uint32_t BUFSIZE = HTTPD_CONTENT_SIZE;
+static constexpr uint32_t HEADER_SIZE = 256;
 }  // namespace httpd
 
 class HttpDeamonHandleRequest {
@@ -89,6 +90,7 @@ private:
 
 
 	char m_DynamicContent[httpd::BUFSIZE];
+	char m_Header[httpd::HEADER_SIZE];	///< Is sent from here, the receive buffer is reused by the network driver
 };
 
 
@@ -2,7 +2,7 @@
  * @file remoteconfig.h
  *
  */
-/* Copyright (C) 2021-2024 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2021-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -69,6 +69,10 @@ uint32_t json_get_rtc(char *pOutBuffer, const uint32_t nOutBufferSize);
 void json_set_rtc(const char *pBuffer, const uint32_t nBufferSize);
 }  // namespace rtc
 
+namespace artnet {
+uint32_t json_get_status(char *pOutBuffer, const uint32_t nOutBufferSize);
+} // namespace artnet
+
 namespace artnet::controller {
 uint32_t json_get_polltable(char *pOutBuffer, const uint32_t nOutBufferSize);
 } // namespace artnet::controller
@@ -2,7 +2,7 @@
  * @file httpdhandlerequest.cpp
  *
  */
-/* Copyright (C) 2024-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2024-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -194,7 +194,7 @@ void HttpDeamonHandleRequest::HandleRequest(const uint32_t nBytesReceived, char
 				"</html>\n", static_cast<unsigned int>(m_Status), pStatusMsg, pStatusMsg));
 	}
 
-	const auto nHeaderLength = static_cast<uint32_t>(snprintf(m_pReceiveBuffer, sizeof(m_DynamicContent) - 1U,
+	const auto nHeaderLength = static_cast<uint32_t>(snprintf(m_Header, sizeof(m_Header) - 1U,
 			"HTTP/1.1 %u %s\r\n"
 			"Server: %s\r\n"
 			"Content-Type: %s\r\n"
@@ -202,8 +202,11 @@ void HttpDeamonHandleRequest::HandleRequest(const uint32_t nBytesReceived, char
 			"Connection: close\r\n"
 			"\r\n", static_cast<unsigned int>(m_Status), pStatusMsg, Network::Get()->GetHostName(), s_contentType[static_cast<uint32_t>(m_RequestContentType)], static_cast<unsigned int>(m_nContentSize)));
 
-	net::tcp_write(m_nHandle, reinterpret_cast<uint8_t *>(m_pReceiveBuffer), nHeaderLength, m_nConnectionHandle);
-	net::tcp_write(m_nHandle, reinterpret_cast<const uint8_t *>(m_pContent), m_nContentSize, m_nConnectionHandle);
+	// An incomplete response is not sent, the client gets a reset instead
+	if (!net::tcp_write(m_nHandle, reinterpret_cast<uint8_t *>(m_Header), nHeaderLength, m_nConnectionHandle)
+			|| !net::tcp_write(m_nHandle, reinterpret_cast<const uint8_t *>(m_pContent), m_nContentSize, m_nConnectionHandle)) {
+		net::tcp_abort(m_nHandle, m_nConnectionHandle);
+	}
 
 	DEBUG_PRINTF("m_nContentLength=%u", m_nContentSize);
 
@@ -544,6 +547,18 @@ http::Status HttpDeamonHandleRequest::HandleGet() {
 								}
 							} else
 #endif
+#if defined (NODE_ARTNET)
+								if (memcmp(pGet, "artnet/", 7) == 0) {
+									const auto *pArtNet = &pGet[7];
+									switch (http::get_uint(pArtNet)) {
+									case http::json::get::STATUS:
+										nLength = remoteconfig::artnet::json_get_status(m_DynamicContent, sizeof(m_DynamicContent));
+										break;
+									default:
+										break;
+									}
+								} else
+#endif
 #if defined (NODE_SHOWFILE)
 								if (memcmp(pGet, "showfile/", 9) == 0) {
 									const auto *pShowfile = &pGet[9];
@@ -176,6 +176,11 @@ int main(int argc, char **argv) {
 		showFile.Run();
 #endif
 		hw.Run();
+#if defined (NODE_SHOWFILE)
+		nw.Wait(showFile.GetStatus() == showfile::Status::PLAYING ? 0 : SoftwareTimerNextExpire());
+#else
+		nw.Wait(SoftwareTimerNextExpire());
+#endif
 	}
 
 	return 0;
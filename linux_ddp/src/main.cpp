@@ -32,7 +32,7 @@
 #include "network.h"
 
 
-#include "display.h"
+#include "displayudf.h"
 #include "displayudfparams.h"
 
 #include "net/apps/mdns.h"
@@ -68,7 +68,7 @@ int main(int argc, char **argv) {
     act.sa_handler = intHandler;
     sigaction(SIGINT, &act, nullptr);
 	Hardware hw;
-	Display display;
+	DisplayUdf display;
 	ConfigStore configStore;
 	Network nw(argc, argv);
 	FirmwareVersion fw(SOFTWARE_VERSION, __DATE__, __TIME__);
@@ -131,6 +131,7 @@ int main(int argc, char **argv) {
 		nw.Run();
 		ddpDisplay.Run();
 		hw.Run();
+		nw.Wait(SoftwareTimerNextExpire());
 	}
 
 	return 0;
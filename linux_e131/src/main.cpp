@@ -32,7 +32,7 @@
 #include "hardware.h"
 #include "network.h"
 
-#include "display.h"
+#include "displayudf.h"
 #include "displayudfparams.h"
 
 #include "e131bridge.h"
@@ -88,7 +88,7 @@ int main(int argc, char **argv) {
 	}
 #endif
 	Hardware hw;
-	Display display;
+	DisplayUdf display;
 	ConfigStore configStore;
 	Network nw(argc, argv);
 	FirmwareVersion fw(SOFTWARE_VERSION, __DATE__, __TIME__, DEVICE_SOFTWARE_VERSION_ID);
@@ -188,6 +188,11 @@ int main(int argc, char **argv) {
 		showFile.Run();
 #endif
 		hw.Run();
+#if defined (NODE_SHOWFILE)
+		nw.Wait(showFile.GetStatus() == showfile::Status::PLAYING ? 0 : SoftwareTimerNextExpire());
+#else
+		nw.Wait(SoftwareTimerNextExpire());
+#endif
 	}
 
 	return 0;
@@ -31,7 +31,7 @@
 #include "hardware.h"
 #include "network.h"
 
-#include "display.h"
+#include "displayudf.h"
 #include "displayudfparams.h"
 
 #include "net/apps/mdns.h"
@@ -70,7 +70,7 @@ int main(int argc, char **argv) {
     act.sa_handler = intHandler;
     sigaction(SIGINT, &act, nullptr);
 	Hardware hw;
-	Display display;
+	DisplayUdf display;
 	ConfigStore configStore;
 	Network nw(argc, argv);
 	FirmwareVersion fw(SOFTWARE_VERSION, __DATE__, __TIME__);
@@ -132,6 +132,7 @@ int main(int argc, char **argv) {
 	while (keepRunning) {
 		nw.Run();
 		hw.Run();
+		nw.Wait(SoftwareTimerNextExpire());
 	}
 
 	return 0;
@@ -31,7 +31,7 @@
 #include "hardware.h"
 #include "network.h"
 
-#include "display.h"
+#include "displayudf.h"
 #include "displayudfparams.h"
 
 #include "net/apps/mdns.h"
@@ -67,7 +67,7 @@ int main(int argc, char **argv) {
     act.sa_handler = intHandler;
     sigaction(SIGINT, &act, nullptr);
 	Hardware hw;
-	Display display;
+	DisplayUdf display;
 	ConfigStore configStore;
 	Network nw(argc, argv);
 //	MDNS mDns;
@@ -129,6 +129,7 @@ int main(int argc, char **argv) {
 		nw.Run();
 		pp.Run();
 		hw.Run();
+		nw.Wait(SoftwareTimerNextExpire());
 	}
 
 	return 0;